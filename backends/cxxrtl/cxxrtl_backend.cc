@@ -612,11 +612,11 @@ std::string escape_c_string(const std::string &input)
 	output.push_back('"');
 	for (auto c : input) {
 		if (::isprint(c)) {
-			if (c == '\\')
+			if (c == '\\' || c == '"')
 				output.push_back('\\');
 			output.push_back(c);
 		} else {
-			char l = c & 0x3, m = (c >> 3) & 0x3, h = (c >> 6) & 0x3;
+			char l = c & 0x7, m = (c >> 3) & 0x7, h = (c >> 6) & 0x3;
 			output.append("\\");
 			output.push_back('0' + h);
 			output.push_back('0' + m);
@@ -738,6 +738,9 @@ struct CxxrtlWorker {
 	bool debug_alias = false;
 	bool debug_eval = false;
 
+	bool parallel_eval = false;
+	bool activity_eval = false;
+
 	std::ostringstream f;
 	std::string indent;
 	int temporary = 0;
@@ -1109,6 +1112,32 @@ struct CxxrtlWorker {
 		}
 	}
 
+	// Collects the wires whose values are read when evaluating an expression, looking through inlined cells and aliases.
+	void collect_sigspec_rhs_wires(const RTLIL::SigSpec &sig, pool<const RTLIL::Wire*> &wires)
+	{
+		for (auto chunk : sig.chunks()) {
+			if (!chunk.wire)
+				continue;
+			const auto &wire_type = wire_types[chunk.wire];
+			switch (wire_type.type) {
+				case WireType::INLINE:
+					if (wire_type.cell_subst != nullptr) {
+						for (auto conn : wire_type.cell_subst->connections())
+							if (wire_type.cell_subst->input(conn.first))
+								collect_sigspec_rhs_wires(conn.second, wires);
+						break;
+					}
+					YS_FALLTHROUGH
+				case WireType::ALIAS:
+					collect_sigspec_rhs_wires(wire_type.sig_subst, wires);
+					break;
+				default:
+					wires.insert(chunk.wire);
+					break;
+			}
+		}
+	}
+
 	void dump_connect_expr(const RTLIL::SigSig &conn, bool for_debug = false)
 	{
 		dump_sigspec_rhs(conn.second, for_debug);
@@ -1531,82 +1560,174 @@ struct CxxrtlWorker {
 			// Outlines are called on demand when computing the value of a debug item. Nothing to do here.
 		} else {
 			log_assert(cell->known());
-			bool buffered_inputs = false;
-			const char *access = is_cxxrtl_blackbox_cell(cell) ? "->" : ".";
-			for (auto conn : cell->connections())
-				if (cell->input(conn.first)) {
-					RTLIL::Module *cell_module = cell->module->design->module(cell->type);
-					log_assert(cell_module != nullptr && cell_module->wire(conn.first));
-					RTLIL::Wire *cell_module_wire = cell_module->wire(conn.first);
-					f << indent << mangle(cell) << access << mangle_wire_name(conn.first);
-					if (!is_cxxrtl_blackbox_cell(cell) && wire_types[cell_module_wire].is_buffered()) {
-						buffered_inputs = true;
-						f << ".next";
-					}
-					f << " = ";
-					dump_sigspec_rhs(conn.second);
-					f << ";\n";
-					if (getenv("CXXRTL_VOID_MY_WARRANTY") && conn.second.is_wire()) {
-						// Until we have proper clock tree detection, this really awful hack that opportunistically
-						// propagates prev_* values for clocks can be used to estimate how much faster a design could
-						// be if only one clock edge was simulated by replacing:
-						//   top.p_clk = value<1>{0u}; top.step();
-						//   top.p_clk = value<1>{1u}; top.step();
-						// with:
-						//   top.prev_p_clk = value<1>{0u}; top.p_clk = value<1>{1u}; top.step();
-						// Don't rely on this; it will be removed without warning.
-						if (edge_wires[conn.second.as_wire()] && edge_wires[cell_module_wire]) {
-							f << indent << mangle(cell) << access << "prev_" << mangle(cell_module_wire) << " = ";
-							f << "prev_" << mangle(conn.second.as_wire()) << ";\n";
-						}
-					}
-				}
-			auto assign_from_outputs = [&](bool cell_converged) {
-				for (auto conn : cell->connections()) {
-					if (cell->output(conn.first)) {
-						if (conn.second.empty())
-							continue; // ignore disconnected ports
-						if (is_cxxrtl_sync_port(cell, conn.first))
-							continue; // fully sync ports are handled in CELL_SYNC nodes
-						f << indent;
-						dump_sigspec_lhs(conn.second);
-						f << " = " << mangle(cell) << access << mangle_wire_name(conn.first);
-						// Similarly to how there is no purpose to buffering cell inputs, there is also no purpose to buffering
-						// combinatorial cell outputs in case the cell converges within one cycle. (To convince yourself that
-						// this optimization is valid, consider that, since the cell converged within one cycle, it would not
-						// have any buffered wires if they were not output ports. Imagine inlining the cell's eval() function,
-						// and consider the fate of the localized wires that used to be output ports.)
-						//
-						// It is not possible to know apriori whether the cell (which may be late bound) will converge immediately.
-						// Because of this, the choice between using .curr (appropriate for buffered outputs) and .next (appropriate
-						// for unbuffered outputs) is made at runtime.
-						if (cell_converged && is_cxxrtl_comb_port(cell, conn.first))
-							f << ".next;\n";
-						else
-							f << ".curr;\n";
-					}
-				}
-			};
+			bool buffered_inputs = dump_user_cell_inputs(cell);
 			if (buffered_inputs) {
 				// If we have any buffered inputs, there's no chance of converging immediately.
-				f << indent << mangle(cell) << access << "eval(performer);\n";
+				f << indent;
+				dump_user_cell_eval_call(cell);
+				f << ";\n";
 				f << indent << "converged = false;\n";
-				assign_from_outputs(/*cell_converged=*/false);
+				dump_user_cell_outputs(cell, /*cell_converged=*/false);
 			} else {
-				f << indent << "if (" << mangle(cell) << access << "eval(performer)) {\n";
+				f << indent << "if (";
+				dump_user_cell_eval_call(cell);
+				f << ") {\n";
 				inc_indent();
-					assign_from_outputs(/*cell_converged=*/true);
+					dump_user_cell_outputs(cell, /*cell_converged=*/true);
 				dec_indent();
 				f << indent << "} else {\n";
 				inc_indent();
 					f << indent << "converged = false;\n";
-					assign_from_outputs(/*cell_converged=*/false);
+					dump_user_cell_outputs(cell, /*cell_converged=*/false);
 				dec_indent();
 				f << indent << "}\n";
 			}
 		}
 	}
 
+	// Assigns the inputs of a user cell, and returns true if any of them are buffered.
+	bool dump_user_cell_inputs(const RTLIL::Cell *cell)
+	{
+		bool buffered_inputs = false;
+		const char *access = is_cxxrtl_blackbox_cell(cell) ? "->" : ".";
+		for (auto conn : cell->connections())
+			if (cell->input(conn.first)) {
+				RTLIL::Module *cell_module = cell->module->design->module(cell->type);
+				log_assert(cell_module != nullptr && cell_module->wire(conn.first));
+				RTLIL::Wire *cell_module_wire = cell_module->wire(conn.first);
+				f << indent;
+				if (is_activity_cell(cell))
+					f << "activity_" << mangle(cell) << ".input(";
+				f << mangle(cell) << access << mangle_wire_name(conn.first);
+				if (!is_cxxrtl_blackbox_cell(cell) && wire_types[cell_module_wire].is_buffered()) {
+					buffered_inputs = true;
+					f << ".next";
+				}
+				if (is_activity_cell(cell)) {
+					f << ", ";
+					dump_sigspec_rhs(conn.second);
+					f << ");\n";
+				} else {
+					f << " = ";
+					dump_sigspec_rhs(conn.second);
+					f << ";\n";
+				}
+				if (getenv("CXXRTL_VOID_MY_WARRANTY") && conn.second.is_wire()) {
+					// Until we have proper clock tree detection, this really awful hack that opportunistically
+					// propagates prev_* values for clocks can be used to estimate how much faster a design could
+					// be if only one clock edge was simulated by replacing:
+					//   top.p_clk = value<1>{0u}; top.step();
+					//   top.p_clk = value<1>{1u}; top.step();
+					// with:
+					//   top.prev_p_clk = value<1>{0u}; top.p_clk = value<1>{1u}; top.step();
+					// Don't rely on this; it will be removed without warning.
+					if (edge_wires[conn.second.as_wire()] && edge_wires[cell_module_wire]) {
+						f << indent << mangle(cell) << access << "prev_" << mangle(cell_module_wire) << " = ";
+						f << "prev_" << mangle(conn.second.as_wire()) << ";\n";
+					}
+				}
+			}
+		return buffered_inputs;
+	}
+
+	void dump_user_cell_outputs(const RTLIL::Cell *cell, bool cell_converged)
+	{
+		const char *access = is_cxxrtl_blackbox_cell(cell) ? "->" : ".";
+		for (auto conn : cell->connections()) {
+			if (cell->output(conn.first)) {
+				if (conn.second.empty())
+					continue; // ignore disconnected ports
+				if (is_cxxrtl_sync_port(cell, conn.first))
+					continue; // fully sync ports are handled in CELL_SYNC nodes
+				f << indent;
+				dump_sigspec_lhs(conn.second);
+				f << " = " << mangle(cell) << access << mangle_wire_name(conn.first);
+				// Similarly to how there is no purpose to buffering cell inputs, there is also no purpose to buffering
+				// combinatorial cell outputs in case the cell converges within one cycle. (To convince yourself that
+				// this optimization is valid, consider that, since the cell converged within one cycle, it would not
+				// have any buffered wires if they were not output ports. Imagine inlining the cell's eval() function,
+				// and consider the fate of the localized wires that used to be output ports.)
+				//
+				// It is not possible to know apriori whether the cell (which may be late bound) will converge immediately.
+				// Because of this, the choice between using .curr (appropriate for buffered outputs) and .next (appropriate
+				// for unbuffered outputs) is made at runtime.
+				if (cell_converged && is_cxxrtl_comb_port(cell, conn.first))
+					f << ".next;\n";
+				else
+					f << ".curr;\n";
+			}
+		}
+	}
+
+	// Only instances of modules emitted by this backend have activity tracking; black boxes may have state that isn't
+	// visible to the generated code, and are always evaluated.
+	bool is_activity_cell(const RTLIL::Cell *cell)
+	{
+		return activity_eval && !is_internal_cell(cell->type) && !is_cxxrtl_blackbox_cell(cell);
+	}
+
+	void dump_user_cell_eval_call(const RTLIL::Cell *cell)
+	{
+		if (is_activity_cell(cell)) {
+			f << "activity_" << mangle(cell) << ".eval(" << mangle(cell) << ", performer)";
+		} else {
+			const char *access = is_cxxrtl_blackbox_cell(cell) ? "->" : ".";
+			f << mangle(cell) << access << "eval(performer)";
+		}
+	}
+
+	// Only instances of modules emitted by this backend are evaluated in parallel; black boxes may have arbitrary
+	// side effects (or share state between instances) and are always evaluated on the calling thread.
+	bool is_parallel_cell(const RTLIL::Cell *cell)
+	{
+		return !is_internal_cell(cell->type) && !is_cxxrtl_blackbox_cell(cell);
+	}
+
+	void dump_parallel_cell_evals(const std::vector<const RTLIL::Cell*> &cells)
+	{
+		std::vector<bool> buffered_inputs;
+		for (auto cell : cells) {
+			std::vector<const RTLIL::Cell*> inlined_cells;
+			collect_cell_eval(cell, /*for_debug=*/false, inlined_cells);
+			dump_inlined_cells(inlined_cells);
+			buffered_inputs.push_back(dump_user_cell_inputs(cell));
+		}
+		f << indent << "{\n";
+		inc_indent();
+			f << indent << "bool cell_converged[" << cells.size() << "];\n";
+			f << indent << "default_worker_pool().run(" << cells.size() << ", [&](size_t index) {\n";
+			inc_indent();
+				f << indent << "switch (index) {\n";
+				for (size_t n = 0; n < cells.size(); n++) {
+					f << indent << "\tcase " << n << ": cell_converged[" << n << "] = ";
+					dump_user_cell_eval_call(cells[n]);
+					f << "; break;\n";
+				}
+				f << indent << "}\n";
+			dec_indent();
+			f << indent << "});\n";
+			for (size_t n = 0; n < cells.size(); n++) {
+				if (buffered_inputs[n]) {
+					// See the note in `dump_cell_eval()`.
+					f << indent << "converged = false;\n";
+					dump_user_cell_outputs(cells[n], /*cell_converged=*/false);
+				} else {
+					f << indent << "if (cell_converged[" << n << "]) {\n";
+					inc_indent();
+						dump_user_cell_outputs(cells[n], /*cell_converged=*/true);
+					dec_indent();
+					f << indent << "} else {\n";
+					inc_indent();
+						f << indent << "converged = false;\n";
+						dump_user_cell_outputs(cells[n], /*cell_converged=*/false);
+					dec_indent();
+					f << indent << "}\n";
+				}
+			}
+		dec_indent();
+		f << indent << "}\n";
+	}
+
 	void collect_cell_eval(const RTLIL::Cell *cell, bool for_debug, std::vector<const RTLIL::Cell*> &cells)
 	{
 		cells.push_back(cell);
@@ -2160,6 +2281,8 @@ struct CxxrtlWorker {
 				} else {
 					f << ".reset();\n";
 				}
+				if (is_activity_cell(cell))
+					f << indent << "activity_" << mangle(cell) << ".active = true;\n";
 			}
 		dec_indent();
 	}
@@ -2187,7 +2310,42 @@ struct CxxrtlWorker {
 				}
 				for (auto wire : module->wires())
 					dump_wire(wire, /*is_local=*/true);
+				// With parallel evaluation, consecutive evaluations of module instances are grouped into clusters.
+				// A cell is only added to a cluster if none of its inputs are computed from outputs of the cells
+				// already in it, which makes it possible to assign all inputs of the cluster first, evaluate its
+				// cells concurrently, and then assign all outputs.
+				std::vector<const RTLIL::Cell*> parallel_cells;
+				pool<const RTLIL::Wire*> parallel_defs;
+				auto flush_parallel_cells = [&]() {
+					if (parallel_cells.size() == 1)
+						dump_cell_eval(parallel_cells.front());
+					else if (parallel_cells.size() > 1)
+						dump_parallel_cell_evals(parallel_cells);
+					parallel_cells.clear();
+					parallel_defs.clear();
+				};
 				for (auto node : schedule[module]) {
+					if (parallel_eval) {
+						if (node.type == FlowGraph::Node::Type::CELL_EVAL && is_parallel_cell(node.cell)) {
+							pool<const RTLIL::Wire*> uses;
+							for (auto conn : node.cell->connections())
+								if (node.cell->input(conn.first))
+									collect_sigspec_rhs_wires(conn.second, uses);
+							for (auto wire : uses)
+								if (parallel_defs.count(wire)) {
+									flush_parallel_cells();
+									break;
+								}
+							parallel_cells.push_back(node.cell);
+							for (auto conn : node.cell->connections())
+								if (node.cell->output(conn.first))
+									for (auto chunk : conn.second.chunks())
+										if (chunk.wire)
+											parallel_defs.insert(chunk.wire);
+							continue;
+						}
+						flush_parallel_cells();
+					}
 					switch (node.type) {
 						case FlowGraph::Node::Type::CONNECT:
 							dump_connect(node.connect);
@@ -2215,6 +2373,7 @@ struct CxxrtlWorker {
 							break;
 					}
 				}
+				flush_parallel_cells();
 			}
 			f << indent << "return converged;\n";
 		dec_indent();
@@ -2276,7 +2435,15 @@ struct CxxrtlWorker {
 					if (is_internal_cell(cell->type))
 						continue;
 					const char *access = is_cxxrtl_blackbox_cell(cell) ? "->" : ".";
-					f << indent << "if (" << mangle(cell) << access << "commit(observer)) changed = true;\n";
+					if (is_activity_cell(cell)) {
+						// A change to the state of an instance makes it active again.
+						f << indent << "if (" << mangle(cell) << access << "commit(observer)) {\n";
+						f << indent << "\tchanged = true;\n";
+						f << indent << "\tactivity_" << mangle(cell) << ".active = true;\n";
+						f << indent << "}\n";
+					} else {
+						f << indent << "if (" << mangle(cell) << access << "commit(observer)) changed = true;\n";
+					}
 				}
 			}
 			f << indent << "return changed;\n";
@@ -2371,6 +2538,20 @@ struct CxxrtlWorker {
 		}
 	}
 
+	void dump_activity_info_method(RTLIL::Module *module)
+	{
+		inc_indent();
+			for (auto cell : module->cells()) {
+				if (!is_activity_cell(cell))
+					continue;
+				f << indent << "items[path + " << escape_cxx_string(get_hdl_name(cell)) << "] = "
+				            << "activity_" << mangle(cell) << ".stats;\n";
+				f << indent << mangle(cell) << ".activity_info(items, path + "
+				            << escape_cxx_string(get_hdl_name(cell) + ' ') << ");\n";
+			}
+		dec_indent();
+	}
+
 	void dump_debug_info_method(RTLIL::Module *module)
 	{
 		size_t count_scopes = 0;
@@ -2695,6 +2876,8 @@ struct CxxrtlWorker {
 						f << ");\n";
 					} else {
 						f << indent << mangle(cell_module) << " " << mangle(cell) << " {interior()};\n";
+						if (is_activity_cell(cell))
+							f << indent << "activity activity_" << mangle(cell) << ";\n";
 					}
 					has_cells = true;
 				}
@@ -2735,6 +2918,10 @@ struct CxxrtlWorker {
 					f << indent << "void debug_info(debug_items *items, debug_scopes *scopes, "
 					            << "std::string path, metadata_map &&cell_attrs = {}) override;\n";
 				}
+				if (activity_eval) {
+					f << "\n";
+					f << indent << "void activity_info(activity_items &items, std::string path = \"\") override;\n";
+				}
 			dec_indent();
 			f << indent << "}; // struct " << mangle(module) << "\n";
 			f << "\n";
@@ -2766,6 +2953,12 @@ struct CxxrtlWorker {
 			dump_debug_info_method(module);
 			f << indent << "}\n";
 		}
+		if (activity_eval) {
+			f << "\n";
+			f << indent << "void " << mangle(module) << "::activity_info(activity_items &items, std::string path) {\n";
+			dump_activity_info_method(module);
+			f << indent << "}\n";
+		}
 		f << "\n";
 	}
 
@@ -2844,6 +3037,8 @@ struct CxxrtlWorker {
 			f << "#include \"" << basename(intf_filename) << "\"\n";
 		else
 			f << "#include <cxxrtl/cxxrtl.h>\n";
+		if (parallel_eval)
+			f << "#include <cxxrtl/cxxrtl_parallel.h>\n";
 		f << "\n";
 		f << "#if defined(CXXRTL_INCLUDE_CAPI_IMPL) || \\\n";
 		f << "    defined(CXXRTL_INCLUDE_VCD_CAPI_IMPL)\n";
@@ -3645,6 +3840,25 @@ struct CxxrtlBackend : public Backend {
 		log("        must be one of \"std::cout\", \"std::cerr\". if not specified,\n");
 		log("        \"std::cout\" is used. explicitly provided performer overrides this.\n");
 		log("\n");
+		log("    -parallel\n");
+		log("        evaluate independent instances of non-black-box modules concurrently on\n");
+		log("        a pool of worker threads. instances are only preserved when the design\n");
+		log("        is not flattened, so this option is mostly useful together with\n");
+		log("        -noflatten or (* keep_hierarchy *). the amount of threads is taken from\n");
+		log("        the CXXRTL_THREADS environment variable, or can be changed at runtime\n");
+		log("        using `cxxrtl::default_worker_pool().resize()`. if a performer is\n");
+		log("        provided, its methods may be called from several threads at once.\n");
+		log("        the generated code must be linked with the platform threads library.\n");
+		log("\n");
+		log("    -activity\n");
+		log("        skip evaluating instances of non-black-box modules whose inputs and state\n");
+		log("        have not changed since they were last evaluated, which makes simulation\n");
+		log("        of mostly idle designs (e.g. with large clock gated blocks) faster.\n");
+		log("        like -parallel, this option is useful together with -noflatten or\n");
+		log("        (* keep_hierarchy *). the amount of evaluated and skipped instances is\n");
+		log("        reported by the `activity_info()` method of the generated modules.\n");
+		log("        the state of instances must only be changed through their inputs.\n");
+		log("\n");
 		log("    -nohierarchy\n");
 		log("        use design hierarchy as-is. in most designs, a top module should be\n");
 		log("        present as it is exposed through the C API and has unbuffered outputs\n");
@@ -3783,6 +3997,14 @@ struct CxxrtlBackend : public Backend {
 				worker.design_ns = args[++argidx];
 				continue;
 			}
+			if (args[argidx] == "-parallel") {
+				worker.parallel_eval = true;
+				continue;
+			}
+			if (args[argidx] == "-activity") {
+				worker.activity_eval = true;
+				continue;
+			}
 			if (args[argidx] == "-print-output" && argidx+1 < args.size()) {
 				worker.print_output = args[++argidx];
 				if (!(worker.print_output == "std::cout" || worker.print_output == "std::cerr")) {
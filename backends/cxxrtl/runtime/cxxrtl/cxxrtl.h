@@ -106,6 +106,239 @@ struct chunk_traits {
 	static constexpr T mask = std::numeric_limits<T>::max();
 };
 
+// Operations on wide values (crypto datapaths, vector units, etc.) are dominated by loops over chunks. Where the compiler
+// supports vector extensions, the most commonly used of these operations are implemented explicitly in terms of vector
+// registers instead, which both avoids relying on the auto-vectorizer (which does not handle early exits or carry
+// chains at all) and allows restructuring the carry chains to be computed in parallel.
+//
+// The vector width is selected at compile time based on the target ISA. Vectorized implementations are only used
+// for values that span at least two vector registers. Defining CXXRTL_NO_VECTORIZE selects the scalar implementations.
+#if !defined(CXXRTL_NO_VECTORIZE) && !defined(CXXRTL_VECTOR_BYTES) && (defined(__GNUC__) || defined(__clang__))
+#	if defined(__AVX512F__)
+#		define CXXRTL_VECTOR_BYTES 64
+#	elif defined(__AVX2__)
+#		define CXXRTL_VECTOR_BYTES 32
+#	elif defined(__SSE2__) || defined(__ARM_NEON) || defined(__wasm_simd128__)
+#		define CXXRTL_VECTOR_BYTES 16
+#	endif
+#endif
+#if defined(CXXRTL_NO_VECTORIZE)
+#	undef CXXRTL_VECTOR_BYTES
+#endif
+
+#if defined(CXXRTL_VECTOR_BYTES)
+namespace simd {
+
+typedef chunk_t vector __attribute__((__vector_size__(CXXRTL_VECTOR_BYTES)));
+
+static constexpr size_t lanes = CXXRTL_VECTOR_BYTES / sizeof(chunk_t);
+
+// The chunk arrays are only aligned to the chunk size, so all accesses go through memcpy(), which compiles to
+// unaligned vector loads and stores.
+CXXRTL_ALWAYS_INLINE
+vector load(const chunk_t *data) {
+	vector result;
+	memcpy(&result, data, sizeof(vector));
+	return result;
+}
+
+CXXRTL_ALWAYS_INLINE
+void store(chunk_t *data, const vector &value) {
+	memcpy(data, &value, sizeof(vector));
+}
+
+CXXRTL_ALWAYS_INLINE
+bool any(const vector &value) {
+	chunk_t result = 0;
+	for (size_t lane = 0; lane < lanes; lane++)
+		result |= value[lane];
+	return result != 0;
+}
+
+template<size_t Chunks>
+CXXRTL_ALWAYS_INLINE
+bool is_zero(const chunk_t *a) {
+	constexpr size_t vector_chunks = Chunks - Chunks % lanes;
+	for (size_t n = 0; n < vector_chunks; n += lanes)
+		if (any(load(&a[n])))
+			return false;
+	for (size_t n = vector_chunks; n < Chunks; n++)
+		if (a[n] != 0)
+			return false;
+	return true;
+}
+
+template<size_t Chunks>
+CXXRTL_ALWAYS_INLINE
+bool equal(const chunk_t *a, const chunk_t *b) {
+	constexpr size_t vector_chunks = Chunks - Chunks % lanes;
+	for (size_t n = 0; n < vector_chunks; n += lanes)
+		if (any(load(&a[n]) ^ load(&b[n])))
+			return false;
+	for (size_t n = vector_chunks; n < Chunks; n++)
+		if (a[n] != b[n])
+			return false;
+	return true;
+}
+
+// Returns true if `a` is less than `b`, comparing them as unsigned numbers.
+template<size_t Chunks>
+CXXRTL_ALWAYS_INLINE
+bool less(const chunk_t *a, const chunk_t *b) {
+	size_t n = Chunks;
+	for (; n >= lanes; n -= lanes)
+		if (any(load(&a[n - lanes]) ^ load(&b[n - lanes])))
+			break;
+	// Either `n` is the top of the vector containing the most significant differing chunk, or the remaining chunks
+	// are fewer than a vector.
+	for (; n > 0; n--)
+		if (a[n - 1] != b[n - 1])
+			return a[n - 1] < b[n - 1];
+	return false;
+}
+
+struct bit_and {
+	template<class T>
+	CXXRTL_ALWAYS_INLINE
+	T operator()(const T &a, const T &b) const { return a & b; }
+};
+
+struct bit_or {
+	template<class T>
+	CXXRTL_ALWAYS_INLINE
+	T operator()(const T &a, const T &b) const { return a | b; }
+};
+
+struct bit_xor {
+	template<class T>
+	CXXRTL_ALWAYS_INLINE
+	T operator()(const T &a, const T &b) const { return a ^ b; }
+};
+
+template<size_t Chunks, class Operation>
+CXXRTL_ALWAYS_INLINE
+void bitwise(chunk_t *result, const chunk_t *a, const chunk_t *b, Operation op) {
+	constexpr size_t vector_chunks = Chunks - Chunks % lanes;
+	for (size_t n = 0; n < vector_chunks; n += lanes)
+		store(&result[n], op(load(&a[n]), load(&b[n])));
+	for (size_t n = vector_chunks; n < Chunks; n++)
+		result[n] = op(a[n], b[n]);
+}
+
+// Adds `a` and either `b` or `~b` (if `Invert` is true) with the carry input `carry`, and returns the carry output.
+// The carries between chunks are computed with a carry-lookahead scheme: every chunk is added independently, and each
+// either generates a carry (if its sum has overflowed) or propagates it (if its sum is all ones). Packing the generate
+// and propagate flags of up to 32 chunks into bit masks turns the carry chain into a single 64-bit addition.
+template<size_t Chunks, bool Invert>
+CXXRTL_ALWAYS_INLINE
+bool add(chunk_t *result, const chunk_t *a, const chunk_t *b, bool carry) {
+	constexpr size_t block = 32;
+	for (size_t base = 0; base < Chunks; base += block) {
+		const size_t count = (Chunks - base < block) ? Chunks - base : block;
+		uint64_t generate = 0, propagate = 0;
+		size_t n = 0;
+		for (; n + lanes <= count; n += lanes) {
+			vector va = load(&a[base + n]);
+			vector vb = load(&b[base + n]);
+			vector vs = va + (Invert ? ~vb : vb);
+			store(&result[base + n], vs);
+			vector vg = vs < va;
+			vector vp = vs == ~vector{};
+			for (size_t lane = 0; lane < lanes; lane++) {
+				generate  |= uint64_t(vg[lane] & 1) << (n + lane);
+				propagate |= uint64_t(vp[lane] & 1) << (n + lane);
+			}
+		}
+		for (; n < count; n++) {
+			chunk_t sum = a[base + n] + (Invert ? ~b[base + n] : b[base + n]);
+			result[base + n] = sum;
+			generate  |= uint64_t(sum < a[base + n]) << n;
+			propagate |= uint64_t(sum == ~chunk_t(0)) << n;
+		}
+		// The generate and propagate masks are disjoint, so this is equivalent to adding the numbers with bits
+		// `generate | propagate` and `generate`, and the carry into each chunk can be recovered from the sum.
+		uint64_t sum = (generate | propagate) + generate + carry;
+		uint64_t carries = sum ^ propagate;
+		n = 0;
+		for (; n + lanes <= count; n += lanes) {
+			vector vc;
+			for (size_t lane = 0; lane < lanes; lane++)
+				vc[lane] = (carries >> (n + lane)) & 1;
+			store(&result[base + n], load(&result[base + n]) + vc);
+		}
+		for (; n < count; n++)
+			result[base + n] += (carries >> n) & 1;
+		carry = (sum >> count) & 1;
+	}
+	return carry;
+}
+
+// Shifts `a` left by `shift_chunks * chunk_bits + shift_bits` bits. Chunks below `shift_chunks` are not written.
+template<size_t Chunks>
+CXXRTL_ALWAYS_INLINE
+void shl(chunk_t *result, const chunk_t *a, size_t shift_chunks, size_t shift_bits) {
+	constexpr size_t chunk_bits = std::numeric_limits<chunk_t>::digits;
+	// Shifting by the full chunk width is undefined, so the right shift is split in two.
+	const size_t carry_shift = chunk_bits - 1 - shift_bits;
+	result[shift_chunks] = a[0] << shift_bits;
+	size_t n = shift_chunks + 1;
+	for (; n + lanes <= Chunks; n += lanes) {
+		vector lo = load(&a[n - shift_chunks - 1]);
+		vector hi = load(&a[n - shift_chunks]);
+		store(&result[n], (hi << shift_bits) | ((lo >> 1) >> carry_shift));
+	}
+	for (; n < Chunks; n++)
+		result[n] = (a[n - shift_chunks] << shift_bits) | ((a[n - shift_chunks - 1] >> 1) >> carry_shift);
+}
+
+// Shifts `a` right by `shift_chunks * chunk_bits + shift_bits` bits, filling with zeroes. Chunks at and above
+// `Chunks - shift_chunks` are not written.
+template<size_t Chunks>
+CXXRTL_ALWAYS_INLINE
+void shr(chunk_t *result, const chunk_t *a, size_t shift_chunks, size_t shift_bits) {
+	constexpr size_t chunk_bits = std::numeric_limits<chunk_t>::digits;
+	const size_t carry_shift = chunk_bits - 1 - shift_bits;
+	const size_t count = Chunks - shift_chunks;
+	size_t n = 0;
+	for (; n + lanes < count; n += lanes) {
+		vector lo = load(&a[n + shift_chunks]);
+		vector hi = load(&a[n + shift_chunks + 1]);
+		store(&result[n], (lo >> shift_bits) | ((hi << 1) << carry_shift));
+	}
+	for (; n + 1 < count; n++)
+		result[n] = (a[n + shift_chunks] >> shift_bits) | ((a[n + shift_chunks + 1] << 1) << carry_shift);
+	result[count - 1] = a[Chunks - 1] >> shift_bits;
+}
+
+// Multiplies `a` and `b`, truncating the product to `ResultChunks`. Unlike the scalar implementation, the low and high
+// halves of the partial products are accumulated separately and carries are resolved once at the end, which removes
+// the carry dependency between iterations of the inner loop. The loop itself is scalar code that works on one chunk
+// at a time; it does not use the vector types above, and whether it is vectorized is left to the compiler.
+template<size_t Chunks, size_t ResultChunks>
+CXXRTL_ALWAYS_INLINE
+void mul(chunk_t *result, const chunk_t *a, const chunk_t *b) {
+	constexpr size_t chunk_bits = std::numeric_limits<chunk_t>::digits;
+	wide_chunk_t accum[ResultChunks + 1] = {};
+	for (size_t n = 0; n < Chunks && n < ResultChunks; n++) {
+		const wide_chunk_t multiplier = a[n];
+		const size_t count = (Chunks < ResultChunks - n) ? Chunks : ResultChunks - n;
+		for (size_t m = 0; m < count; m++) {
+			wide_chunk_t product = multiplier * b[m];
+			accum[n + m] += product & std::numeric_limits<chunk_t>::max();
+			accum[n + m + 1] += product >> chunk_bits;
+		}
+	}
+	wide_chunk_t carry = 0;
+	for (size_t n = 0; n < ResultChunks; n++) {
+		carry += accum[n];
+		result[n] = chunk_t(carry);
+		carry >>= chunk_bits;
+	}
+}
+
+} // namespace simd
+#endif
+
 template<class T>
 struct expr_base;
 
@@ -120,6 +353,12 @@ struct value : public expr_base<value<Bits>> {
 	static constexpr size_t chunks = (Bits + chunk::bits - 1) / chunk::bits;
 	chunk::type data[chunks] = {};
 
+#if defined(CXXRTL_VECTOR_BYTES)
+	static constexpr bool vectorized = (chunks >= 2 * simd::lanes);
+#else
+	static constexpr bool vectorized = false;
+#endif
+
 	value() = default;
 	template<typename... Init>
 	explicit constexpr value(Init ...init) : data{init...} {}
@@ -364,6 +603,10 @@ struct value : public expr_base<value<Bits>> {
 	}
 
 	bool is_zero() const {
+#if defined(CXXRTL_VECTOR_BYTES)
+		if (vectorized)
+			return simd::is_zero<chunks>(data);
+#endif
 		for (size_t n = 0; n < chunks; n++)
 			if (data[n] != 0)
 				return false;
@@ -375,6 +618,10 @@ struct value : public expr_base<value<Bits>> {
 	}
 
 	bool operator ==(const value<Bits> &other) const {
+#if defined(CXXRTL_VECTOR_BYTES)
+		if (vectorized)
+			return simd::equal<chunks>(data, other.data);
+#endif
 		for (size_t n = 0; n < chunks; n++)
 			if (data[n] != other.data[n])
 				return false;
@@ -395,6 +642,12 @@ struct value : public expr_base<value<Bits>> {
 
 	value<Bits> bit_and(const value<Bits> &other) const {
 		value<Bits> result;
+#if defined(CXXRTL_VECTOR_BYTES)
+		if (vectorized) {
+			simd::bitwise<chunks>(result.data, data, other.data, simd::bit_and());
+			return result;
+		}
+#endif
 		for (size_t n = 0; n < chunks; n++)
 			result.data[n] = data[n] & other.data[n];
 		return result;
@@ -402,6 +655,12 @@ struct value : public expr_base<value<Bits>> {
 
 	value<Bits> bit_or(const value<Bits> &other) const {
 		value<Bits> result;
+#if defined(CXXRTL_VECTOR_BYTES)
+		if (vectorized) {
+			simd::bitwise<chunks>(result.data, data, other.data, simd::bit_or());
+			return result;
+		}
+#endif
 		for (size_t n = 0; n < chunks; n++)
 			result.data[n] = data[n] | other.data[n];
 		return result;
@@ -409,6 +668,12 @@ struct value : public expr_base<value<Bits>> {
 
 	value<Bits> bit_xor(const value<Bits> &other) const {
 		value<Bits> result;
+#if defined(CXXRTL_VECTOR_BYTES)
+		if (vectorized) {
+			simd::bitwise<chunks>(result.data, data, other.data, simd::bit_xor());
+			return result;
+		}
+#endif
 		for (size_t n = 0; n < chunks; n++)
 			result.data[n] = data[n] ^ other.data[n];
 		return result;
@@ -432,6 +697,13 @@ struct value : public expr_base<value<Bits>> {
 		if (shift_chunks >= chunks)
 			return {};
 		value<Bits> result;
+#if defined(CXXRTL_VECTOR_BYTES)
+		if (vectorized) {
+			simd::shl<chunks>(result.data, data, shift_chunks, shift_bits);
+			result.data[result.chunks - 1] &= result.msb_mask;
+			return result;
+		}
+#endif
 		chunk::type carry = 0;
 		for (size_t n = 0; n < chunks - shift_chunks; n++) {
 			result.data[shift_chunks + n] = (data[n] << shift_bits) | carry;
@@ -456,11 +728,18 @@ struct value : public expr_base<value<Bits>> {
 		if (shift_chunks >= chunks)
 			return (Signed && is_neg()) ? value<Bits>().bit_not() : value<Bits>();
 		value<Bits> result;
-		chunk::type carry = 0;
-		for (size_t n = 0; n < chunks - shift_chunks; n++) {
-			result.data[chunks - shift_chunks - 1 - n] = carry | (data[chunks - 1 - n] >> shift_bits);
-			carry = (shift_bits == 0) ? 0
-				: data[chunks - 1 - n] << (chunk::bits - shift_bits);
+#if defined(CXXRTL_VECTOR_BYTES)
+		if (vectorized) {
+			simd::shr<chunks>(result.data, data, shift_chunks, shift_bits);
+		} else
+#endif
+		{
+			chunk::type carry = 0;
+			for (size_t n = 0; n < chunks - shift_chunks; n++) {
+				result.data[chunks - shift_chunks - 1 - n] = carry | (data[chunks - 1 - n] >> shift_bits);
+				carry = (shift_bits == 0) ? 0
+					: data[chunks - 1 - n] << (chunk::bits - shift_bits);
+			}
 		}
 		if (Signed && is_neg()) {
 			size_t top_chunk_idx  = amount.data[0] > Bits ? 0 : (Bits - amount.data[0]) / chunk::bits;
@@ -547,6 +826,18 @@ struct value : public expr_base<value<Bits>> {
 	std::pair<value<Bits>, bool /*CarryOut*/> alu(const value<Bits> &other) const {
 		value<Bits> result;
 		bool carry = CarryIn;
+#if defined(CXXRTL_VECTOR_BYTES)
+		if (vectorized) {
+			// The most significant chunk may need to be masked, so it is handled using the scalar code below.
+			carry = simd::add<chunks - 1, Invert>(result.data, data, other.data, carry);
+			const size_t n = chunks - 1;
+			result.data[n] = data[n] + (Invert ? ~other.data[n] : other.data[n]) + carry;
+			result.data[n] &= result.msb_mask;
+			carry = (result.data[n] <  data[n]) ||
+			        (result.data[n] == data[n] && carry);
+			return {result, carry};
+		}
+#endif
 		for (size_t n = 0; n < result.chunks; n++) {
 			result.data[n] = data[n] + (Invert ? ~other.data[n] : other.data[n]) + carry;
 			if (result.chunks - 1 == n)
@@ -570,12 +861,21 @@ struct value : public expr_base<value<Bits>> {
 	}
 
 	bool ucmp(const value<Bits> &other) const {
+#if defined(CXXRTL_VECTOR_BYTES)
+		if (vectorized)
+			return simd::less<chunks>(data, other.data);
+#endif
 		bool carry;
 		std::tie(std::ignore, carry) = alu</*Invert=*/true, /*CarryIn=*/true>(other);
 		return !carry; // a.ucmp(b) ≡ a u< b
 	}
 
 	bool scmp(const value<Bits> &other) const {
+#if defined(CXXRTL_VECTOR_BYTES)
+		// Values with the same sign are ordered the same way regardless of signedness.
+		if (vectorized)
+			return (is_neg() != other.is_neg()) ? is_neg() : simd::less<chunks>(data, other.data);
+#endif
 		value<Bits> result;
 		bool carry;
 		std::tie(result, carry) = alu</*Invert=*/true, /*CarryIn=*/true>(other);
@@ -586,6 +886,13 @@ struct value : public expr_base<value<Bits>> {
 	template<size_t ResultBits>
 	value<ResultBits> mul(const value<Bits> &other) const {
 		value<ResultBits> result;
+#if defined(CXXRTL_VECTOR_BYTES)
+		if (vectorized) {
+			simd::mul<chunks, result.chunks>(result.data, data, other.data);
+			result.data[result.chunks - 1] &= result.msb_mask;
+			return result;
+		}
+#endif
 		wide_chunk_t wide_result[result.chunks + 1] = {};
 		for (size_t n = 0; n < chunks; n++) {
 			for (size_t m = 0; m < chunks && n + m < result.chunks; m++) {
@@ -1532,6 +1839,48 @@ struct debug_scopes {
 	}
 };
 
+// Evaluation statistics of a module instance in a design generated with `write_cxxrtl -activity`.
+struct activity_stats {
+	uint64_t evaluated = 0;
+	uint64_t skipped = 0;
+
+	double skip_ratio() const {
+		uint64_t total = evaluated + skipped;
+		return total == 0 ? 0.0 : (double)skipped / total;
+	}
+};
+
+// Maps hierarchical names of module instances (using the same format as debug item names) to their statistics.
+typedef std::map<std::string, activity_stats> activity_items;
+
+// Activity tracking for a module instance in a design generated with `write_cxxrtl -activity`. An instance becomes
+// inactive once it is evaluated, and becomes active again if any of its inputs change, or if its `commit()` reports
+// a change (which includes any buffered wires that did not converge). The `eval()` method of an instance is a function
+// of only its inputs and its state, so evaluating an inactive instance again would not change anything, and is skipped.
+struct activity {
+	bool active = true;
+	activity_stats stats;
+
+	template<size_t Bits>
+	void input(value<Bits> &port, const value<Bits> &val) {
+		if (port != val) {
+			port = val;
+			active = true;
+		}
+	}
+
+	template<class ModuleT>
+	bool eval(ModuleT &module, performer *performer) {
+		if (!active) {
+			stats.skipped++;
+			return true;
+		}
+		stats.evaluated++;
+		active = false;
+		return module.eval(performer);
+	}
+};
+
 // Tag class to disambiguate the default constructor used by the toplevel module that calls `reset()`,
 // and the constructor of interior modules that should not call it.
 struct interior {};
@@ -1580,6 +1929,12 @@ struct module {
 		(void)items, (void)scopes, (void)path, (void)cell_attrs;
 	}
 
+	// Designs generated with `write_cxxrtl -activity` add the statistics of every module instance in the hierarchy
+	// to `items`. Other designs add nothing.
+	virtual void activity_info(activity_items &items, std::string path = "") {
+		(void)items, (void)path;
+	}
+
 	// Compatibility method.
 #if __has_attribute(deprecated)
 	__attribute__((deprecated("Use `debug_info(&items, /*scopes=*/nullptr, path);` instead.")))
@@ -0,0 +1,199 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+// This file is included by the designs generated with `write_cxxrtl -parallel`. It is not used in Yosys itself.
+//
+// The generated code groups evaluations of module instances that do not depend on each other within a delta cycle
+// into clusters, and runs each cluster on a worker pool. The call that runs a cluster returns only once every member
+// of the cluster has been evaluated, which acts as a barrier between the eval and commit phases.
+
+#ifndef CXXRTL_PARALLEL_H
+#define CXXRTL_PARALLEL_H
+
+#include <cstdlib>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#include <cxxrtl/cxxrtl.h>
+
+namespace cxxrtl {
+
+class worker_pool {
+	std::vector<std::thread> workers;
+
+	// All of the fields below are protected by `mutex`, except for `next_task` and `done_tasks`, which are used
+	// to distribute the tasks of the current job without taking the lock.
+	std::mutex mutex;
+	std::condition_variable job_posted;
+	std::condition_variable job_finished;
+	bool stopping = false;
+	size_t generation = 0;
+	void (*invoke)(const void *, size_t) = nullptr;
+	const void *context = nullptr;
+	size_t task_count = 0;
+	size_t busy_workers = 0;
+	std::atomic<size_t> next_task;
+	std::atomic<size_t> done_tasks;
+
+	// Only one job may run at a time; jobs submitted from within a job run inline.
+	std::mutex job_mutex;
+
+	static bool &in_job() {
+		static thread_local bool flag = false;
+		return flag;
+	}
+
+	void run_tasks() {
+		size_t index;
+		while ((index = next_task.fetch_add(1, std::memory_order_relaxed)) < task_count) {
+			invoke(context, index);
+			done_tasks.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	void worker_main() {
+		in_job() = true;
+		size_t seen_generation = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			job_posted.wait(lock, [&] { return stopping || generation != seen_generation; });
+			if (stopping)
+				return;
+			seen_generation = generation;
+			// The job may have been completed by other threads before this one woke up.
+			if (task_count == 0)
+				continue;
+			busy_workers++;
+			lock.unlock();
+			run_tasks();
+			lock.lock();
+			if (--busy_workers == 0)
+				job_finished.notify_all();
+		}
+	}
+
+	void start(size_t threads) {
+		stopping = false;
+		// The thread that submits a job always participates in it, so one fewer worker thread is needed.
+		for (size_t n = 1; n < threads; n++)
+			workers.emplace_back(&worker_pool::worker_main, this);
+	}
+
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		job_posted.notify_all();
+		for (auto &worker : workers)
+			worker.join();
+		workers.clear();
+	}
+
+public:
+	// The default amount of threads is taken from the `CXXRTL_THREADS` environment variable if it is set, and
+	// is equal to the amount of hardware threads otherwise.
+	static size_t default_threads() {
+		if (const char *threads = getenv("CXXRTL_THREADS"))
+			if (atoi(threads) > 0)
+				return atoi(threads);
+		size_t threads = std::thread::hardware_concurrency();
+		return threads > 0 ? threads : 1;
+	}
+
+	explicit worker_pool(size_t threads = default_threads()) : next_task(0), done_tasks(0) {
+		start(threads);
+	}
+
+	~worker_pool() {
+		stop();
+	}
+
+	worker_pool(const worker_pool &) = delete;
+	worker_pool &operator=(const worker_pool &) = delete;
+
+	size_t threads() const {
+		return workers.size() + 1;
+	}
+
+	// Changes the amount of threads. Must not be called while a job is running.
+	void resize(size_t threads) {
+		std::lock_guard<std::mutex> guard(job_mutex);
+		stop();
+		start(threads > 0 ? threads : 1);
+	}
+
+	// Calls `invoke(context, index)` for every index below `count` and returns once all of these calls have completed.
+	// The calls may run concurrently with each other, in any order. If called from within a task, or if the pool has
+	// a single thread, the calls are made sequentially on the calling thread.
+	void run(size_t count, void (*invoke)(const void *, size_t), const void *context) {
+		if (count == 0)
+			return;
+		if (in_job() || workers.empty() || count == 1) {
+			for (size_t index = 0; index < count; index++)
+				invoke(context, index);
+			return;
+		}
+
+		std::lock_guard<std::mutex> guard(job_mutex);
+		in_job() = true;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			this->invoke = invoke;
+			this->context = context;
+			this->task_count = count;
+			next_task.store(0, std::memory_order_relaxed);
+			done_tasks.store(0, std::memory_order_relaxed);
+			generation++;
+		}
+		job_posted.notify_all();
+		run_tasks();
+		{
+			// Wait both until every task is done, and until every worker has left `run_tasks()`. Once `task_count`
+			// is cleared, no worker may enter `run_tasks()` until the next job is posted.
+			std::unique_lock<std::mutex> lock(mutex);
+			job_finished.wait(lock, [&] {
+				return busy_workers == 0 && done_tasks.load(std::memory_order_acquire) == count;
+			});
+			this->invoke = nullptr;
+			this->context = nullptr;
+			this->task_count = 0;
+		}
+		in_job() = false;
+	}
+
+	// Calls `task(index)` for every index below `count`, as above. The generated code uses this overload with a lambda
+	// that dispatches on the index, which avoids allocating memory on every call (unlike e.g. `std::function`).
+	template<class TaskT>
+	void run(size_t count, const TaskT &task) {
+		run(count, [](const void *context, size_t index) {
+			(*static_cast<const TaskT *>(context))(index);
+		}, &task);
+	}
+};
+
+// The worker pool used by the generated code. It is created on first use.
+inline worker_pool &default_worker_pool() {
+	static worker_pool pool;
+	return pool;
+}
+
+} // namespace cxxrtl
+
+#endif
@@ -30,10 +30,12 @@
 #include <cstring>
 #include <cstdio>
 #include <atomic>
+#include <thread>
 #include <unordered_map>
 
 #include <cxxrtl/cxxrtl.h>
 #include <cxxrtl/cxxrtl_time.h>
+#include <cxxrtl/cxxrtl_ring_buffer.h>
 
 // Theory of operation
 // ===================
@@ -46,7 +48,7 @@
 // degree of detail see the source code. The format is considered fully internal to CXXRTL and is subject to change
 // without notice.
 //
-// <file>           ::= <file-header> <definitions> <sample>+
+// <file>           ::= <file-header> <definitions> <sample>+ <index>?
 // <file-header>    ::= 0x52585843 0x00004c54
 // <definitions>    ::= <packet-define>* <packet-end>
 // <sample>         ::= <packet-sample> (<packet-change> | <packet-diag>)* <packet-end>
@@ -60,12 +62,18 @@
 // <packet-assert>  ::= 0xc0000012 <message> <source-location>
 // <packet-assume>  ::= 0xc0000013 <message> <source-location>
 // <packet-end>     ::= 0xFFFFFFFF
+// <index>          ::= 0xc0000002 <count> <index-entry>* <position> 0xc0000003
+// <index-entry>    ::= <pointer> <time> <position>
 //
 // The replay log contains sample data, however, it does not cover the entire design. Rather, it only contains sample
 // data for the subset of debug items containing _design state_: inputs and registers/latches. This keeps its size to
 // a minimum, and recording speed to a maximum. The player samples any missing data by setting the design state items
 // to the same values they had during recording, and re-evaluating the design.
 //
+// The index lists the pointers, times, and file positions of every complete sample, and is written once the recording
+// is finished. It is located using the position stored at the very end of the file. A log that is still being recorded
+// (or one whose recorder was not destroyed properly) has no index, and is indexed by the player as it reads the log.
+//
 // Packets for diagnostics (prints, breakpoints, assertions, and assumptions) are used solely for diagnostics emitted
 // by the C++ testbench driving the simulation, and are not recorded while evaluating the design. (Diagnostics emitted
 // by the RTL can be reconstructed at replay time, so recording them would be a waste of space.)
@@ -101,6 +109,9 @@
 // During rewinding, the player begins reading at the latest non-incremental sample that still lies before the requested
 // sample time. It continues reading incremental samples after that point until it reaches the requested sample time.
 // This process is very cheap as the design is not evaluated; it is essentially a (convoluted) memory copy operation.
+// If the log has an index, every non-incremental sample in it is known in advance, and rewinding to any time (not just
+// one that has been already read) takes time proportional only to the distance between non-incremental samples. This
+// distance is controlled by the recorder, which can insert non-incremental samples (checkpoints) periodically.
 //
 // During replaying, the player evaluates the design at the current time, which causes all debug items to assume
 // the values they had before recording. This process is expensive. Once done, the player advances to the next state
@@ -154,7 +165,7 @@ public:
 	// Numeric identifier assigned to a debug item within a replay log. Range limited to [1, MAXIMUM_IDENT].
 	typedef uint32_t ident_t;
 
-	static constexpr uint16_t VERSION = 0x0400;
+	static constexpr uint16_t VERSION = 0x0401;
 
 	static constexpr uint64_t HEADER_MAGIC = 0x00004c5452585843;
 	static constexpr uint64_t VERSION_MASK = 0xffff000000000000;
@@ -178,8 +189,18 @@ public:
 	static constexpr uint32_t PACKET_DIAGNOSTIC = 0xc0000010/* | diagnostic::flavor */;
 	static constexpr uint32_t DIAGNOSTIC_MASK   = 0x0000000f;
 
+	static constexpr uint32_t PACKET_INDEX     = 0xc0000002;
+	static constexpr uint32_t PACKET_INDEX_END = 0xc0000003;
+
 	static constexpr uint32_t PACKET_END     = 0xffffffff;
 
+	// Location of a complete sample within a replay log.
+	struct index_entry {
+		pointer_t pointer;
+		time timestamp;
+		uint64_t position;
+	};
+
 	// Writing spools.
 
 	class writer {
@@ -187,9 +208,34 @@ public:
 		size_t position;
 		std::vector<uint32_t> buffer;
 
+		// In asynchronous mode, the words are pushed into a ring buffer instead, and a background thread writes them
+		// to the file.
+		std::unique_ptr<ring_buffer<uint32_t>> ring;
+		std::thread drainer;
+
+		// The amount of words emitted so far, used to determine positions of samples in the file.
+		uint64_t emitted = 0;
+
+		static void drain(int fd, ring_buffer<uint32_t> *ring) {
+			while (ring->wait()) {
+				const uint32_t *words;
+				size_t count = ring->peek(words);
+				size_t data_size = count * sizeof(uint32_t);
+				size_t data_written = write(fd, words, data_size);
+				assert(data_size == data_written);
+				(void)data_written;
+				ring->release(count);
+			}
+		}
+
 		// These functions aren't overloaded because of implicit numeric conversions.
 
 		void emit_word(uint32_t word) {
+			emitted++;
+			if (ring) {
+				ring->push(word);
+				return;
+			}
 			if (position + 1 == buffer.size())
 				flush();
 			buffer[position++] = word;
@@ -239,7 +285,10 @@ public:
 		// The buffer size is currently fixed to a "reasonably large" size, determined empirically by measuring writer
 		// performance on a representative design; large but not so large it would e.g. cause address space exhaustion
 		// on 32-bit platforms.
-		writer(spool &spool) : fd(spool.take_write()), position(0), buffer(32 * 1024 * 1024) {
+		//
+		// If `asynchronous` is true, the file is written by a background thread, and the simulation thread only copies
+		// the data into the buffer. This is useful when the simulation is I/O bound; the data is the same either way.
+		writer(spool &spool, bool asynchronous = false) : fd(spool.take_write()), position(0) {
 			assert(fd != -1);
 #if !defined(WIN32)
 			int result = ftruncate(fd, 0);
@@ -247,9 +296,16 @@ public:
 			int result = _chsize_s(fd, 0);
 #endif
 			assert(result == 0);
+			if (asynchronous) {
+				ring.reset(new ring_buffer<uint32_t>(32 * 1024 * 1024));
+				drainer = std::thread(drain, fd, ring.get());
+			} else {
+				buffer.resize(32 * 1024 * 1024);
+			}
 		}
 
-		writer(writer &&moved) : fd(moved.fd), position(moved.position), buffer(moved.buffer) {
+		writer(writer &&moved) : fd(moved.fd), position(moved.position), buffer(std::move(moved.buffer)),
+		                         ring(std::move(moved.ring)), drainer(std::move(moved.drainer)), emitted(moved.emitted) {
 			moved.fd = -1;
 			moved.position = 0;
 		}
@@ -258,9 +314,14 @@ public:
 		writer &operator=(const writer &) = delete;
 
 		// Both write() calls and fwrite() calls are too expensive to perform implicitly. The API consumer must determine
-		// the optimal time to flush the writer and do that explicitly for best performance.
+		// the optimal time to flush the writer and do that explicitly for best performance. In asynchronous mode, this
+		// waits until the background thread has written all of the data.
 		void flush() {
 			assert(fd != -1);
+			if (ring) {
+				ring->drain();
+				return;
+			}
 			size_t data_size = position * sizeof(uint32_t);
 			size_t data_written = write(fd, buffer.data(), data_size);
 			assert(data_size == data_written);
@@ -269,11 +330,26 @@ public:
 
 		~writer() {
 			if (fd != -1) {
-				flush();
+				if (ring) {
+					ring->close();
+					drainer.join();
+				} else {
+					flush();
+				}
 				close(fd);
 			}
 		}
 
+		// Returns `false` if the writer has been moved from.
+		bool is_open() const {
+			return fd != -1;
+		}
+
+		// Returns the position in the file at which the next packet will be written.
+		uint64_t offset() const {
+			return emitted * sizeof(uint32_t);
+		}
+
 		void write_magic() {
 			// `CXXRTL` followed by version in binary. This header will read backwards on big-endian machines, which allows
 			// detection of this case, both visually and programmatically.
@@ -328,6 +404,23 @@ public:
 
 		void write_end() {
 			emit_word(PACKET_END);
+			if (ring)
+				ring->publish();
+		}
+
+		void write_index(const std::vector<index_entry> &entries) {
+			uint64_t index_position = offset();
+			emit_word(PACKET_INDEX);
+			emit_size(entries.size());
+			for (auto &entry : entries) {
+				emit_word(entry.pointer);
+				emit_time(entry.timestamp);
+				emit_dword(entry.position);
+			}
+			emit_dword(index_position);
+			emit_word(PACKET_INDEX_END);
+			if (ring)
+				ring->publish();
 		}
 	};
 
@@ -434,6 +527,11 @@ public:
 			uint32_t header = absorb_word();
 			if (header == PACKET_END)
 				return false;
+			if (header == PACKET_INDEX) {
+				// Stay at the end of the samples, so that reading past them repeatedly keeps returning `false`.
+				rewind(position() - sizeof(uint32_t));
+				return false;
+			}
 			assert(header == PACKET_SAMPLE);
 			uint32_t flags = absorb_word();
 			incremental = (flags & sample_flag::INCREMENTAL);
@@ -478,6 +576,30 @@ public:
 				data[chunks * index + offset] = absorb_word();
 		}
 
+		// Reads the index, if the log has one, without changing the current position.
+		bool read_index(std::vector<index_entry> &entries) {
+			pos_t saved_position = position();
+			bool success = false;
+			if (fseek(f, -3 * (long)sizeof(uint32_t), SEEK_END) == 0) {
+				uint64_t index_position = absorb_dword();
+				if (absorb_word() == PACKET_INDEX_END) {
+					rewind(index_position);
+					uint32_t header = absorb_word();
+					assert(header == PACKET_INDEX);
+					(void)header;
+					entries.resize(absorb_size());
+					for (auto &entry : entries) {
+						entry.pointer = absorb_word();
+						entry.timestamp = absorb_time();
+						entry.position = absorb_dword();
+					}
+					success = true;
+				}
+			}
+			rewind(saved_position);
+			return success;
+		}
+
 		bool read_diagnostic(uint32_t header, diagnostic &diagnostic) {
 			if ((header & ~DIAGNOSTIC_MASK) != PACKET_DIAGNOSTIC)
 				return false; // some other packet
@@ -533,6 +655,8 @@ public:
 };
 
 // A CXXRTL recorder samples design state, producing complete or incremental updates, and writes them to a spool.
+// The arguments of the constructor are passed to `spool::writer`; use `recorder(spool, /*asynchronous=*/true)` to write
+// the spool on a background thread.
 class recorder {
 	struct variable {
 		spool::ident_t ident; /* <= spool::MAXIMUM_IDENT */
@@ -549,11 +673,65 @@ class recorder {
 	bool streaming = false; // whether variable definitions have been written
 	spool::pointer_t pointer = 0;
 	time timestamp;
+	time sample_timestamp; // time of the latest sample
+	std::vector<spool::index_entry> index; // every complete sample written so far
+
+	size_t checkpoint_interval = 0;
+	double checkpoint_overhead = 1.0;
+	uint64_t checkpoint_size = 0; // size of the latest complete sample
+	uint64_t checkpoint_end = 0; // offset right after the latest complete sample
+
+	void write_complete_sample() {
+		uint64_t position = writer.offset();
+		index.push_back({pointer, timestamp, position});
+		writer.write_sample(/*incremental=*/false, pointer++, timestamp);
+		sample_timestamp = timestamp;
+		for (auto var : variables) {
+			assert(var.ident != 0);
+			if (!var.memory)
+				writer.write_change(var.ident, var.chunks, var.curr);
+			else
+				for (size_t index = 0; index < var.depth; index++)
+					writer.write_change(var.ident, var.chunks, &var.curr[var.chunks * index], index);
+		}
+		writer.write_end();
+		checkpoint_end = writer.offset();
+		checkpoint_size = checkpoint_end - position;
+	}
+
+	bool checkpoint_due() {
+		if (checkpoint_interval == 0 || index.empty())
+			return false;
+		// Only the first sample at any given time may be a checkpoint, since the player rewinds to the first sample
+		// with the requested time.
+		if (timestamp == sample_timestamp)
+			return false;
+		if (pointer - index.back().pointer < checkpoint_interval)
+			return false;
+		return checkpoint_size <= checkpoint_overhead * (writer.offset() - checkpoint_end);
+	}
 
 public:
 	template<typename ...Args>
 	recorder(Args &&...args) : writer(std::forward<Args>(args)...) {}
 
+	// Writes the index of the complete samples, which allows the player to rewind to any of them immediately.
+	~recorder() {
+		if (streaming && writer.is_open())
+			writer.write_index(index);
+	}
+
+	// Enables periodic checkpoints: a complete sample is recorded instead of an incremental one once at least `interval`
+	// samples have been recorded since the latest complete sample, but only if the size of a complete sample is at most
+	// `max_overhead` times the size of the samples recorded since then. This bounds both the amount of samples the player
+	// has to read to rewind to any time, and the space taken up by checkpoints. An `interval` of 0 (the default) disables
+	// periodic checkpoints.
+	void set_checkpoint_interval(size_t interval, double max_overhead = 1.0) {
+		assert(max_overhead > 0);
+		checkpoint_interval = interval;
+		checkpoint_overhead = max_overhead;
+	}
+
 	void start(module &module, std::string top_path = "") {
 		debug_items items;
 		module.debug_info(&items, /*scopes=*/nullptr, top_path);
@@ -602,16 +780,7 @@ public:
 	void record_complete() {
 		assert(streaming);
 
-		writer.write_sample(/*incremental=*/false, pointer++, timestamp);
-		for (auto var : variables) {
-			assert(var.ident != 0);
-			if (!var.memory)
-				writer.write_change(var.ident, var.chunks, var.curr);
-			else
-				for (size_t index = 0; index < var.depth; index++)
-					writer.write_change(var.ident, var.chunks, &var.curr[var.chunks * index], index);
-		}
-		writer.write_end();
+		write_complete_sample();
 	}
 
 	// This function is generic over ModuleT to encourage observer callbacks to be inlined into the commit function.
@@ -636,7 +805,14 @@ public:
 		record_observer.ident_lookup = &ident_lookup;
 		record_observer.writer = &writer;
 
+		if (checkpoint_due()) {
+			bool changed = module.commit();
+			write_complete_sample();
+			return changed;
+		}
+
 		writer.write_sample(/*incremental=*/true, pointer++, timestamp);
+		sample_timestamp = timestamp;
 		for (auto input_index : inputs) {
 			variable &var = variables.at(input_index);
 			assert(!var.memory);
@@ -655,6 +831,7 @@ public:
 		// code should be changed to accumulate diagnostics to a buffer that is flushed in `record_{complete,incremental}`
 		// and also in `advance_time` before the timestamp is changed. (Right now `advance_time` never writes to the spool.)
 		writer.write_sample(/*incremental=*/true, pointer++, timestamp);
+		sample_timestamp = timestamp;
 		writer.write_diagnostic(diagnostic);
 		writer.write_end();
 	}
@@ -731,6 +908,15 @@ public:
 		assert(variables.size() > 0);
 		streaming = true;
 
+		// If the recording has been finished, every complete sample is known in advance. If there are several complete
+		// samples with the same time, the timestamp is associated with the first one, as in `replay()`.
+		std::vector<spool::index_entry> entries;
+		if (reader.read_index(entries))
+			for (auto &entry : entries) {
+				index_by_pointer.emplace(entry.pointer, entry.position);
+				index_by_timestamp.emplace(entry.timestamp, entry.position);
+			}
+
 		// Establish the initial state of the design.
 		std::vector<diagnostic> diagnostics;
 		initialized = replay(&diagnostics);
@@ -847,9 +1033,8 @@ public:
 		// Ensure that we associate the timestamp with the position of the first such complete sample. (This condition
 		// works because the player never jumps over a sample.)
 		if (!incremental && !index_by_pointer.count(pointer)) {
-			assert(!index_by_timestamp.count(timestamp));
 			index_by_pointer[pointer] = position;
-			index_by_timestamp[timestamp] = position;
+			index_by_timestamp.emplace(timestamp, position);
 		}
 
 		uint32_t header;
@@ -0,0 +1,170 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+// This file is included by the asynchronous VCD and replay writers. It is not used in Yosys itself.
+//
+// The ring buffer is used to move trace data from the simulation thread (the producer) to a background thread
+// (the consumer) that formats it and performs file I/O. Neither side ever takes a lock: the producer only waits
+// if the buffer is full, and the consumer only waits if it is empty.
+
+#ifndef CXXRTL_RING_BUFFER_H
+#define CXXRTL_RING_BUFFER_H
+
+#include <cassert>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace cxxrtl {
+
+template<class T>
+class ring_buffer {
+	std::unique_ptr<T[]> data;
+	size_t mask;
+
+	// Items below `published` may be read by the consumer, and items below `consumed` may be overwritten by
+	// the producer. Both indices increase monotonically and are reduced modulo the capacity when accessing `data`.
+	std::atomic<size_t> published;
+	std::atomic<size_t> consumed;
+	std::atomic<bool> closed;
+
+	// Owned by the producer.
+	size_t write_index = 0;
+	size_t write_limit = 0;
+
+	// Owned by the consumer.
+	size_t read_index = 0;
+	size_t read_limit = 0;
+
+	// The consumer releases the items it has read in batches, so that the producer doesn't have to wait until
+	// the buffer is completely drained when it is full.
+	static constexpr size_t RELEASE_BATCH = 4096;
+
+	void wait_for_space() {
+		publish();
+		for (unsigned attempt = 0; write_index == write_limit; attempt++) {
+			write_limit = consumed.load(std::memory_order_acquire) + mask + 1;
+			if (write_index == write_limit)
+				backoff(attempt);
+		}
+	}
+
+public:
+	// Waits for the other side of the buffer to make progress, yielding the processor first and then sleeping.
+	static void backoff(unsigned attempt) {
+		if (attempt < 64)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+
+	// The capacity is rounded up to the next power of two.
+	explicit ring_buffer(size_t capacity) : published(0), consumed(0), closed(false) {
+		size_t size = 1;
+		while (size < capacity)
+			size <<= 1;
+		data.reset(new T[size]);
+		mask = size - 1;
+		write_limit = size;
+	}
+
+	ring_buffer(const ring_buffer &) = delete;
+	ring_buffer &operator=(const ring_buffer &) = delete;
+
+	size_t capacity() const {
+		return mask + 1;
+	}
+
+	// Producer interface.
+
+	// Adds an item to the buffer. The item will not be visible to the consumer until it is published.
+	void push(const T &item) {
+		if (write_index == write_limit)
+			wait_for_space();
+		data[write_index & mask] = item;
+		write_index++;
+	}
+
+	// Makes every pushed item visible to the consumer. Publishing is cheap, but the consumer may not make progress
+	// until it happens, so it should be done at natural boundaries in the data (e.g. at the end of each sample).
+	// If the buffer becomes full, the items are published implicitly.
+	void publish() {
+		published.store(write_index, std::memory_order_release);
+	}
+
+	// Publishes every pushed item and waits until the consumer has read all of them.
+	void drain() {
+		publish();
+		for (unsigned attempt = 0; consumed.load(std::memory_order_acquire) != write_index; attempt++)
+			backoff(attempt);
+	}
+
+	// Publishes every pushed item and indicates that no more items will be pushed.
+	void close() {
+		publish();
+		closed.store(true, std::memory_order_release);
+	}
+
+	// Consumer interface.
+
+	// Waits until an item can be read. Returns `false` if the buffer has been closed and every item has been read.
+	bool wait() {
+		for (unsigned attempt = 0; read_index == read_limit; attempt++) {
+			consumed.store(read_index, std::memory_order_release);
+			bool was_closed = closed.load(std::memory_order_acquire);
+			read_limit = published.load(std::memory_order_acquire);
+			if (read_index != read_limit)
+				break;
+			if (was_closed)
+				return false;
+			backoff(attempt);
+		}
+		return true;
+	}
+
+	// Reads a single item, waiting for it if necessary. The buffer must not be closed with a partially written
+	// record in it.
+	T pop() {
+		bool available = wait();
+		assert(available);
+		(void)available;
+		T item = data[read_index & mask];
+		if ((++read_index & (RELEASE_BATCH - 1)) == 0)
+			consumed.store(read_index, std::memory_order_release);
+		return item;
+	}
+
+	// Returns the amount of items that can be read contiguously starting at `items`, which is at least one if
+	// the preceding call to `wait()` returned `true`. Once processed, the items must be released with `release()`.
+	size_t peek(const T *&items) {
+		size_t offset = read_index & mask;
+		items = &data[offset];
+		size_t count = read_limit - read_index;
+		return count < capacity() - offset ? count : capacity() - offset;
+	}
+
+	void release(size_t count) {
+		assert(count <= read_limit - read_index);
+		read_index += count;
+		consumed.store(read_index, std::memory_order_release);
+	}
+};
+
+} // namespace cxxrtl
+
+#endif
@@ -19,11 +19,15 @@
 #ifndef CXXRTL_VCD_H
 #define CXXRTL_VCD_H
 
+#include <thread>
+
 #include <cxxrtl/cxxrtl.h>
+#include <cxxrtl/cxxrtl_ring_buffer.h>
 
 namespace cxxrtl {
 
 class vcd_writer {
+protected:
 	struct variable {
 		size_t ident;
 		size_t width;
@@ -108,19 +112,19 @@ class vcd_writer {
 		buffer += "#" + std::to_string(timestamp) + "\n";
 	}
 
-	void emit_scalar(const variable &var) {
+	void emit_scalar(const variable &var, const chunk_t *curr) {
 		assert(streaming);
 		assert(var.width == 1);
-		buffer += (*var.curr ? '1' : '0');
+		buffer += (*curr ? '1' : '0');
 		emit_ident(var.ident);
 		buffer += '\n';
 	}
 
-	void emit_vector(const variable &var) {
+	void emit_vector(const variable &var, const chunk_t *curr) {
 		assert(streaming);
 		buffer += 'b';
 		for (size_t bit = var.width - 1; bit != (size_t)-1; bit--) {
-			bool bit_curr = var.curr[bit / (8 * sizeof(chunk_t))] & (1 << (bit % (8 * sizeof(chunk_t))));
+			bool bit_curr = curr[bit / (8 * sizeof(chunk_t))] & (1 << (bit % (8 * sizeof(chunk_t))));
 			buffer += (bit_curr ? '1' : '0');
 		}
 		buffer += ' ';
@@ -263,10 +267,131 @@ public:
 		for (auto var : variables)
 			if (test_variable(var) || first_sample) {
 				if (var.width == 1)
-					emit_scalar(var);
+					emit_scalar(var, var.curr);
+				else
+					emit_vector(var, var.curr);
+			}
+	}
+};
+
+// An asynchronous VCD writer moves formatting of the samples and file I/O off the simulation thread. The simulation
+// thread only checks the variables for changes and copies the raw chunks of the changed ones into a ring buffer;
+// a background thread formats them and writes the result to `output`, which must outlive the writer.
+//
+// Variables are added as with `vcd_writer`. Instead of `buffer`, the output is written directly to the stream.
+// The output is identical to the output of `vcd_writer` given the same sequence of calls.
+class async_vcd_writer : protected vcd_writer {
+	// Words in the ring buffer are chunks, and each sample consists of a `TIME` marker followed by the two halves
+	// of the timestamp, followed by the identifier and the chunks of every changed variable. The identifier of
+	// a variable is also its index in `variables`, which are not changed once the first sample is taken.
+	enum : chunk_t {
+		TIME  = ~(chunk_t)0,
+		FLUSH = ~(chunk_t)1,
+	};
+
+	std::ostream &output;
+	ring_buffer<chunk_t> ring;
+	std::thread formatter;
+	std::atomic<size_t> flushes_done;
+	size_t flushes_requested = 0;
+
+	void push_chunks(const variable &var) {
+		const size_t chunks = (var.width + (sizeof(chunk_t) * 8 - 1)) / (sizeof(chunk_t) * 8);
+		for (size_t n = 0; n < chunks; n++)
+			ring.push(var.curr[n]);
+	}
+
+	void format() {
+		std::vector<chunk_t> curr;
+		while (ring.wait()) {
+			chunk_t word = ring.pop();
+			if (word == TIME) {
+				uint64_t timestamp = ring.pop();
+				timestamp |= (uint64_t)ring.pop() << 32;
+				emit_time(timestamp);
+			} else if (word == FLUSH) {
+				output.write(buffer.data(), buffer.size());
+				output.flush();
+				buffer.clear();
+				flushes_done.fetch_add(1, std::memory_order_release);
+			} else {
+				const variable &var = variables[word];
+				const size_t chunks = (var.width + (sizeof(chunk_t) * 8 - 1)) / (sizeof(chunk_t) * 8);
+				curr.resize(chunks);
+				for (size_t n = 0; n < chunks; n++)
+					curr[n] = ring.pop();
+				if (var.width == 1)
+					emit_scalar(var, curr.data());
 				else
-					emit_vector(var);
+					emit_vector(var, curr.data());
+			}
+			if (buffer.size() >= 65536) {
+				output.write(buffer.data(), buffer.size());
+				buffer.clear();
 			}
+		}
+		output.write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+
+public:
+	// The capacity of the ring buffer is given in chunks. If the simulation thread produces data faster than it can
+	// be written, it waits when the ring buffer becomes full.
+	explicit async_vcd_writer(std::ostream &output, size_t capacity = 4 * 1024 * 1024)
+		: output(output), ring(capacity), flushes_done(0) {}
+
+	async_vcd_writer(const async_vcd_writer &) = delete;
+	async_vcd_writer &operator=(const async_vcd_writer &) = delete;
+
+	~async_vcd_writer() {
+		if (formatter.joinable()) {
+			ring.close();
+			formatter.join();
+		} else {
+			output.write(buffer.data(), buffer.size());
+		}
+		output.flush();
+	}
+
+	using vcd_writer::timescale;
+	using vcd_writer::add;
+	using vcd_writer::add_without_memories;
+
+	void sample(uint64_t timestamp) {
+		bool first_sample = !streaming;
+		if (first_sample) {
+			emit_scope({});
+			emit_enddefinitions();
+			output.write(buffer.data(), buffer.size());
+			buffer.clear();
+			formatter = std::thread(&async_vcd_writer::format, this);
+		}
+		reset_outlines();
+		ring.push(TIME);
+		ring.push((chunk_t)timestamp);
+		ring.push((chunk_t)(timestamp >> 32));
+		for (auto var : variables)
+			if (test_variable(var) || first_sample) {
+				assert(var.ident < FLUSH);
+				ring.push(var.ident);
+				push_chunks(var);
+			}
+		ring.publish();
+	}
+
+	// Waits until every sample taken so far has been written to the output, and flushes the output.
+	void flush() {
+		if (!formatter.joinable()) {
+			output.write(buffer.data(), buffer.size());
+			buffer.clear();
+			output.flush();
+			return;
+		}
+		ring.push(FLUSH);
+		ring.publish();
+		flushes_requested++;
+		for (unsigned attempt = 0; flushes_done.load(std::memory_order_acquire) != flushes_requested; attempt++)
+			ring_buffer<chunk_t>::backoff(attempt);
 	}
 };
 
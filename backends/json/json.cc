@@ -40,7 +40,8 @@ struct JsonWriter
 
 	SigMap sigmap;
 	int sigidcounter;
-	dict<SigBit, string> sigids;
+	dict<SigBit, int> sigids;
+	string bits_buffer;
 	pool<Aig> aig_models;
 
 	JsonWriter(std::ostream &f, bool use_selection, bool aig_mode, bool compat_int_mode) :
@@ -78,26 +79,35 @@ struct JsonWriter
 		return get_string(RTLIL::unescape_id(name));
 	}
 
-	string get_bits(SigSpec sig)
+	// Bit lists make up most of the output for large netlists, so they are formatted by hand into a reused
+	// buffer instead of going through stringf.
+	void write_bits(SigSpec sig)
 	{
 		bool first = true;
-		string str = "[";
+		string &str = bits_buffer;
+		str.clear();
+		str += "[";
 		for (auto bit : sigmap(sig)) {
 			str += first ? " " : ", ";
 			first = false;
-			if (sigids.count(bit) == 0) {
-				string &s = sigids[bit];
-				if (bit.wire == nullptr) {
-					if (bit == State::S0) s = "\"0\"";
-					else if (bit == State::S1) s = "\"1\"";
-					else if (bit == State::Sz) s = "\"z\"";
-					else s = "\"x\"";
-				} else
-					s = stringf("%d", sigidcounter++);
+			if (bit.wire == nullptr) {
+				if (bit == State::S0) str += "\"0\"";
+				else if (bit == State::S1) str += "\"1\"";
+				else if (bit == State::Sz) str += "\"z\"";
+				else str += "\"x\"";
+				continue;
 			}
-			str += sigids[bit];
+			auto it = sigids.find(bit);
+			int id = it != sigids.end() ? it->second : (sigids[bit] = sigidcounter++);
+			char digits[16], *p = digits + sizeof(digits);
+			do {
+				*--p = '0' + id % 10;
+				id /= 10;
+			} while (id != 0);
+			str.append(p, digits + sizeof(digits));
 		}
-		return str + " ]";
+		str += " ]";
+		f.write(str.data(), str.size());
 	}
 
 	void write_parameter_value(const Const &value)
@@ -181,7 +191,9 @@ struct JsonWriter
 				f << stringf("          \"upto\": 1,\n");
 			if (w->is_signed)
 				f << stringf("          \"signed\": %d,\n", w->is_signed);
-			f << stringf("          \"bits\": %s\n", get_bits(w).c_str());
+			f << "          \"bits\": ";
+			write_bits(w);
+			f << "\n";
 			f << stringf("        }");
 			first = false;
 		}
@@ -230,7 +242,8 @@ struct JsonWriter
 			bool first2 = true;
 			for (auto &conn : c->connections()) {
 				f << stringf("%s\n", first2 ? "" : ",");
-				f << stringf("            %s: %s", get_name(conn.first).c_str(), get_bits(conn.second).c_str());
+				f << stringf("            %s: ", get_name(conn.first).c_str());
+				write_bits(conn.second);
 				first2 = false;
 			}
 			f << stringf("\n          }\n");
@@ -268,7 +281,9 @@ struct JsonWriter
 			f << stringf("%s\n", first ? "" : ",");
 			f << stringf("        %s: {\n", get_name(w->name).c_str());
 			f << stringf("          \"hide_name\": %s,\n", w->name[0] == '$' ? "1" : "0");
-			f << stringf("          \"bits\": %s,\n", get_bits(w).c_str());
+			f << "          \"bits\": ";
+			write_bits(w);
+			f << ",\n";
 			if (w->start_offset)
 				f << stringf("          \"offset\": %d,\n", w->start_offset);
 			if (w->upto)
@@ -431,10 +431,16 @@ struct RTLILBackend : public Backend {
 		log("    -selected\n");
 		log("        only write selected parts of the design.\n");
 		log("\n");
+		log("    -binary\n");
+		log("        write the design in a compact binary format instead of text. the file\n");
+		log("        can be read back with read_rtlil, which detects the format. in this\n");
+		log("        format, -selected always writes all wires of the selected modules.\n");
+		log("\n");
 	}
 	void execute(std::ostream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		bool selected = false;
+		bool binary = false;
 
 		log_header(design, "Executing RTLIL backend.\n");
 
@@ -445,13 +451,21 @@ struct RTLILBackend : public Backend {
 				selected = true;
 				continue;
 			}
+			if (arg == "-binary") {
+				binary = true;
+				continue;
+			}
 			break;
 		}
-		extra_args(f, filename, args, argidx);
+		extra_args(f, filename, args, argidx, binary);
 
 		design->sort();
 
 		log("Output filename: %s\n", filename.c_str());
+		if (binary) {
+			RTLIL_BACKEND::dump_design_binary(*f, design, selected);
+			return;
+		}
 		*f << stringf("# Generated by %s\n", yosys_version_str);
 		RTLIL_BACKEND::dump_design(*f, design, selected, true, false);
 	}
@@ -0,0 +1,321 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  ---
+ *
+ *  Writer for the binary RTLIL format. See rtlil_binary.h for a
+ *  description of the encoding.
+ *
+ */
+
+#include "rtlil_backend.h"
+#include "rtlil_binary.h"
+#include "kernel/yosys.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+namespace {
+
+// The hashlib containers iterate over their entries in reverse insertion order. Entries are written in insertion
+// order instead, so that the reader rebuilds containers that iterate in the same order by inserting them as read.
+template<typename T>
+auto insertion_order(const T &container) -> std::vector<decltype(&*container.begin())>
+{
+	std::vector<decltype(&*container.begin())> entries;
+	entries.reserve(container.size());
+	for (int i = GetSize(container) - 1; i >= 0; i--)
+		entries.push_back(&*container.element(i));
+	return entries;
+}
+
+struct BinaryWriter
+{
+	std::ostream &f;
+	std::string buffer;
+	dict<RTLIL::IdString, int> id_index;
+	dict<const RTLIL::Wire*, int> wire_index;
+
+	BinaryWriter(std::ostream &f) : f(f) { }
+
+	void flush()
+	{
+		f.write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+
+	void write_uint(uint64_t value)
+	{
+		while (value >= 0x80) {
+			buffer += char(value | 0x80);
+			value >>= 7;
+		}
+		buffer += char(value);
+	}
+
+	void write_int(int64_t value)
+	{
+		write_uint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+	}
+
+	void write_bytes(const char *data, size_t size)
+	{
+		buffer.append(data, size);
+		if (buffer.size() >= (1 << 20))
+			flush();
+	}
+
+	void write_id(RTLIL::IdString id)
+	{
+		auto it = id_index.find(id);
+		if (it != id_index.end()) {
+			write_uint(it->second + 1);
+			return;
+		}
+		int index = GetSize(id_index);
+		id_index[id] = index;
+		const std::string &str = id.str();
+		write_uint(0);
+		write_uint(str.size());
+		write_bytes(str.data(), str.size());
+	}
+
+	void write_const(const RTLIL::Const &data, int width, int offset)
+	{
+		bool two_valued = true;
+		for (int i = offset; i < offset + width; i++)
+			if (data.bits[i] != State::S0 && data.bits[i] != State::S1) {
+				two_valued = false;
+				break;
+			}
+		write_uint((uint64_t(data.flags) << 1) | (two_valued ? 0 : 1));
+		write_uint(width);
+
+		int per_byte = two_valued ? 8 : 2, bits_per_state = two_valued ? 1 : 4;
+		for (int i = 0; i < width; i += per_byte) {
+			unsigned char byte = 0;
+			for (int j = 0; j < per_byte && i + j < width; j++)
+				byte |= data.bits[offset + i + j] << (j * bits_per_state);
+			buffer += char(byte);
+		}
+		if (buffer.size() >= (1 << 20))
+			flush();
+	}
+
+	void write_const(const RTLIL::Const &data)
+	{
+		write_const(data, GetSize(data.bits), 0);
+	}
+
+	void write_sigspec(const RTLIL::SigSpec &sig)
+	{
+		write_uint(GetSize(sig.chunks()));
+		for (auto &chunk : sig.chunks()) {
+			if (chunk.wire == nullptr) {
+				write_uint(0);
+				write_const(chunk.data, chunk.width, 0);
+			} else {
+				write_uint(wire_index.at(chunk.wire) + 1);
+				if (chunk.offset == 0 && chunk.width == chunk.wire->width) {
+					write_uint(0);
+					write_uint(0);
+				} else {
+					write_uint(chunk.offset);
+					write_uint(chunk.width);
+				}
+			}
+		}
+	}
+
+	void write_attributes(const dict<RTLIL::IdString, RTLIL::Const> &attributes)
+	{
+		write_uint(GetSize(attributes));
+		for (auto it : insertion_order(attributes)) {
+			write_id(it->first);
+			write_const(it->second);
+		}
+	}
+
+	void write_case_body(const RTLIL::CaseRule *cs)
+	{
+		write_uint(GetSize(cs->actions));
+		for (auto &it : cs->actions) {
+			write_sigspec(it.first);
+			write_sigspec(it.second);
+		}
+		write_uint(GetSize(cs->switches));
+		for (auto sw : cs->switches) {
+			write_attributes(sw->attributes);
+			write_sigspec(sw->signal);
+			write_uint(GetSize(sw->cases));
+			for (auto cs2 : sw->cases) {
+				write_attributes(cs2->attributes);
+				write_uint(GetSize(cs2->compare));
+				for (auto &compare : cs2->compare)
+					write_sigspec(compare);
+				write_case_body(cs2);
+			}
+		}
+	}
+
+	void write_sync(const RTLIL::SyncRule *sy)
+	{
+		write_uint(sy->type);
+		write_sigspec(sy->signal);
+		write_uint(GetSize(sy->actions));
+		for (auto &it : sy->actions) {
+			write_sigspec(it.first);
+			write_sigspec(it.second);
+		}
+		write_uint(GetSize(sy->mem_write_actions));
+		for (auto &it : sy->mem_write_actions) {
+			write_attributes(it.attributes);
+			write_id(it.memid);
+			write_sigspec(it.address);
+			write_sigspec(it.data);
+			write_sigspec(it.enable);
+			write_const(it.priority_mask);
+		}
+	}
+
+	void write_module(RTLIL::Module *module, RTLIL::Design *design, bool only_selected)
+	{
+		write_attributes(module->attributes);
+		write_id(module->name);
+
+		write_uint(GetSize(module->avail_parameters));
+		for (auto &param : module->avail_parameters) {
+			write_id(param);
+			auto it = module->parameter_default_values.find(param);
+			if (it == module->parameter_default_values.end()) {
+				write_uint(0);
+			} else {
+				write_uint(1);
+				write_const(it->second);
+			}
+		}
+
+		// All wires of a partially selected module are written, so that the signals of the selected objects
+		// can always be resolved.
+		wire_index.clear();
+		write_uint(GetSize(module->wires_));
+		for (auto it : insertion_order(module->wires_)) {
+			RTLIL::Wire *wire = it->second;
+			wire_index[wire] = GetSize(wire_index);
+			write_attributes(wire->attributes);
+			write_id(wire->name);
+			write_uint(wire->width);
+			write_int(wire->start_offset);
+			write_uint((wire->upto ? 1 : 0) | (wire->is_signed ? 2 : 0) | (wire->port_input ? 4 : 0) | (wire->port_output ? 8 : 0));
+			write_uint(wire->port_id);
+		}
+
+		std::vector<RTLIL::Memory*> memories;
+		for (auto it : insertion_order(module->memories))
+			if (!only_selected || design->selected(module, it->second))
+				memories.push_back(it->second);
+		write_uint(GetSize(memories));
+		for (auto memory : memories) {
+			write_attributes(memory->attributes);
+			write_id(memory->name);
+			write_uint(memory->width);
+			write_uint(memory->size);
+			write_int(memory->start_offset);
+		}
+
+		std::vector<RTLIL::Cell*> cells;
+		for (auto it : insertion_order(module->cells_))
+			if (!only_selected || design->selected(module, it->second))
+				cells.push_back(it->second);
+		write_uint(GetSize(cells));
+		for (auto cell : cells) {
+			write_attributes(cell->attributes);
+			write_id(cell->type);
+			write_id(cell->name);
+			write_uint(GetSize(cell->parameters));
+			for (auto it : insertion_order(cell->parameters)) {
+				write_id(it->first);
+				write_const(it->second);
+			}
+			write_uint(GetSize(cell->connections()));
+			for (auto it : insertion_order(cell->connections())) {
+				write_id(it->first);
+				write_sigspec(it->second);
+			}
+		}
+
+		std::vector<RTLIL::Process*> processes;
+		for (auto it : insertion_order(module->processes))
+			if (!only_selected || design->selected(module, it->second))
+				processes.push_back(it->second);
+		write_uint(GetSize(processes));
+		for (auto proc : processes) {
+			write_attributes(proc->attributes);
+			write_id(proc->name);
+			write_case_body(&proc->root_case);
+			write_uint(GetSize(proc->syncs));
+			for (auto sync : proc->syncs)
+				write_sync(sync);
+		}
+
+		std::vector<const RTLIL::SigSig*> connections;
+		for (auto &it : module->connections()) {
+			bool show_conn = !only_selected || design->selected_whole_module(module->name);
+			if (!show_conn) {
+				RTLIL::SigSpec sigs = it.first;
+				sigs.append(it.second);
+				for (auto &chunk : sigs.chunks())
+					if (chunk.wire != nullptr && design->selected(module, chunk.wire))
+						show_conn = true;
+			}
+			if (show_conn)
+				connections.push_back(&it);
+		}
+		write_uint(GetSize(connections));
+		for (auto conn : connections) {
+			write_sigspec(conn->first);
+			write_sigspec(conn->second);
+		}
+		if (buffer.size() >= (1 << 20))
+			flush();
+	}
+
+	void write_design(RTLIL::Design *design, bool only_selected)
+	{
+		write_bytes(RTLIL_BINARY::magic, sizeof(RTLIL_BINARY::magic));
+		write_uint(RTLIL_BINARY::version);
+		write_uint(autoidx);
+
+		std::vector<RTLIL::Module*> modules;
+		for (auto it : insertion_order(design->modules_))
+			if (!only_selected || design->selected(it->second))
+				modules.push_back(it->second);
+		write_uint(GetSize(modules));
+		for (auto module : modules)
+			write_module(module, design, only_selected);
+		flush();
+	}
+};
+
+}
+
+void RTLIL_BACKEND::dump_design_binary(std::ostream &f, RTLIL::Design *design, bool only_selected)
+{
+	BinaryWriter writer(f);
+	writer.write_design(design, only_selected);
+}
+
+YOSYS_NAMESPACE_END
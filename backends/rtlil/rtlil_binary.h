@@ -0,0 +1,60 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  ---
+ *
+ *  Definitions shared by the reader and the writer of the binary RTLIL
+ *  format (`write_rtlil -binary`).
+ *
+ *  The file starts with the 8 byte magic below, followed by the format
+ *  version, the value of autoidx and the modules. All integers are
+ *  unsigned LEB128 varints; signed integers are zigzag encoded first.
+ *
+ *  IdStrings are written once and referenced by index afterwards: a
+ *  reference is the index of the string plus one, or zero followed by
+ *  the length and the characters of a string that hasn't been seen yet,
+ *  which then gets the next index.
+ *
+ *  Within a module, wires are referenced by the order in which they are
+ *  defined. A SigSpec is a list of chunks; a chunk is either a zero
+ *  followed by a constant, or the wire index plus one followed by the
+ *  offset and the width of the chunk, where a width of zero stands for
+ *  the entire wire. A constant is its flags (shifted left by one, with
+ *  the low bit set if it has bits other than 0 and 1) and its width,
+ *  followed by its bits packed 8 to a byte, or 2 to a byte otherwise.
+ *
+ *  The structure of the design follows the text format closely; see
+ *  the writer for the exact order of the fields. The entries of hashed
+ *  containers (modules, wires, cells, attributes, ...) are written in
+ *  insertion order, so that reading a file rebuilds containers that
+ *  iterate in the same order as the ones that were written.
+ *
+ */
+
+#ifndef RTLIL_BINARY_H
+#define RTLIL_BINARY_H
+
+YOSYS_NAMESPACE_BEGIN
+
+namespace RTLIL_BINARY {
+	static const char magic[8] = { '\x89', 'R', 'T', 'L', 'I', 'L', '\r', '\n' };
+	static const int version = 1;
+}
+
+YOSYS_NAMESPACE_END
+
+#endif
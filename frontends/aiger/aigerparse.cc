@@ -35,6 +35,13 @@
 #endif
 #include <inttypes.h>
 
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
 #include "kernel/celltypes.h"
@@ -268,7 +275,7 @@ end_of_header:
 	else
 		log_abort();
 
-	RTLIL::Wire* n0 = module->wire(stringf("$aiger%d$0", aiger_autoidx));
+	RTLIL::Wire* n0 = literalWire(0);
 	if (n0)
 		module->connect(n0, State::S0);
 
@@ -336,30 +343,53 @@ static uint32_t parse_xaiger_literal(std::istream &f)
 	return from_big_endian(l);
 }
 
+// Returns "<prefix><aiger_autoidx>$<variable>" (with a "b" appended for inverted literals). The names are built
+// by hand since this is done for every object that the reader creates.
+RTLIL::IdString AigerReader::literalName(const char *prefix, unsigned variable, bool invert)
+{
+	char digits[16], *p = digits + sizeof(digits);
+	do {
+		*--p = '0' + variable % 10;
+		variable /= 10;
+	} while (variable != 0);
+
+	name_buffer = prefix;
+	name_buffer += std::to_string(aiger_autoidx);
+	name_buffer += '$';
+	name_buffer.append(p, digits + sizeof(digits));
+	if (invert)
+		name_buffer += 'b';
+	return name_buffer;
+}
+
+RTLIL::Wire* AigerReader::literalWire(unsigned literal)
+{
+	return literal < literal_wires.size() ? literal_wires[literal] : nullptr;
+}
+
 RTLIL::Wire* AigerReader::createWireIfNotExists(RTLIL::Module *module, unsigned literal)
 {
+	log_assert(module == this->module);
+	if (literal >= literal_wires.size())
+		literal_wires.resize(std::max<size_t>(literal + 1, 2 * (size_t(M) + 1)));
+	RTLIL::Wire *&wire = literal_wires[literal];
+	if (wire) return wire;
+
 	const unsigned variable = literal >> 1;
 	const bool invert = literal & 1;
-	RTLIL::IdString wire_name(stringf("$aiger%d$%d%s", aiger_autoidx, variable, invert ? "b" : ""));
-	RTLIL::Wire *wire = module->wire(wire_name);
-	if (wire) return wire;
+	RTLIL::IdString wire_name = literalName("$aiger", variable, invert);
 	log_debug2("Creating %s\n", wire_name.c_str());
 	wire = module->addWire(wire_name);
-	wire->port_input = wire->port_output = false;
 	if (!invert) return wire;
-	RTLIL::IdString wire_inv_name(stringf("$aiger%d$%d", aiger_autoidx, variable));
-	RTLIL::Wire *wire_inv = module->wire(wire_inv_name);
-	if (wire_inv) {
-		if (module->cell(wire_inv_name)) return wire;
-	}
-	else {
-		log_debug2("Creating %s\n", wire_inv_name.c_str());
-		wire_inv = module->addWire(wire_inv_name);
-		wire_inv->port_input = wire_inv->port_output = false;
+
+	RTLIL::Wire *&wire_inv = literal_wires[literal ^ 1];
+	if (!wire_inv) {
+		log_debug2("Creating %s\n", literalName("$aiger", variable).c_str());
+		wire_inv = module->addWire(literalName("$aiger", variable));
 	}
 
-	log_debug2("Creating %s = ~%s\n", wire_name.c_str(), wire_inv_name.c_str());
-	module->addNotGate(stringf("$not$aiger%d$%d", aiger_autoidx, variable), wire_inv, wire);
+	log_debug2("Creating %s = ~%s\n", wire_name.c_str(), wire_inv->name.c_str());
+	module->addNotGate(literalName("$not$aiger", variable), wire_inv, wire);
 
 	return wire;
 }
@@ -396,7 +426,7 @@ void AigerReader::parse_xaiger()
 	else
 		log_abort();
 
-	RTLIL::Wire* n0 = module->wire(stringf("$aiger%d$0", aiger_autoidx));
+	RTLIL::Wire* n0 = literalWire(0);
 	if (n0)
 		module->connect(n0, State::S0);
 
@@ -420,7 +450,7 @@ void AigerReader::parse_xaiger()
 				uint32_t rootNodeID = parse_xaiger_literal(f);
 				uint32_t cutLeavesM = parse_xaiger_literal(f);
 				log_debug2("rootNodeID=%d cutLeavesM=%d\n", rootNodeID, cutLeavesM);
-				RTLIL::Wire *output_sig = module->wire(stringf("$aiger%d$%d", aiger_autoidx, rootNodeID));
+				RTLIL::Wire *output_sig = literalWire(rootNodeID << 1);
 				log_assert(output_sig);
 				uint32_t nodeID;
 				RTLIL::SigSpec input_sig;
@@ -431,7 +461,7 @@ void AigerReader::parse_xaiger()
 						log_debug("\tLUT '$lut$aiger%d$%d' input %d is constant!\n", aiger_autoidx, rootNodeID, cutLeavesM);
 						continue;
 					}
-					RTLIL::Wire *wire = module->wire(stringf("$aiger%d$%d", aiger_autoidx, nodeID));
+					RTLIL::Wire *wire = literalWire(nodeID << 1);
 					log_assert(wire);
 					input_sig.append(wire);
 				}
@@ -450,10 +480,10 @@ void AigerReader::parse_xaiger()
 					log_assert(o.wire == nullptr);
 					lut_mask[gray] = o.data;
 				}
-				RTLIL::Cell *output_cell = module->cell(stringf("$and$aiger%d$%d", aiger_autoidx, rootNodeID));
+				RTLIL::Cell *output_cell = module->cell(literalName("$and$aiger", rootNodeID));
 				log_assert(output_cell);
 				module->remove(output_cell);
-				module->addLut(stringf("$lut$aiger%d$%d", aiger_autoidx, rootNodeID), input_sig, output_sig, std::move(lut_mask));
+				module->addLut(literalName("$lut$aiger", rootNodeID), input_sig, output_sig, std::move(lut_mask));
 			}
 		}
 		else if (c == 'r') {
@@ -634,19 +664,37 @@ void AigerReader::parse_aiger_ascii()
 		RTLIL::Wire *o_wire = createWireIfNotExists(module, l1);
 		RTLIL::Wire *i1_wire = createWireIfNotExists(module, l2);
 		RTLIL::Wire *i2_wire = createWireIfNotExists(module, l3);
-		module->addAndGate("$and" + o_wire->name.str(), i1_wire, i2_wire, o_wire);
+		module->addAndGate(literalName("$and$aiger", l1 >> 1), i1_wire, i2_wire, o_wire);
 	}
 }
 
-static unsigned parse_next_delta_literal(std::istream &f, unsigned ref)
+template<typename NextByte>
+static unsigned parse_next_delta_literal(NextByte &next_byte, unsigned ref)
 {
 	unsigned x = 0, i = 0;
 	unsigned char ch;
-	while ((ch = f.get()) & 0x80)
+	while ((ch = next_byte()) & 0x80)
 		x |= (ch & 0x7f) << (7 * i++);
 	return ref - (x | (ch << (7 * i)));
 }
 
+template<typename NextByte>
+void AigerReader::parse_aiger_binary_ands(NextByte next_byte)
+{
+	unsigned l1 = (I+L+1) << 1, l2, l3;
+	for (unsigned i = 0; i < A; ++i, ++line_count, l1 += 2) {
+		l2 = parse_next_delta_literal(next_byte, l1);
+		l3 = parse_next_delta_literal(next_byte, l2);
+
+		log_debug2("%d %d %d is an AND\n", l1, l2, l3);
+		log_assert(!(l1 & 1));
+		RTLIL::Wire *o_wire = createWireIfNotExists(module, l1);
+		RTLIL::Wire *i1_wire = createWireIfNotExists(module, l2);
+		RTLIL::Wire *i2_wire = createWireIfNotExists(module, l3);
+		module->addAndGate(literalName("$and$aiger", l1 >> 1), i1_wire, i2_wire, o_wire);
+	}
+}
+
 void AigerReader::parse_aiger_binary()
 {
 	unsigned l1, l2, l3;
@@ -748,18 +796,55 @@ void AigerReader::parse_aiger_binary()
 		std::getline(f, line); // Ignore up to start of next line
 
 	// Parse AND
-	l1 = (I+L+1) << 1;
-	for (unsigned i = 0; i < A; ++i, ++line_count, l1 += 2) {
-		l2 = parse_next_delta_literal(f, l1);
-		l3 = parse_next_delta_literal(f, l2);
-
-		log_debug2("%d %d %d is an AND\n", l1, l2, l3);
-		log_assert(!(l1 & 1));
-		RTLIL::Wire *o_wire = createWireIfNotExists(module, l1);
-		RTLIL::Wire *i1_wire = createWireIfNotExists(module, l2);
-		RTLIL::Wire *i2_wire = createWireIfNotExists(module, l3);
-		module->addAndGate("$and" + o_wire->name.str(), i1_wire, i2_wire, o_wire);
+	// Each AND creates a wire for its output and a cell, plus a wire and a $_NOT_ cell for each variable that is
+	// used inverted; reserve space for all but the latter.
+	module->wires_.reserve(module->wires_.size() + A);
+	module->cells_.reserve(module->cells_.size() + A);
+	if (A == 0)
+		return;
+
+#ifndef _WIN32
+	// Decode the AND section straight from a memory mapping of plain files, instead of going through the stream
+	// one byte at a time.
+	std::streamoff offset = -1;
+	if (!filename.empty() && dynamic_cast<std::ifstream*>(&f) != nullptr)
+		offset = f.tellg();
+	if (offset >= 0) {
+		int fd = open(filename.c_str(), O_RDONLY);
+		struct stat info;
+		void *addr = MAP_FAILED;
+		if (fd >= 0 && fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > offset)
+			addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (fd >= 0)
+			close(fd);
+		if (addr != MAP_FAILED) {
+			// Unmap the file also when log_error() throws out of the parser.
+			struct MappingGuard {
+				void *addr;
+				size_t size;
+				~MappingGuard() { munmap(addr, size); }
+			} mapping_guard = {addr, size_t(info.st_size)};
+			madvise(addr, info.st_size, MADV_SEQUENTIAL);
+			const unsigned char *begin = static_cast<const unsigned char*>(addr);
+			const unsigned char *pos = begin + offset, *end = begin + info.st_size;
+			parse_aiger_binary_ands([&]() {
+				if (pos == end)
+					log_error("Unexpected end of file in AND section!\n");
+				return *pos++;
+			});
+			f.seekg(pos - begin);
+			return;
+		}
 	}
+#endif
+
+	std::streambuf *buf = f.rdbuf();
+	parse_aiger_binary_ands([&]() {
+		int ch = buf->sbumpc();
+		if (ch == EOF)
+			log_error("Unexpected end of file in AND section!\n");
+		return ch;
+	});
 }
 
 void AigerReader::post_process()
@@ -1056,6 +1141,7 @@ struct AigerFrontend : public Frontend {
 		}
 
 		AigerReader reader(design, *f, module_name, clk_name, map_filename, wideports);
+		reader.filename = filename;
 		if (xaiger)
 			reader.parse_xaiger();
 		else
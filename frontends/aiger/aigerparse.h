@@ -47,6 +47,12 @@ struct AigerReader
     std::vector<RTLIL::Cell*> boxes;
     std::vector<int> mergeability, initial_state;
 
+    // Name of the file that f reads, if any; plain files are mapped into memory to decode the AND section
+    std::string filename;
+    // Wires created for each literal by createWireIfNotExists(), indexed by literal
+    std::vector<RTLIL::Wire*> literal_wires;
+    std::string name_buffer;
+
     AigerReader(RTLIL::Design *design, std::istream &f, RTLIL::IdString module_name, RTLIL::IdString clk_name, std::string map_filename, bool wideports);
     void parse_aiger();
     void parse_xaiger();
@@ -55,6 +61,9 @@ struct AigerReader
     void post_process();
 
     RTLIL::Wire* createWireIfNotExists(RTLIL::Module *module, unsigned literal);
+    RTLIL::Wire* literalWire(unsigned literal);
+    RTLIL::IdString literalName(const char *prefix, unsigned variable, bool invert = false);
+    template<typename NextByte> void parse_aiger_binary_ands(NextByte next_byte);
 };
 
 YOSYS_NAMESPACE_END
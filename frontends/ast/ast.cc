@@ -41,6 +41,7 @@ namespace AST {
 	std::string current_filename;
 	void (*set_line_num)(int) = NULL;
 	int (*get_line_num)() = NULL;
+	DeriveCache derive_cache;
 }
 
 // instantiate global variables (private API)
@@ -1631,6 +1632,131 @@ void AstModule::expand_interfaces(RTLIL::Design *design, const dict<RTLIL::IdStr
 	new_module->set_bool_attribute(ID::interfaces_replaced_in_module);
 }
 
+void AST::DeriveCache::add(const std::string &key, RTLIL::Module *module)
+{
+	auto it = modules.find(key);
+	if (it != modules.end()) {
+		size -= it->second.size;
+		delete it->second.module;
+		lru.erase(it->second.lru_pos);
+		modules.erase(it);
+	}
+	int module_size = GetSize(module->wires_) + GetSize(module->cells_);
+	modules[key] = Entry{module, module_size, lru.insert(lru.end(), key)};
+	size += module_size;
+	trim();
+}
+
+RTLIL::Module *AST::DeriveCache::find(const std::string &key)
+{
+	auto it = modules.find(key);
+	if (it == modules.end())
+		return nullptr;
+	lru.splice(lru.end(), lru, it->second.lru_pos);
+	return it->second.module;
+}
+
+void AST::DeriveCache::trim()
+{
+	while (size > max_size && !lru.empty()) {
+		auto it = modules.find(lru.front());
+		size -= it->second.size;
+		delete it->second.module;
+		modules.erase(it);
+		lru.pop_front();
+	}
+}
+
+void AST::DeriveCache::clear()
+{
+	for (auto &it : modules)
+		delete it.second.module;
+	modules.clear();
+	lru.clear();
+	size = 0;
+}
+
+// append a description of an AST to a string, for the keys of the derive cache
+static void fingerprint_ast(std::string &out, const AstNode *node)
+{
+	if (node == nullptr) {
+		out += "-;";
+		return;
+	}
+
+	int flags = node->is_input | node->is_output << 1 | node->is_reg << 2 | node->is_logic << 3 | node->is_signed << 4 |
+			node->is_string << 5 | node->is_wand << 6 | node->is_wor << 7 | node->range_valid << 8 | node->range_swapped << 9 |
+			node->was_checked << 10 | node->is_unsized << 11 | node->is_custom_type << 12 | node->is_enum << 13;
+	out += stringf("%d %zu:", node->type, node->str.size());
+	out += node->str;
+	out += stringf(" %zu:", node->bits.size());
+	for (auto bit : node->bits)
+		out += char('0' + bit);
+	out += stringf(" %x %d %d %d %u %a %d", flags, node->port_id, node->range_left, node->range_right, node->integer,
+			node->realvalue, node->unpacked_dimensions);
+	for (auto &dim : node->dimensions)
+		out += stringf(" %d:%d:%d", dim.range_right, dim.range_width, dim.range_swapped);
+	out += stringf(" %zu:", node->filename.size());
+	out += node->filename;
+	out += stringf(" %u.%u-%u.%u %zu %zu\n", node->location.first_line, node->location.first_column,
+			node->location.last_line, node->location.last_column, node->attributes.size(), node->children.size());
+
+	for (auto &it : node->attributes) {
+		out += it.first.str() + "\n";
+		fingerprint_ast(out, it.second);
+	}
+	for (auto child : node->children)
+		fingerprint_ast(out, child);
+}
+
+// the key of a derived module in the derive cache, or an empty string if the cache is disabled
+static std::string derive_cache_key(const AstModule *module, const RTLIL::Design *design, const dict<RTLIL::IdString, RTLIL::Const> &parameters)
+{
+	if (!derive_cache.enabled)
+		return std::string();
+
+	std::string data = stringf("%s %d%d%d%d%d%d%d%d%d%d%d\n", module->name.c_str(), module->nolatches, module->nomeminit,
+			module->nomem2reg, module->mem2reg, module->noblackbox, module->lib, module->nowb, module->noopt, module->icells,
+			module->pwires, module->autowire);
+
+	std::map<std::string, RTLIL::Const> sorted_parameters;
+	for (auto &it : parameters)
+		sorted_parameters[it.first.str()] = it.second;
+	for (auto &it : sorted_parameters)
+		data += stringf("%s=%d:%s\n", it.first.c_str(), it.second.flags, it.second.as_string().c_str());
+
+	fingerprint_ast(data, module->ast);
+	for (auto node : design->verilog_packages)
+		fingerprint_ast(data, node);
+	for (auto node : design->verilog_globals)
+		fingerprint_ast(data, node);
+	return sha1(data);
+}
+
+// add a module from the derive cache to the design, returns false if there is none
+static bool derive_from_cache(RTLIL::Design *design, const std::string &key, const std::string &modname, bool quiet)
+{
+	RTLIL::Module *cached = key.empty() ? nullptr : derive_cache.find(key);
+	if (cached == nullptr)
+		return false;
+
+	RTLIL::Module *mod = cached->clone();
+	mod->name = modname;
+	design->add(mod);
+	derive_cache.hits++;
+	if (!quiet)
+		log("Found RTLIL representation for module `%s' in the derive cache.\n", modname.c_str());
+	return true;
+}
+
+// add a newly derived module to the derive cache, unless the derivation depended on more than the key
+static void add_to_derive_cache(const std::string &key, const RTLIL::Module *mod, int lookups_before, int warnings_before)
+{
+	if (key.empty() || simplify_design_lookups != lookups_before || log_warnings_count != warnings_before)
+		return;
+	derive_cache.add(key, mod->clone());
+}
+
 // create a new parametric module (when needed) and return the name of the generated module - WITH support for interfaces
 // This method is used to explode the interface when the interface is a port of the module (not instantiated inside)
 RTLIL::IdString AstModule::derive(RTLIL::Design *design, const dict<RTLIL::IdString, RTLIL::Const> &parameters, const dict<RTLIL::IdString, RTLIL::Module*> &interfaces, const dict<RTLIL::IdString, RTLIL::IdString> &modports, bool /*mayfail*/)
@@ -1662,6 +1788,14 @@ RTLIL::IdString AstModule::derive(RTLIL::Design *design, const dict<RTLIL::IdStr
 		modname = new_modname;
 		new_ast->str = modname;
 
+		// Modules with interfaces depend on more than their parameters, so only the others are cached
+		std::string cache_key = has_interfaces ? std::string() : derive_cache_key(this, design, parameters);
+		if (derive_from_cache(design, cache_key, modname, false)) {
+			delete new_ast;
+			return modname;
+		}
+		int lookups_before = simplify_design_lookups, warnings_before = log_warnings_count;
+
 		// Iterate over all interfaces which are ports in this module:
 		for(auto &intf : interfaces) {
 			RTLIL::Module * intfmodule = intf.second;
@@ -1710,6 +1844,8 @@ RTLIL::IdString AstModule::derive(RTLIL::Design *design, const dict<RTLIL::IdStr
 			mod->set_bool_attribute(ID::interfaces_replaced_in_module);
 		}
 
+		add_to_derive_cache(cache_key, mod, lookups_before, warnings_before);
+
 	} else {
 		modname = new_modname;
 		log("Found cached RTLIL representation for module `%s'.\n", modname.c_str());
@@ -1728,9 +1864,14 @@ RTLIL::IdString AstModule::derive(RTLIL::Design *design, const dict<RTLIL::IdStr
 	std::string modname = derive_common(design, parameters, &new_ast, quiet);
 
 	if (!design->has(modname) && new_ast) {
-		new_ast->str = modname;
-		process_module(design, new_ast, false, NULL, quiet);
-		design->module(modname)->check();
+		std::string cache_key = derive_cache_key(this, design, parameters);
+		if (!derive_from_cache(design, cache_key, modname, quiet)) {
+			int lookups_before = simplify_design_lookups, warnings_before = log_warnings_count;
+			new_ast->str = modname;
+			process_module(design, new_ast, false, NULL, quiet);
+			design->module(modname)->check();
+			add_to_derive_cache(cache_key, design->module(modname), lookups_before, warnings_before);
+		}
 	} else if (!quiet) {
 		log("Found cached RTLIL representation for module `%s'.\n", modname.c_str());
 	}
@@ -1894,6 +2035,154 @@ RTLIL::Module *AstModule::clone() const
 	return new_mod;
 }
 
+// write an AST node for AstModule::dump_ast(), numbers as decimal text and strings with their length
+static void dump_ast_node(std::string &out, const AstNode *node)
+{
+	if (node == nullptr) {
+		out += " 0";
+		return;
+	}
+
+	int flags = node->is_input | node->is_output << 1 | node->is_reg << 2 | node->is_logic << 3 | node->is_signed << 4 |
+			node->is_string << 5 | node->is_wand << 6 | node->is_wor << 7 | node->range_valid << 8 | node->range_swapped << 9 |
+			node->was_checked << 10 | node->is_unsized << 11 | node->is_custom_type << 12 | node->is_enum << 13;
+	out += stringf(" 1 %d %zu:", node->type, node->str.size());
+	out += node->str;
+	out += stringf(" %zu:", node->bits.size());
+	for (auto bit : node->bits)
+		out += char('0' + bit);
+	out += stringf(" %d %d %d %d %u %a %d %zu", flags, node->port_id, node->range_left, node->range_right, node->integer,
+			node->realvalue, node->unpacked_dimensions, node->dimensions.size());
+	for (auto &dim : node->dimensions)
+		out += stringf(" %d %d %d", dim.range_right, dim.range_width, dim.range_swapped);
+	out += stringf(" %zu:", node->filename.size());
+	out += node->filename;
+	out += stringf(" %u %u %u %u %zu", node->location.first_line, node->location.first_column,
+			node->location.last_line, node->location.last_column, node->attributes.size());
+	for (auto &it : node->attributes) {
+		out += stringf(" %zu:", it.first.size());
+		out += it.first.str();
+		dump_ast_node(out, it.second);
+	}
+	out += stringf(" %zu", node->children.size());
+	for (auto child : node->children)
+		dump_ast_node(out, child);
+}
+
+// read back what dump_ast_node() wrote, ok is cleared if the data is damaged
+struct AstNodeReader
+{
+	const std::string &data;
+	size_t pos = 0;
+	bool ok = true;
+
+	AstNodeReader(const std::string &data) : data(data) { }
+
+	long long number()
+	{
+		if (pos >= data.size() || data[pos] != ' ') {
+			ok = false;
+			return 0;
+		}
+		char *end;
+		long long value = strtoll(data.c_str() + pos + 1, &end, 10);
+		if (end == data.c_str() + pos + 1)
+			ok = false;
+		pos = end - data.c_str();
+		return value;
+	}
+
+	double real()
+	{
+		if (pos >= data.size() || data[pos] != ' ') {
+			ok = false;
+			return 0;
+		}
+		char *end;
+		double value = strtod(data.c_str() + pos + 1, &end);
+		if (end == data.c_str() + pos + 1)
+			ok = false;
+		pos = end - data.c_str();
+		return value;
+	}
+
+	std::string string()
+	{
+		long long size = number();
+		if (!ok || size < 0 || pos >= data.size() || data[pos] != ':' || size_t(size) > data.size() - pos - 1) {
+			ok = false;
+			return std::string();
+		}
+		std::string str = data.substr(pos + 1, size);
+		pos += size + 1;
+		return str;
+	}
+
+	AstNode *node()
+	{
+		if (number() == 0 || !ok)
+			return nullptr;
+
+		AstNode *node = new AstNode(AstNodeType(number()));
+		node->str = string();
+		for (auto ch : string())
+			node->bits.push_back(RTLIL::State(ch - '0'));
+		int flags = number();
+		node->is_input = flags & 1, node->is_output = flags & 2, node->is_reg = flags & 4, node->is_logic = flags & 8;
+		node->is_signed = flags & 16, node->is_string = flags & 32, node->is_wand = flags & 64, node->is_wor = flags & 128;
+		node->range_valid = flags & 256, node->range_swapped = flags & 512, node->was_checked = flags & 1024;
+		node->is_unsized = flags & 2048, node->is_custom_type = flags & 4096, node->is_enum = flags & 8192;
+		node->port_id = number();
+		node->range_left = number();
+		node->range_right = number();
+		node->integer = number();
+		node->realvalue = real();
+		node->unpacked_dimensions = number();
+		for (long long i = 0, n = number(); ok && i < n; i++) {
+			AstNode::dimension_t dim;
+			dim.range_right = number();
+			dim.range_width = number();
+			dim.range_swapped = number();
+			node->dimensions.push_back(dim);
+		}
+		node->filename = string();
+		node->location.first_line = number();
+		node->location.first_column = number();
+		node->location.last_line = number();
+		node->location.last_column = number();
+		for (long long i = 0, n = number(); ok && i < n; i++) {
+			RTLIL::IdString name = string();
+			node->attributes[name] = this->node();
+		}
+		for (long long i = 0, n = number(); ok && i < n; i++)
+			node->children.push_back(this->node());
+		return node;
+	}
+};
+
+std::string AstModule::dump_ast() const
+{
+	std::string data = stringf(" %d %d %d %d %d %d %d %d %d %d %d", nolatches, nomeminit, nomem2reg, mem2reg, noblackbox, lib,
+			nowb, noopt, icells, pwires, autowire);
+	dump_ast_node(data, ast);
+	return data;
+}
+
+bool AstModule::load_ast(const std::string &data)
+{
+	AstNodeReader reader(data);
+	for (bool *flag : {&nolatches, &nomeminit, &nomem2reg, &mem2reg, &noblackbox, &lib, &nowb, &noopt, &icells, &pwires, &autowire})
+		*flag = reader.number() != 0;
+	AstNode *node = reader.node();
+	if (!reader.ok || node == nullptr || reader.pos != data.size()) {
+		delete node;
+		return false;
+	}
+	node->fixup_hierarchy_flags(true);
+	ast = node;
+	return true;
+}
+
 void AstModule::loadconfig() const
 {
 	current_ast = NULL;
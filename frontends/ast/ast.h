@@ -30,6 +30,7 @@
 #include "kernel/fmt.h"
 #include <stdint.h>
 #include <set>
+#include <list>
 
 YOSYS_NAMESPACE_BEGIN
 
@@ -401,6 +402,11 @@ namespace AST
 		bool reprocess_if_necessary(RTLIL::Design *design) override;
 		RTLIL::Module *clone() const override;
 		void loadconfig() const;
+		// write the AST and the options of the module to a string and read them back, so that modules that still
+		// need their AST can be passed between processes (read_verilog -j) and cached (read_verilog -cache).
+		// load_ast() is used on a new module, which doesn't have an AST yet.
+		std::string dump_ast() const;
+		bool load_ast(const std::string &data);
 	};
 
 	// this must be set by the language frontend before parsing the sources
@@ -432,6 +438,35 @@ namespace AST
 	// used to provide simplify() access to the current design for looking up
 	// modules, ports, wires, etc.
 	void set_simplify_design_context(const RTLIL::Design *design);
+
+	// number of modules simplify() looked up in the design context so far
+	extern int simplify_design_lookups;
+
+	// cache of derived modules, enabled by the hierarchy pass. A derived module
+	// is found again by the AST and the options of the module it was derived
+	// from and the parameters, even after it was removed from the design (e.g.
+	// by 'design -reset' before reading the same sources again). Derivations
+	// that looked up other modules in the design or that caused warnings are
+	// not cached. The cache holds at most max_size wires and cells, the least
+	// recently used modules are dropped first.
+	struct DeriveCache {
+		struct Entry {
+			RTLIL::Module *module;
+			int size;
+			std::list<std::string>::iterator lru_pos;
+		};
+		bool enabled = false;
+		int hits = 0;
+		int size = 0, max_size = 1000000;
+		dict<std::string, Entry> modules;
+		// the keys of the cached modules, least recently used first
+		std::list<std::string> lru;
+		void add(const std::string &key, RTLIL::Module *module);
+		RTLIL::Module *find(const std::string &key);
+		void trim();
+		void clear();
+	};
+	extern DeriveCache derive_cache;
 }
 
 namespace AST_INTERNAL
@@ -602,6 +602,7 @@ static std::string prefix_id(const std::string &prefix, const std::string &str)
 
 // direct access to this global should be limited to the following two functions
 static const RTLIL::Design *simplify_design_context = nullptr;
+int AST::simplify_design_lookups = 0;
 
 void AST::set_simplify_design_context(const RTLIL::Design *design)
 {
@@ -612,6 +613,7 @@ void AST::set_simplify_design_context(const RTLIL::Design *design)
 // lookup the module with the given name in the current design context
 static const RTLIL::Module* lookup_module(const std::string &name)
 {
+	simplify_design_lookups++;
 	return simplify_design_context->module(name);
 }
 
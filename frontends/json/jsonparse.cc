@@ -21,233 +21,299 @@
 
 YOSYS_NAMESPACE_BEGIN
 
-struct JsonNode
+// The JSON file is read as a stream of tokens from a buffer that is refilled from the input stream, without
+// building a tree for the whole file. Each module is read into the compact representation below and imported as
+// soon as it is complete, because the bits of cell connections can only be resolved after the ports and netnames
+// of the module have been seen, and write_json puts the netnames last.
+
+struct JsonReader
 {
-	char type; // S=String, N=Number, A=Array, D=Dict
-	string data_string;
-	int64_t data_number;
-	vector<JsonNode*> data_array;
-	dict<string, JsonNode*> data_dict;
-	vector<string> data_dict_keys;
-
-	JsonNode(std::istream &f)
+	std::istream &f;
+	std::vector<char> buffer;
+	const char *pos = nullptr, *end = nullptr;
+
+	JsonReader(std::istream &f) : f(f), buffer(1 << 20) { }
+
+	bool refill()
+	{
+		f.read(buffer.data(), buffer.size());
+		pos = buffer.data();
+		end = pos + f.gcount();
+		return pos != end;
+	}
+
+	int peek()
+	{
+		if (pos == end && !refill())
+			return EOF;
+		return (unsigned char)*pos;
+	}
+
+	int get()
 	{
-		type = 0;
-		data_number = 0;
+		if (pos == end && !refill())
+			return EOF;
+		return (unsigned char)*pos++;
+	}
 
+	static bool is_space(int ch)
+	{
+		return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+	}
+
+	// Returns the type of the next value, using the same letters as the old tree representation: S=String,
+	// N=Number, A=Array, D=Dict.
+	char next_type()
+	{
 		while (1)
 		{
-			int ch = f.get();
+			int ch = peek();
 
 			if (ch == EOF)
 				log_error("Unexpected EOF in JSON file.\n");
 
-			if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n')
+			if (is_space(ch)) {
+				pos++;
 				continue;
-
-			if (ch == '"')
-			{
-				type = 'S';
-
-				while (1)
-				{
-					ch = f.get();
-
-					if (ch == EOF)
-						log_error("Unexpected EOF in JSON string.\n");
-
-					if (ch == '"')
-						break;
-
-					if (ch == '\\') {
-						ch = f.get();
-
-						switch (ch) {
-							case EOF: log_error("Unexpected EOF in JSON string.\n"); break;
-							case '"':
-							case '/':
-							case '\\':           break;
-							case 'b': ch = '\b'; break;
-							case 'f': ch = '\f'; break;
-							case 'n': ch = '\n'; break;
-							case 'r': ch = '\r'; break;
-							case 't': ch = '\t'; break;
-							case 'u':
-								int val = 0;
-								for (int i = 0; i < 4; i++) {
-									ch = f.get();
-									val <<= 4;
-									if (ch >= '0' && '9' >= ch) {
-										val += ch - '0';
-									} else if (ch >= 'A' && 'F' >= ch) {
-										val += 10 + ch - 'A';
-									} else if (ch >= 'a' && 'f' >= ch) {
-										val += 10 + ch - 'a';
-									} else
-										log_error("Unexpected non-digit character in \\uXXXX sequence: %c.\n", ch);
-								}
-								if (val < 128)
-									ch = val;
-								else
-									log_error("Unsupported \\uXXXX sequence in JSON string: %04X.\n", val);
-								break;
-						}
-					}
-
-					data_string += ch;
-				}
-
-				break;
 			}
 
+			if (ch == '"')
+				return 'S';
 			if (('0' <= ch && ch <= '9') || ch == '-')
-			{
-				bool negative = false;
-				type = 'N';
-				if (ch == '-') {
-					data_number = 0;
-				       	negative = true;
-				} else {
-					data_number = ch - '0';
-				}
-
-				data_string += ch;
-
-				while (1)
-				{
-					ch = f.get();
-
-					if (ch == EOF)
-						break;
+				return 'N';
+			if (ch == '[')
+				return 'A';
+			if (ch == '{')
+				return 'D';
 
-					if (ch == '.')
-						goto parse_real;
+			log_error("Unexpected character in JSON file: '%c'\n", ch);
+		}
+	}
 
-					if (ch < '0' || '9' < ch) {
-						f.unget();
-						break;
-					}
+	void read_string(string &str)
+	{
+		str.clear();
+		pos++;
 
-					data_number = data_number*10 + (ch - '0');
-					data_string += ch;
-				}
+		while (1)
+		{
+			const char *start = pos;
+			while (pos != end && *pos != '"' && *pos != '\\')
+				pos++;
+			str.append(start, pos);
+
+			if (pos == end) {
+				if (!refill())
+					log_error("Unexpected EOF in JSON string.\n");
+				continue;
+			}
 
-				data_number = negative ? -data_number : data_number;
-				data_string = "";
+			if (*pos++ == '"')
 				break;
 
-			parse_real:
-				type = 'S';
-				data_number = 0;
-				data_string += ch;
-
-				while (1)
-				{
-					ch = f.get();
+			int ch = get();
+
+			switch (ch) {
+				case EOF: log_error("Unexpected EOF in JSON string.\n"); break;
+				case '"':
+				case '/':
+				case '\\':           break;
+				case 'b': ch = '\b'; break;
+				case 'f': ch = '\f'; break;
+				case 'n': ch = '\n'; break;
+				case 'r': ch = '\r'; break;
+				case 't': ch = '\t'; break;
+				case 'u':
+					int val = 0;
+					for (int i = 0; i < 4; i++) {
+						ch = get();
+						val <<= 4;
+						if (ch >= '0' && '9' >= ch) {
+							val += ch - '0';
+						} else if (ch >= 'A' && 'F' >= ch) {
+							val += 10 + ch - 'A';
+						} else if (ch >= 'a' && 'f' >= ch) {
+							val += 10 + ch - 'a';
+						} else
+							log_error("Unexpected non-digit character in \\uXXXX sequence: %c.\n", ch);
+					}
+					if (val < 128)
+						ch = val;
+					else
+						log_error("Unsupported \\uXXXX sequence in JSON string: %04X.\n", val);
+					break;
+			}
 
-					if (ch == EOF)
-						break;
+			str += ch;
+		}
+	}
 
-					if (ch < '0' || '9' < ch) {
-						f.unget();
-						break;
-					}
+	// Reads a number. Numbers with a fractional part are returned as a string, and the return value is 'S' for
+	// those and 'N' otherwise.
+	char read_number(int64_t &number, string &str)
+	{
+		str.clear();
+		number = 0;
 
-					data_string += ch;
-				}
+		int ch = get();
+		bool negative = ch == '-';
+		if (!negative)
+			number = ch - '0';
+		str += ch;
 
-				break;
+		while (1)
+		{
+			ch = peek();
+
+			if (ch == '.') {
+				pos++;
+				str += ch;
+				while ('0' <= peek() && peek() <= '9')
+					str += *pos++;
+				number = 0;
+				return 'S';
 			}
 
-			if (ch == '[')
-			{
-				type = 'A';
-
-				while (1)
-				{
-					ch = f.get();
+			if (ch < '0' || '9' < ch)
+				break;
 
-					if (ch == EOF)
-						log_error("Unexpected EOF in JSON file.\n");
+			pos++;
+			number = number*10 + (ch - '0');
+			str += ch;
+		}
 
-					if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ',')
-						continue;
+		number = negative ? -number : number;
+		str.clear();
+		return 'N';
+	}
 
-					if (ch == ']')
-						break;
+	// Advances to the next element of an array, returning false at the closing bracket.
+	bool next_element()
+	{
+		while (1)
+		{
+			int ch = peek();
 
-					f.unget();
-					data_array.push_back(new JsonNode(f));
-				}
+			if (ch == EOF)
+				log_error("Unexpected EOF in JSON file.\n");
 
-				break;
+			if (is_space(ch) || ch == ',') {
+				pos++;
+				continue;
 			}
 
-			if (ch == '{')
-			{
-				type = 'D';
+			if (ch == ']') {
+				pos++;
+				return false;
+			}
 
-				while (1)
-				{
-					ch = f.get();
+			return true;
+		}
+	}
 
-					if (ch == EOF)
-						log_error("Unexpected EOF in JSON file.\n");
+	// Advances to the next member of a dict and reads its key, returning false at the closing brace.
+	bool next_member(string &key)
+	{
+		while (1)
+		{
+			int ch = peek();
 
-					if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ',')
-						continue;
+			if (ch == EOF)
+				log_error("Unexpected EOF in JSON file.\n");
 
-					if (ch == '}')
-						break;
+			if (is_space(ch) || ch == ',') {
+				pos++;
+				continue;
+			}
 
-					f.unget();
-					JsonNode key(f);
+			if (ch == '}') {
+				pos++;
+				return false;
+			}
 
-					while (1)
-					{
-						ch = f.get();
+			break;
+		}
 
-						if (ch == EOF)
-							log_error("Unexpected EOF in JSON file.\n");
+		if (next_type() != 'S')
+			log_error("Unexpected non-string key in JSON dict.\n");
+		read_string(key);
 
-						if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ':')
-							continue;
+		while (1)
+		{
+			int ch = peek();
 
-						f.unget();
-						break;
-					}
+			if (ch == EOF)
+				log_error("Unexpected EOF in JSON file.\n");
 
-					JsonNode *value = new JsonNode(f);
+			if (is_space(ch) || ch == ':') {
+				pos++;
+				continue;
+			}
 
-					if (key.type != 'S')
-						log_error("Unexpected non-string key in JSON dict.\n");
+			return true;
+		}
+	}
 
-					data_dict[key.data_string] = value;
-					data_dict_keys.push_back(key.data_string);
-				}
+	void begin(char type)
+	{
+		char next = next_type();
+		log_assert(next == type);
+		pos++;
+	}
 
-				break;
-			}
+	void skip_value()
+	{
+		string str, key;
+		int64_t number;
 
-			log_error("Unexpected character in JSON file: '%c'\n", ch);
+		switch (next_type())
+		{
+		case 'S':
+			read_string(str);
+			break;
+		case 'N':
+			read_number(number, str);
+			break;
+		case 'A':
+			begin('A');
+			while (next_element())
+				skip_value();
+			break;
+		case 'D':
+			begin('D');
+			while (next_member(key))
+				skip_value();
+			break;
 		}
 	}
 
-	~JsonNode()
+	// Reads a number, returning false (and skipping the value) if the value is not an integer.
+	bool read_int(int64_t &number)
 	{
-		for (auto it : data_array)
-			delete it;
-		for (auto &it : data_dict)
-			delete it.second;
+		string str;
+		if (next_type() == 'N' && read_number(number, str) == 'N')
+			return true;
+		if (!str.empty())
+			return false;
+		skip_value();
+		return false;
 	}
 };
 
-Const json_parse_attr_param_value(JsonNode *node)
+Const json_parse_attr_param_value(JsonReader &reader)
 {
 	Const value;
+	string s;
+	int64_t number;
+
+	char type = reader.next_type();
 
-	if (node->type == 'S') {
-		string &s = node->data_string;
+	if (type == 'N')
+		type = reader.read_number(number, s);
+	else if (type == 'S')
+		reader.read_string(s);
+
+	if (type == 'S') {
 		size_t cursor = s.find_first_not_of("01xz");
 		if (cursor == string::npos) {
 			value = Const::from_string(s);
@@ -257,15 +323,15 @@ Const json_parse_attr_param_value(JsonNode *node)
 			value = Const(s);
 		}
 	} else
-	if (node->type == 'N') {
-		value = Const(node->data_number, 32);
-		if (node->data_number < 0)
+	if (type == 'N') {
+		value = Const(number, 32);
+		if (number < 0)
 			value.flags |= RTLIL::CONST_FLAG_SIGNED;
 	} else
-	if (node->type == 'A') {
+	if (type == 'A') {
 		log_error("JSON attribute or parameter value is an array.\n");
 	} else
-	if (node->type == 'D') {
+	if (type == 'D') {
 		log_error("JSON attribute or parameter value is a dict.\n");
 	} else {
 		log_abort();
@@ -274,20 +340,308 @@ Const json_parse_attr_param_value(JsonNode *node)
 	return value;
 }
 
-void json_parse_attr_param(dict<IdString, Const> &results, JsonNode *node)
+// Attributes and parameters are collected in a dict first, so that duplicate keys and the resulting order behave
+// the same as they did when the reader built a tree of the file.
+typedef dict<string, Const> JsonAttrParams;
+
+void json_read_attr_param(JsonAttrParams &results, JsonReader &reader)
 {
-	if (node->type != 'D')
+	if (reader.next_type() != 'D')
 		log_error("JSON attributes or parameters node is not a dictionary.\n");
 
-	for (auto it : node->data_dict)
+	string key;
+	reader.begin('D');
+	while (reader.next_member(key))
+		results[key] = json_parse_attr_param_value(reader);
+}
+
+void json_parse_attr_param(dict<IdString, Const> &results, const JsonAttrParams &attr_params)
+{
+	for (auto &it : attr_params)
+		results[RTLIL::escape_id(it.first.c_str())] = it.second;
+}
+
+// A bit is either the number of a signal or one of the constants below.
+typedef int64_t JsonBit;
+static const JsonBit json_const_bits = JsonBit(1) << 32;
+
+template<typename F>
+void json_read_bits(std::vector<JsonBit> &bits, JsonReader &reader, F node_name)
+{
+	string str;
+	int64_t number;
+
+	bits.clear();
+	reader.begin('A');
+	while (reader.next_element())
 	{
-		IdString key = RTLIL::escape_id(it.first.c_str());
-		Const value = json_parse_attr_param_value(it.second);
-		results[key] = value;
+		int i = GetSize(bits);
+		char type = reader.next_type();
+
+		if (type == 'S') {
+			reader.read_string(str);
+			if (str == "0")
+				bits.push_back(json_const_bits + State::S0);
+			else if (str == "1")
+				bits.push_back(json_const_bits + State::S1);
+			else if (str == "x")
+				bits.push_back(json_const_bits + State::Sx);
+			else if (str == "z")
+				bits.push_back(json_const_bits + State::Sz);
+			else
+				log_error("%s has invalid '%s' bit string value on bit %d.\n", node_name().c_str(), str.c_str(), i);
+		} else
+		if (type == 'N') {
+			if (reader.read_number(number, str) != 'N')
+				log_error("%s has invalid '%s' bit string value on bit %d.\n", node_name().c_str(), str.c_str(), i);
+			bits.push_back(int(number));
+		} else
+			log_error("%s has invalid bit value on bit %d.\n", node_name().c_str(), i);
 	}
 }
 
-void json_import(Design *design, string &modname, JsonNode *node)
+struct JsonWire
+{
+	char direction_type = 0, bits_type = 0;
+	string direction;
+	std::vector<JsonBit> bits;
+	bool has_upto = false, has_signed = false, has_offset = false;
+	int64_t upto = 0, is_signed = 0, offset = 0;
+	bool has_attributes = false;
+	JsonAttrParams attributes;
+	bool is_dict = true;
+
+	void read(JsonReader &reader, const char *kind, const string &name)
+	{
+		auto node_name = [&]() { return stringf("JSON %s node '%s'", kind, log_id(RTLIL::escape_id(name.c_str()))); };
+
+		if (reader.next_type() != 'D') {
+			is_dict = false;
+			reader.skip_value();
+			return;
+		}
+
+		string key;
+		reader.begin('D');
+		while (reader.next_member(key))
+		{
+			if (key == "direction") {
+				direction_type = reader.next_type();
+				if (direction_type == 'S')
+					reader.read_string(direction);
+				else
+					reader.skip_value();
+			} else
+			if (key == "bits") {
+				bits_type = reader.next_type();
+				if (bits_type == 'A')
+					json_read_bits(bits, reader, node_name);
+				else
+					reader.skip_value();
+			} else
+			if (key == "upto") {
+				has_upto = reader.read_int(upto);
+			} else
+			if (key == "signed") {
+				has_signed = reader.read_int(is_signed);
+			} else
+			if (key == "offset") {
+				has_offset = reader.read_int(offset);
+			} else
+			if (key == "attributes") {
+				has_attributes = true;
+				attributes.clear();
+				json_read_attr_param(attributes, reader);
+			} else
+				reader.skip_value();
+		}
+	}
+};
+
+struct JsonCell
+{
+	bool is_dict = true;
+	char type_type = 0, connections_type = 0;
+	string type;
+	dict<string, std::vector<JsonBit>> connections;
+	bool has_attributes = false, has_parameters = false;
+	JsonAttrParams attributes, parameters;
+
+	void read(JsonReader &reader, const string &name)
+	{
+		if (reader.next_type() != 'D') {
+			is_dict = false;
+			reader.skip_value();
+			return;
+		}
+
+		string key, conn_name;
+		reader.begin('D');
+		while (reader.next_member(key))
+		{
+			if (key == "type") {
+				type_type = reader.next_type();
+				if (type_type == 'S')
+					reader.read_string(type);
+				else
+					reader.skip_value();
+			} else
+			if (key == "connections") {
+				connections_type = reader.next_type();
+				connections.clear();
+				if (connections_type != 'D') {
+					reader.skip_value();
+					continue;
+				}
+				reader.begin('D');
+				while (reader.next_member(conn_name)) {
+					if (reader.next_type() != 'A')
+						log_error("JSON cells node '%s' connection '%s' is not an array.\n",
+								log_id(RTLIL::escape_id(name.c_str())), log_id(RTLIL::escape_id(conn_name.c_str())));
+					json_read_bits(connections[conn_name], reader, [&]() {
+						return stringf("JSON cells node '%s' connection '%s'",
+								log_id(RTLIL::escape_id(name.c_str())), log_id(RTLIL::escape_id(conn_name.c_str())));
+					});
+				}
+			} else
+			if (key == "attributes") {
+				has_attributes = true;
+				attributes.clear();
+				json_read_attr_param(attributes, reader);
+			} else
+			if (key == "parameters") {
+				has_parameters = true;
+				parameters.clear();
+				json_read_attr_param(parameters, reader);
+			} else
+				reader.skip_value();
+		}
+	}
+};
+
+struct JsonMemory
+{
+	bool is_dict = true;
+	char width_type = 0, size_type = 0;
+	int64_t width = 0, size = 0, start_offset = 0;
+	bool has_attributes = false;
+	JsonAttrParams attributes;
+
+	void read(JsonReader &reader)
+	{
+		if (reader.next_type() != 'D') {
+			is_dict = false;
+			reader.skip_value();
+			return;
+		}
+
+		string key, str;
+		reader.begin('D');
+		while (reader.next_member(key))
+		{
+			if (key == "width" || key == "size") {
+				char type = reader.next_type();
+				if (type == 'N')
+					type = reader.read_number(key == "width" ? width : size, str);
+				else
+					reader.skip_value();
+				(key == "width" ? width_type : size_type) = type;
+			} else
+			if (key == "start_offset") {
+				int64_t value;
+				start_offset = reader.read_int(value) ? value : 0;
+			} else
+			if (key == "attributes") {
+				has_attributes = true;
+				attributes.clear();
+				json_read_attr_param(attributes, reader);
+			} else
+				reader.skip_value();
+		}
+	}
+};
+
+struct JsonModule
+{
+	bool has_attributes = false, has_ports = false, has_netnames = false, has_cells = false, has_memories = false;
+	JsonAttrParams attributes;
+	vector<string> port_keys;
+	dict<string, JsonWire> ports, netnames;
+	dict<string, JsonCell> cells;
+	dict<string, JsonMemory> memories;
+
+	void read(JsonReader &reader)
+	{
+		if (reader.next_type() != 'D') {
+			reader.skip_value();
+			return;
+		}
+
+		string key, name;
+		reader.begin('D');
+		while (reader.next_member(key))
+		{
+			if (key == "attributes") {
+				has_attributes = true;
+				attributes.clear();
+				json_read_attr_param(attributes, reader);
+			} else
+			if (key == "ports") {
+				has_ports = true;
+				if (reader.next_type() != 'D')
+					log_error("JSON ports node is not a dictionary.\n");
+				port_keys.clear();
+				ports.clear();
+				reader.begin('D');
+				while (reader.next_member(name)) {
+					port_keys.push_back(name);
+					JsonWire &port = ports[name];
+					port = JsonWire();
+					port.read(reader, "port", name);
+				}
+			} else
+			if (key == "netnames") {
+				has_netnames = true;
+				if (reader.next_type() != 'D')
+					log_error("JSON netnames node is not a dictionary.\n");
+				netnames.clear();
+				reader.begin('D');
+				while (reader.next_member(name)) {
+					JsonWire &net = netnames[name];
+					net = JsonWire();
+					net.read(reader, "netname", name);
+				}
+			} else
+			if (key == "cells") {
+				has_cells = true;
+				if (reader.next_type() != 'D')
+					log_error("JSON cells node is not a dictionary.\n");
+				cells.clear();
+				reader.begin('D');
+				while (reader.next_member(name)) {
+					JsonCell &cell = cells[name];
+					cell = JsonCell();
+					cell.read(reader, name);
+				}
+			} else
+			if (key == "memories") {
+				has_memories = true;
+				if (reader.next_type() != 'D')
+					log_error("JSON memories node is not a dictionary.\n");
+				memories.clear();
+				reader.begin('D');
+				while (reader.next_member(name)) {
+					JsonMemory &mem = memories[name];
+					mem = JsonMemory();
+					mem.read(reader);
+				}
+			} else
+				reader.skip_value();
+		}
+	}
+};
+
+Module *json_import(Design *design, string &modname, JsonModule &node)
 {
 	log("Importing module %s from JSON tree.\n", modname.c_str());
 
@@ -299,98 +653,70 @@ void json_import(Design *design, string &modname, JsonNode *node)
 
 	design->add(module);
 
-	if (node->data_dict.count("attributes"))
-		json_parse_attr_param(module->attributes, node->data_dict.at("attributes"));
+	if (node.has_attributes)
+		json_parse_attr_param(module->attributes, node.attributes);
 
 	dict<int, SigBit> signal_bits;
 
-	if (node->data_dict.count("ports"))
+	if (node.has_ports)
 	{
-		JsonNode *ports_node = node->data_dict.at("ports");
-
-		if (ports_node->type != 'D')
-			log_error("JSON ports node is not a dictionary.\n");
-
-		for (int port_id = 1; port_id <= GetSize(ports_node->data_dict_keys); port_id++)
+		for (int port_id = 1; port_id <= GetSize(node.port_keys); port_id++)
 		{
-			IdString port_name = RTLIL::escape_id(ports_node->data_dict_keys[port_id-1].c_str());
-			JsonNode *port_node = ports_node->data_dict.at(ports_node->data_dict_keys[port_id-1]);
+			IdString port_name = RTLIL::escape_id(node.port_keys[port_id-1].c_str());
+			JsonWire &port_node = node.ports.at(node.port_keys[port_id-1]);
 
-			if (port_node->type != 'D')
+			if (!port_node.is_dict)
 				log_error("JSON port node '%s' is not a dictionary.\n", log_id(port_name));
 
-			if (port_node->data_dict.count("direction") == 0)
+			if (port_node.direction_type == 0)
 				log_error("JSON port node '%s' has no direction attribute.\n", log_id(port_name));
 
-			if (port_node->data_dict.count("bits") == 0)
+			if (port_node.bits_type == 0)
 				log_error("JSON port node '%s' has no bits attribute.\n", log_id(port_name));
 
-			JsonNode *port_direction_node = port_node->data_dict.at("direction");
-			JsonNode *port_bits_node = port_node->data_dict.at("bits");
-
-			if (port_direction_node->type != 'S')
+			if (port_node.direction_type != 'S')
 				log_error("JSON port node '%s' has non-string direction attribute.\n", log_id(port_name));
 
-			if (port_bits_node->type != 'A')
+			if (port_node.bits_type != 'A')
 				log_error("JSON port node '%s' has non-array bits attribute.\n", log_id(port_name));
 
 			Wire *port_wire = module->wire(port_name);
 
 			if (port_wire == nullptr)
-				port_wire = module->addWire(port_name, GetSize(port_bits_node->data_array));
+				port_wire = module->addWire(port_name, GetSize(port_node.bits));
 
-			if (port_node->data_dict.count("upto") != 0) {
-				JsonNode *val = port_node->data_dict.at("upto");
-				if (val->type == 'N')
-					port_wire->upto = val->data_number != 0;
-			}
+			if (port_node.has_upto)
+				port_wire->upto = port_node.upto != 0;
 
-			if (port_node->data_dict.count("signed") != 0) {
-				JsonNode *val = port_node->data_dict.at("signed");
-				if (val->type == 'N')
-					port_wire->is_signed = val->data_number != 0;
-			}
+			if (port_node.has_signed)
+				port_wire->is_signed = port_node.is_signed != 0;
 
-			if (port_node->data_dict.count("offset") != 0) {
-				JsonNode *val = port_node->data_dict.at("offset");
-				if (val->type == 'N')
-					port_wire->start_offset = val->data_number;
-			}
+			if (port_node.has_offset)
+				port_wire->start_offset = port_node.offset;
 
-			if (port_direction_node->data_string == "input") {
+			if (port_node.direction == "input") {
 				port_wire->port_input = true;
 			} else
-			if (port_direction_node->data_string == "output") {
+			if (port_node.direction == "output") {
 				port_wire->port_output = true;
 			} else
-			if (port_direction_node->data_string == "inout") {
+			if (port_node.direction == "inout") {
 				port_wire->port_input = true;
 				port_wire->port_output = true;
 			} else
-				log_error("JSON port node '%s' has invalid '%s' direction attribute.\n", log_id(port_name), port_direction_node->data_string.c_str());
+				log_error("JSON port node '%s' has invalid '%s' direction attribute.\n", log_id(port_name), port_node.direction.c_str());
 
 			port_wire->port_id = port_id;
 
-			for (int i = 0; i < GetSize(port_bits_node->data_array); i++)
+			for (int i = 0; i < GetSize(port_node.bits); i++)
 			{
-				JsonNode *bitval_node = port_bits_node->data_array.at(i);
+				JsonBit bitval = port_node.bits[i];
 				SigBit sigbit(port_wire, i);
 
-				if (bitval_node->type == 'S') {
-					if (bitval_node->data_string == "0")
-						module->connect(sigbit, State::S0);
-					else if (bitval_node->data_string == "1")
-						module->connect(sigbit, State::S1);
-					else if (bitval_node->data_string == "x")
-						module->connect(sigbit, State::Sx);
-					else if (bitval_node->data_string == "z")
-						module->connect(sigbit, State::Sz);
-					else
-						log_error("JSON port node '%s' has invalid '%s' bit string value on bit %d.\n",
-								log_id(port_name), bitval_node->data_string.c_str(), i);
-				} else
-				if (bitval_node->type == 'N') {
-					int bitidx = bitval_node->data_number;
+				if (bitval >= json_const_bits) {
+					module->connect(sigbit, State(bitval - json_const_bits));
+				} else {
+					int bitidx = bitval;
 					if (signal_bits.count(bitidx)) {
 						if (port_wire->port_output) {
 							module->connect(sigbit, signal_bits.at(bitidx));
@@ -401,214 +727,151 @@ void json_import(Design *design, string &modname, JsonNode *node)
 					} else {
 						signal_bits[bitidx] = sigbit;
 					}
-				} else
-					log_error("JSON port node '%s' has invalid bit value on bit %d.\n", log_id(port_name), i);
+				}
 			}
 		}
 
 		module->fixup_ports();
 	}
 
-	if (node->data_dict.count("netnames"))
+	if (node.has_netnames)
 	{
-		JsonNode *netnames_node = node->data_dict.at("netnames");
-
-		if (netnames_node->type != 'D')
-			log_error("JSON netnames node is not a dictionary.\n");
-
-		for (auto &net : netnames_node->data_dict)
+		for (auto &net : node.netnames)
 		{
 			IdString net_name = RTLIL::escape_id(net.first.c_str());
-			JsonNode *net_node = net.second;
+			JsonWire &net_node = net.second;
 
-			if (net_node->type != 'D')
+			if (!net_node.is_dict)
 				log_error("JSON netname node '%s' is not a dictionary.\n", log_id(net_name));
 
-			if (net_node->data_dict.count("bits") == 0)
+			if (net_node.bits_type == 0)
 				log_error("JSON netname node '%s' has no bits attribute.\n", log_id(net_name));
 
-			JsonNode *bits_node = net_node->data_dict.at("bits");
-
-			if (bits_node->type != 'A')
+			if (net_node.bits_type != 'A')
 				log_error("JSON netname node '%s' has non-array bits attribute.\n", log_id(net_name));
 
 			Wire *wire = module->wire(net_name);
 
 			if (wire == nullptr)
-				wire = module->addWire(net_name, GetSize(bits_node->data_array));
+				wire = module->addWire(net_name, GetSize(net_node.bits));
 
-			if (net_node->data_dict.count("upto") != 0) {
-				JsonNode *val = net_node->data_dict.at("upto");
-				if (val->type == 'N')
-					wire->upto = val->data_number != 0;
-			}
+			if (net_node.has_upto)
+				wire->upto = net_node.upto != 0;
 
-			if (net_node->data_dict.count("offset") != 0) {
-				JsonNode *val = net_node->data_dict.at("offset");
-				if (val->type == 'N')
-					wire->start_offset = val->data_number;
-			}
+			if (net_node.has_offset)
+				wire->start_offset = net_node.offset;
 
-			for (int i = 0; i < GetSize(bits_node->data_array); i++)
+			for (int i = 0; i < GetSize(net_node.bits); i++)
 			{
-				JsonNode *bitval_node = bits_node->data_array.at(i);
+				JsonBit bitval = net_node.bits[i];
 				SigBit sigbit(wire, i);
 
-				if (bitval_node->type == 'S') {
-					if (bitval_node->data_string == "0")
-						module->connect(sigbit, State::S0);
-					else if (bitval_node->data_string == "1")
-						module->connect(sigbit, State::S1);
-					else if (bitval_node->data_string == "x")
-						module->connect(sigbit, State::Sx);
-					else if (bitval_node->data_string == "z")
-						module->connect(sigbit, State::Sz);
-					else
-						log_error("JSON netname node '%s' has invalid '%s' bit string value on bit %d.\n",
-								log_id(net_name), bitval_node->data_string.c_str(), i);
-				} else
-				if (bitval_node->type == 'N') {
-					int bitidx = bitval_node->data_number;
+				if (bitval >= json_const_bits) {
+					module->connect(sigbit, State(bitval - json_const_bits));
+				} else {
+					int bitidx = bitval;
 					if (signal_bits.count(bitidx)) {
 						if (sigbit != signal_bits.at(bitidx))
 							module->connect(sigbit, signal_bits.at(bitidx));
 					} else {
 						signal_bits[bitidx] = sigbit;
 					}
-				} else
-					log_error("JSON netname node '%s' has invalid bit value on bit %d.\n", log_id(net_name), i);
+				}
 			}
 
-			if (net_node->data_dict.count("attributes"))
-				json_parse_attr_param(wire->attributes, net_node->data_dict.at("attributes"));
+			if (net_node.has_attributes)
+				json_parse_attr_param(wire->attributes, net_node.attributes);
 		}
+
+		// the bits are no longer needed
+		node.netnames.clear();
 	}
 
-	if (node->data_dict.count("cells"))
+	if (node.has_cells)
 	{
-		JsonNode *cells_node = node->data_dict.at("cells");
+		module->cells_.reserve(GetSize(node.cells));
 
-		if (cells_node->type != 'D')
-			log_error("JSON cells node is not a dictionary.\n");
-
-		for (auto &cell_node_it : cells_node->data_dict)
+		for (auto &cell_node_it : node.cells)
 		{
 			IdString cell_name = RTLIL::escape_id(cell_node_it.first.c_str());
-			JsonNode *cell_node = cell_node_it.second;
+			JsonCell &cell_node = cell_node_it.second;
 
-			if (cell_node->type != 'D')
+			if (!cell_node.is_dict)
 				log_error("JSON cells node '%s' is not a dictionary.\n", log_id(cell_name));
 
-			if (cell_node->data_dict.count("type") == 0)
+			if (cell_node.type_type == 0)
 				log_error("JSON cells node '%s' has no type attribute.\n", log_id(cell_name));
 
-			JsonNode *type_node = cell_node->data_dict.at("type");
-
-			if (type_node->type != 'S')
+			if (cell_node.type_type != 'S')
 				log_error("JSON cells node '%s' has a non-string type.\n", log_id(cell_name));
 
-			IdString cell_type = RTLIL::escape_id(type_node->data_string.c_str());
+			IdString cell_type = RTLIL::escape_id(cell_node.type.c_str());
 
 			Cell *cell = module->addCell(cell_name, cell_type);
 
-			if (cell_node->data_dict.count("connections") == 0)
+			if (cell_node.connections_type == 0)
 				log_error("JSON cells node '%s' has no connections attribute.\n", log_id(cell_name));
 
-			JsonNode *connections_node = cell_node->data_dict.at("connections");
-
-			if (connections_node->type != 'D')
+			if (cell_node.connections_type != 'D')
 				log_error("JSON cells node '%s' has non-dictionary connections attribute.\n", log_id(cell_name));
 
-			for (auto &conn_it : connections_node->data_dict)
+			for (auto &conn_it : cell_node.connections)
 			{
 				IdString conn_name = RTLIL::escape_id(conn_it.first.c_str());
-				JsonNode *conn_node = conn_it.second;
-
-				if (conn_node->type != 'A')
-					log_error("JSON cells node '%s' connection '%s' is not an array.\n", log_id(cell_name), log_id(conn_name));
-
 				SigSpec sig;
 
-				for (int i = 0; i < GetSize(conn_node->data_array); i++)
+				for (auto bitval : conn_it.second)
 				{
-					JsonNode *bitval_node = conn_node->data_array.at(i);
-
-					if (bitval_node->type == 'S') {
-						if (bitval_node->data_string == "0")
-							sig.append(State::S0);
-						else if (bitval_node->data_string == "1")
-							sig.append(State::S1);
-						else if (bitval_node->data_string == "x")
-							sig.append(State::Sx);
-						else if (bitval_node->data_string == "z")
-							sig.append(State::Sz);
-						else
-							log_error("JSON cells node '%s' connection '%s' has invalid '%s' bit string value on bit %d.\n",
-									log_id(cell_name), log_id(conn_name), bitval_node->data_string.c_str(), i);
-					} else
-					if (bitval_node->type == 'N') {
-						int bitidx = bitval_node->data_number;
+					if (bitval >= json_const_bits) {
+						sig.append(State(bitval - json_const_bits));
+					} else {
+						int bitidx = bitval;
 						if (signal_bits.count(bitidx) == 0)
 							signal_bits[bitidx] = module->addWire(NEW_ID);
 						sig.append(signal_bits.at(bitidx));
-					} else
-						log_error("JSON cells node '%s' connection '%s' has invalid bit value on bit %d.\n",
-								log_id(cell_name), log_id(conn_name), i);
-
+					}
 				}
 
 				cell->setPort(conn_name, sig);
 			}
 
-			if (cell_node->data_dict.count("attributes"))
-				json_parse_attr_param(cell->attributes, cell_node->data_dict.at("attributes"));
+			if (cell_node.has_attributes)
+				json_parse_attr_param(cell->attributes, cell_node.attributes);
 
-			if (cell_node->data_dict.count("parameters"))
-				json_parse_attr_param(cell->parameters, cell_node->data_dict.at("parameters"));
+			if (cell_node.has_parameters)
+				json_parse_attr_param(cell->parameters, cell_node.parameters);
 		}
 	}
 
-	if (node->data_dict.count("memories"))
+	if (node.has_memories)
 	{
-		JsonNode *memories_node = node->data_dict.at("memories");
-
-		if (memories_node->type != 'D')
-			log_error("JSON memories node is not a dictionary.\n");
-
-		for (auto &memory_node_it : memories_node->data_dict)
+		for (auto &memory_node_it : node.memories)
 		{
 			IdString memory_name = RTLIL::escape_id(memory_node_it.first.c_str());
-			JsonNode *memory_node = memory_node_it.second;
+			JsonMemory &memory_node = memory_node_it.second;
 
 			RTLIL::Memory *mem = new RTLIL::Memory;
 			mem->name = memory_name;
 
-			if (memory_node->type != 'D')
+			if (!memory_node.is_dict)
 				log_error("JSON memory node '%s' is not a dictionary.\n", log_id(memory_name));
 
-			if (memory_node->data_dict.count("width") == 0)
+			if (memory_node.width_type == 0)
 				log_error("JSON memory node '%s' has no width attribute.\n", log_id(memory_name));
-			JsonNode *width_node = memory_node->data_dict.at("width");
-			if (width_node->type != 'N')
+			if (memory_node.width_type != 'N')
 				log_error("JSON memory node '%s' has a non-number width.\n", log_id(memory_name));
-			mem->width = width_node->data_number;
+			mem->width = memory_node.width;
 
-			if (memory_node->data_dict.count("size") == 0)
+			if (memory_node.size_type == 0)
 				log_error("JSON memory node '%s' has no size attribute.\n", log_id(memory_name));
-			JsonNode *size_node = memory_node->data_dict.at("size");
-			if (size_node->type != 'N')
+			if (memory_node.size_type != 'N')
 				log_error("JSON memory node '%s' has a non-number size.\n", log_id(memory_name));
-			mem->size = size_node->data_number;
+			mem->size = memory_node.size;
 
-			mem->start_offset = 0;
-			if (memory_node->data_dict.count("start_offset") != 0) {
-				JsonNode *val = memory_node->data_dict.at("start_offset");
-				if (val->type == 'N')
-					mem->start_offset = val->data_number;
-			}
+			mem->start_offset = memory_node.start_offset;
 
-			if (memory_node->data_dict.count("attributes"))
-				json_parse_attr_param(mem->attributes, memory_node->data_dict.at("attributes"));
+			if (memory_node.has_attributes)
+				json_parse_attr_param(mem->attributes, memory_node.attributes);
 
 			module->memories[mem->name] = mem;
 		}
@@ -617,6 +880,8 @@ void json_import(Design *design, string &modname, JsonNode *node)
 	// remove duplicates from connections array
 	pool<RTLIL::SigSig> unique_connections(module->connections_.begin(), module->connections_.end());
 	module->connections_ = std::vector<RTLIL::SigSig>(unique_connections.begin(), unique_connections.end());
+
+	return module;
 }
 
 struct JsonFrontend : public Frontend {
@@ -646,21 +911,46 @@ struct JsonFrontend : public Frontend {
 		}
 		extra_args(f, filename, args, argidx);
 
-		JsonNode root(*f);
+		JsonReader reader(*f);
 
-		if (root.type != 'D')
+		if (reader.next_type() != 'D')
 			log_error("JSON root node is not a dictionary.\n");
 
-		if (root.data_dict.count("modules") != 0)
+		// Modules are imported as they are read, but end up in the same order as if the whole file had been
+		// read into a dict first.
+		dict<string, Module*> modules;
+
+		string key, modname;
+		reader.begin('D');
+		while (reader.next_member(key))
 		{
-			JsonNode *modules = root.data_dict.at("modules");
+			if (key != "modules") {
+				reader.skip_value();
+				continue;
+			}
 
-			if (modules->type != 'D')
+			if (reader.next_type() != 'D')
 				log_error("JSON modules node is not a dictionary.\n");
 
-			for (auto &it : modules->data_dict)
-				json_import(design, it.first, it.second);
+			reader.begin('D');
+			while (reader.next_member(modname))
+			{
+				JsonModule node;
+				node.read(reader);
+
+				auto it = modules.find(modname);
+				if (it != modules.end()) {
+					design->remove(it->second);
+					it->second = nullptr;
+				}
+				modules[modname] = json_import(design, modname, node);
+			}
 		}
+
+		for (auto &it : modules)
+			design->modules_.erase(it.second->name);
+		for (auto &it : modules)
+			design->modules_[it.second->name] = it.second;
 	}
 } JsonFrontend;
 
@@ -387,6 +387,29 @@ static bool create_latch(RTLIL::Module *module, const LibertyAst *node, bool fla
 	return true;
 }
 
+// The parts of a liberty file used in -lib mode, and in the default mode.
+static const LibertyFilter liberty_lib_filter = {
+	"/library/type/*",
+	"/library/cell/type/*",
+	"/library/cell/pin/direction",
+	"/library/cell/bus/direction",
+	"/library/cell/bus/bus_type",
+	"/library/cell/bus/pin/direction",
+};
+
+static const LibertyFilter liberty_filter = {
+	"/library/type/*",
+	"/library/cell/type/*",
+	"/library/cell/pin/direction",
+	"/library/cell/pin/function",
+	"/library/cell/pin/three_state",
+	"/library/cell/bus/direction",
+	"/library/cell/bus/bus_type",
+	"/library/cell/bus/pin/direction",
+	"/library/cell/ff/*",
+	"/library/cell/latch/*",
+};
+
 void parse_type_map(std::map<std::string, std::tuple<int, int, bool>> &type_map, const LibertyAst *ast)
 {
 	for (auto type_node : ast->children)
@@ -429,7 +452,9 @@ void parse_type_map(std::map<std::string, std::tuple<int, int, bool>> &type_map,
 }
 
 struct LibertyFrontend : public Frontend {
-	LibertyFrontend() : Frontend("liberty", "read cells from liberty file") { }
+	LibertyFrontend() : Frontend("liberty", "read cells from liberty file") {
+		LibertyCache::register_filter(liberty_filter);
+	}
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -523,13 +548,25 @@ struct LibertyFrontend : public Frontend {
 
 		log_header(design, "Executing Liberty frontend: %s\n", filename.c_str());
 
-		LibertyParser parser(*f);
+		// Files are parsed through the liberty cache of the design, so that other commands reading the same file
+		// can reuse the result. Here documents and compressed files, which have already been decompressed into a
+		// stream, are parsed from the stream.
+		const LibertyFilter &filter = flag_lib ? liberty_lib_filter : liberty_filter;
+		std::shared_ptr<const LibertyAst> library;
+		if (dynamic_cast<std::ifstream*>(f) != nullptr)
+			library = design->liberty_cache->load(filename, filter);
+		if (library == nullptr) {
+			auto parser = std::make_shared<const LibertyParser>(*f, &filter);
+			if (parser->ast == nullptr)
+				log_error("Liberty file `%s' is empty.\n", filename.c_str());
+			library = std::shared_ptr<const LibertyAst>(parser, parser->ast);
+		}
 		int cell_count = 0;
 
 		std::map<std::string, std::tuple<int, int, bool>> global_type_map;
-		parse_type_map(global_type_map, parser.ast);
+		parse_type_map(global_type_map, library.get());
 
-		for (auto cell : parser.ast->children)
+		for (auto cell : library->children)
 		{
 			if (cell->id != "cell" || cell->args.size() != 1)
 				continue;
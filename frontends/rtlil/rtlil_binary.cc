@@ -0,0 +1,393 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  ---
+ *
+ *  Reader for the binary RTLIL format. See backends/rtlil/rtlil_binary.h
+ *  for a description of the encoding.
+ *
+ */
+
+#include "rtlil_frontend.h"
+#include "backends/rtlil/rtlil_binary.h"
+#include "kernel/log.h"
+
+#include <string.h>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
+YOSYS_NAMESPACE_BEGIN
+
+namespace {
+
+struct BinaryReader
+{
+	const unsigned char *pos, *end;
+	std::vector<RTLIL::IdString> ids;
+	std::vector<RTLIL::Wire*> wires;
+	RTLIL::Module *module = nullptr;
+
+	BinaryReader(const char *data, size_t size) :
+			pos(reinterpret_cast<const unsigned char*>(data)), end(pos + size) { }
+
+	[[noreturn]] void error(const char *what)
+	{
+		log_error("Malformed binary RTLIL file: %s.\n", what);
+	}
+
+	uint64_t read_uint()
+	{
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (pos == end)
+				error("unexpected end of file");
+			unsigned char byte = *pos++;
+			value |= uint64_t(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				return value;
+		}
+		error("integer out of range");
+	}
+
+	int read_int()
+	{
+		uint64_t value = read_uint();
+		return int((value >> 1) ^ -(value & 1));
+	}
+
+	int read_size()
+	{
+		uint64_t value = read_uint();
+		if (value > 0x7fffffff)
+			error("size out of range");
+		return int(value);
+	}
+
+	RTLIL::IdString read_id()
+	{
+		uint64_t index = read_uint();
+		if (index > 0) {
+			if (index > ids.size())
+				error("reference to unknown identifier");
+			return ids[index - 1];
+		}
+		uint64_t size = read_uint();
+		if (size > uint64_t(end - pos))
+			error("unexpected end of file");
+		ids.push_back(RTLIL::IdString(std::string(reinterpret_cast<const char*>(pos), size)));
+		pos += size;
+		return ids.back();
+	}
+
+	RTLIL::Const read_const()
+	{
+		uint64_t header = read_uint();
+		int width = read_size();
+		bool two_valued = (header & 1) == 0;
+		int per_byte = two_valued ? 8 : 2, bits_per_state = two_valued ? 1 : 4;
+		size_t bytes = (size_t(width) + per_byte - 1) / per_byte;
+		if (bytes > size_t(end - pos))
+			error("unexpected end of file");
+
+		RTLIL::Const data;
+		data.flags = int(header >> 1);
+		data.bits.resize(width);
+		for (int i = 0; i < width; i++) {
+			unsigned state = (pos[i / per_byte] >> ((i % per_byte) * bits_per_state)) & (two_valued ? 1 : 15);
+			if (state > RTLIL::Sm)
+				error("invalid constant bit");
+			data.bits[i] = RTLIL::State(state);
+		}
+		pos += bytes;
+		return data;
+	}
+
+	RTLIL::SigSpec read_sigspec()
+	{
+		int count = read_size();
+		if (count == 1)
+			return read_sigchunk();
+		std::vector<RTLIL::SigChunk> chunks;
+		chunks.reserve(count);
+		for (int i = 0; i < count; i++)
+			chunks.push_back(read_sigchunk());
+		return chunks;
+	}
+
+	RTLIL::SigChunk read_sigchunk()
+	{
+		uint64_t index = read_uint();
+		if (index == 0)
+			return read_const();
+		if (index > wires.size())
+			error("reference to unknown wire");
+		RTLIL::Wire *wire = wires[index - 1];
+		int offset = read_size(), width = read_size();
+		if (width == 0)
+			return wire;
+		if (int64_t(offset) + width > wire->width)
+			error("wire slice out of range");
+		return RTLIL::SigChunk(wire, offset, width);
+	}
+
+	dict<RTLIL::IdString, RTLIL::Const> read_attributes()
+	{
+		dict<RTLIL::IdString, RTLIL::Const> attributes;
+		int count = read_size();
+		for (int i = 0; i < count; i++) {
+			RTLIL::IdString name = read_id();
+			attributes[name] = read_const();
+		}
+		return attributes;
+	}
+
+	void read_case_body(RTLIL::CaseRule *cs)
+	{
+		int count = read_size();
+		cs->actions.reserve(count);
+		for (int i = 0; i < count; i++) {
+			RTLIL::SigSpec lhs = read_sigspec();
+			cs->actions.push_back(RTLIL::SigSig(lhs, read_sigspec()));
+		}
+		count = read_size();
+		for (int i = 0; i < count; i++) {
+			RTLIL::SwitchRule *sw = new RTLIL::SwitchRule;
+			cs->switches.push_back(sw);
+			sw->attributes = read_attributes();
+			sw->signal = read_sigspec();
+			int case_count = read_size();
+			for (int j = 0; j < case_count; j++) {
+				RTLIL::CaseRule *cs2 = new RTLIL::CaseRule;
+				sw->cases.push_back(cs2);
+				cs2->attributes = read_attributes();
+				int compare_count = read_size();
+				for (int k = 0; k < compare_count; k++)
+					cs2->compare.push_back(read_sigspec());
+				read_case_body(cs2);
+			}
+		}
+	}
+
+	void read_sync(RTLIL::SyncRule *sy)
+	{
+		uint64_t type = read_uint();
+		if (type > RTLIL::STi)
+			error("invalid sync type");
+		sy->type = RTLIL::SyncType(type);
+		sy->signal = read_sigspec();
+		int count = read_size();
+		for (int i = 0; i < count; i++) {
+			RTLIL::SigSpec lhs = read_sigspec();
+			sy->actions.push_back(RTLIL::SigSig(lhs, read_sigspec()));
+		}
+		count = read_size();
+		for (int i = 0; i < count; i++) {
+			RTLIL::MemWriteAction act;
+			act.attributes = read_attributes();
+			act.memid = read_id();
+			act.address = read_sigspec();
+			act.data = read_sigspec();
+			act.enable = read_sigspec();
+			act.priority_mask = read_const();
+			sy->mem_write_actions.push_back(std::move(act));
+		}
+	}
+
+	void read_module(RTLIL::Design *design)
+	{
+		dict<RTLIL::IdString, RTLIL::Const> attributes = read_attributes();
+		RTLIL::IdString name = read_id();
+
+		// This follows the handling of re-definitions in the text parser.
+		bool delete_module = false;
+		if (design->has(name)) {
+			RTLIL::Module *existing_mod = design->module(name);
+			if (!RTLIL_FRONTEND::flag_overwrite && (RTLIL_FRONTEND::flag_lib || (attributes.count(ID::blackbox) && attributes.at(ID::blackbox).as_bool()))) {
+				log("Ignoring blackbox re-definition of module %s.\n", name.c_str());
+				delete_module = true;
+			} else if (!RTLIL_FRONTEND::flag_nooverwrite && !RTLIL_FRONTEND::flag_overwrite && !existing_mod->get_bool_attribute(ID::blackbox)) {
+				log_error("RTLIL error: redefinition of module %s.\n", name.c_str());
+			} else if (RTLIL_FRONTEND::flag_nooverwrite) {
+				log("Ignoring re-definition of module %s.\n", name.c_str());
+				delete_module = true;
+			} else {
+				log("Replacing existing%s module %s.\n", existing_mod->get_bool_attribute(ID::blackbox) ? " blackbox" : "", name.c_str());
+				design->remove(existing_mod);
+			}
+		}
+
+		module = new RTLIL::Module;
+		module->name = name;
+		module->attributes = std::move(attributes);
+		if (!delete_module)
+			design->add(module);
+
+		int count = read_size();
+		for (int i = 0; i < count; i++) {
+			RTLIL::IdString param = read_id();
+			module->avail_parameters(param);
+			if (read_uint() != 0)
+				module->parameter_default_values[param] = read_const();
+		}
+
+		count = read_size();
+		wires.clear();
+		wires.reserve(count);
+		module->wires_.reserve(count);
+		for (int i = 0; i < count; i++) {
+			dict<RTLIL::IdString, RTLIL::Const> attributes = read_attributes();
+			RTLIL::IdString name = read_id();
+			if (module->wire(name) != nullptr)
+				log_error("RTLIL error: redefinition of wire %s.\n", name.c_str());
+			RTLIL::Wire *wire = module->addWire(name, read_size());
+			wire->attributes = std::move(attributes);
+			wire->start_offset = read_int();
+			uint64_t flags = read_uint();
+			wire->upto = (flags & 1) != 0;
+			wire->is_signed = (flags & 2) != 0;
+			wire->port_input = (flags & 4) != 0;
+			wire->port_output = (flags & 8) != 0;
+			wire->port_id = read_size();
+			wires.push_back(wire);
+		}
+
+		count = read_size();
+		for (int i = 0; i < count; i++) {
+			RTLIL::Memory *memory = new RTLIL::Memory;
+			memory->attributes = read_attributes();
+			memory->name = read_id();
+			if (module->memories.count(memory->name) != 0)
+				log_error("RTLIL error: redefinition of memory %s.\n", memory->name.c_str());
+			memory->width = read_size();
+			memory->size = read_size();
+			memory->start_offset = read_int();
+			module->memories[memory->name] = memory;
+		}
+
+		count = read_size();
+		module->cells_.reserve(count);
+		for (int i = 0; i < count; i++) {
+			dict<RTLIL::IdString, RTLIL::Const> attributes = read_attributes();
+			RTLIL::IdString type = read_id();
+			RTLIL::IdString name = read_id();
+			if (module->cell(name) != nullptr)
+				log_error("RTLIL error: redefinition of cell %s.\n", name.c_str());
+			RTLIL::Cell *cell = module->addCell(name, type);
+			cell->attributes = std::move(attributes);
+			int param_count = read_size();
+			for (int j = 0; j < param_count; j++) {
+				RTLIL::IdString param = read_id();
+				cell->parameters[param] = read_const();
+			}
+			int port_count = read_size();
+			for (int j = 0; j < port_count; j++) {
+				RTLIL::IdString port = read_id();
+				cell->setPort(port, read_sigspec());
+			}
+		}
+
+		count = read_size();
+		for (int i = 0; i < count; i++) {
+			dict<RTLIL::IdString, RTLIL::Const> attributes = read_attributes();
+			RTLIL::IdString name = read_id();
+			if (module->processes.count(name) != 0)
+				log_error("RTLIL error: redefinition of process %s.\n", name.c_str());
+			RTLIL::Process *proc = module->addProcess(name);
+			proc->attributes = std::move(attributes);
+			read_case_body(&proc->root_case);
+			int sync_count = read_size();
+			for (int j = 0; j < sync_count; j++) {
+				RTLIL::SyncRule *sync = new RTLIL::SyncRule;
+				proc->syncs.push_back(sync);
+				read_sync(sync);
+			}
+		}
+
+		count = read_size();
+		for (int i = 0; i < count; i++) {
+			RTLIL::SigSpec lhs = read_sigspec();
+			module->connect(lhs, read_sigspec());
+		}
+
+		module->fixup_ports();
+		if (delete_module)
+			delete module;
+		else if (RTLIL_FRONTEND::flag_lib)
+			module->makeblackbox();
+		module = nullptr;
+	}
+
+	void read_design(RTLIL::Design *design)
+	{
+		if (size_t(end - pos) < sizeof(RTLIL_BINARY::magic) || memcmp(pos, RTLIL_BINARY::magic, sizeof(RTLIL_BINARY::magic)))
+			error("bad magic");
+		pos += sizeof(RTLIL_BINARY::magic);
+		if (read_uint() != RTLIL_BINARY::version)
+			error("unsupported version");
+		autoidx = max(autoidx, int(read_uint()));
+
+		int count = read_size();
+		for (int i = 0; i < count; i++)
+			read_module(design);
+		if (pos != end)
+			error("trailing data");
+	}
+};
+
+}
+
+bool RTLIL_FRONTEND::is_binary(std::istream &f)
+{
+	// The first byte of the magic can't start a text RTLIL file; the rest of it is checked by the reader.
+	return f.peek() == (unsigned char)RTLIL_BINARY::magic[0];
+}
+
+void RTLIL_FRONTEND::parse_binary(std::istream &f, std::string filename, RTLIL::Design *design)
+{
+#ifndef _WIN32
+	// Map plain files into memory instead of copying them through the stream.
+	if (dynamic_cast<std::ifstream*>(&f) != nullptr) {
+		int fd = open(filename.c_str(), O_RDONLY);
+		struct stat info;
+		if (fd >= 0 && fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+			void *addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (addr != MAP_FAILED) {
+				close(fd);
+				madvise(addr, info.st_size, MADV_SEQUENTIAL);
+				BinaryReader reader(static_cast<const char*>(addr), info.st_size);
+				reader.read_design(design);
+				munmap(addr, info.st_size);
+				return;
+			}
+		}
+		if (fd >= 0)
+			close(fd);
+	}
+#endif
+	std::stringstream ss;
+	ss << f.rdbuf();
+	std::string data = ss.str();
+	BinaryReader reader(data.data(), data.size());
+	reader.read_design(design);
+}
+
+YOSYS_NAMESPACE_END
@@ -55,6 +55,8 @@ struct RTLILFrontend : public Frontend {
 		log("    -lib\n");
 		log("        only create empty blackbox modules\n");
 		log("\n");
+		log("Files written with 'write_rtlil -binary' are detected and read automatically.\n");
+		log("\n");
 	}
 	void execute(std::istream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
@@ -83,10 +85,15 @@ struct RTLILFrontend : public Frontend {
 			}
 			break;
 		}
-		extra_args(f, filename, args, argidx);
+		extra_args(f, filename, args, argidx, true);
 
 		log("Input filename: %s\n", filename.c_str());
 
+		if (RTLIL_FRONTEND::is_binary(*f)) {
+			RTLIL_FRONTEND::parse_binary(*f, filename, design);
+			return;
+		}
+
 		RTLIL_FRONTEND::lexin = f;
 		RTLIL_FRONTEND::current_design = design;
 		rtlil_frontend_yydebug = false;
@@ -35,6 +35,9 @@ namespace RTLIL_FRONTEND {
 	extern bool flag_nooverwrite;
 	extern bool flag_overwrite;
 	extern bool flag_lib;
+
+	bool is_binary(std::istream &f);
+	void parse_binary(std::istream &f, std::string filename, RTLIL::Design *design);
 }
 
 YOSYS_NAMESPACE_END
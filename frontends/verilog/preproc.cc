@@ -361,6 +361,8 @@ void define_map_t::merge(const define_map_t &map)
 
 const define_body_t *define_map_t::find(const std::string &name) const
 {
+	if (lookups)
+		lookups->insert(name);
 	auto it = defines.find(name);
 	return (it == defines.end()) ? nullptr : it->second.get();
 }
@@ -385,6 +387,81 @@ void define_map_t::log() const
 	}
 }
 
+bool define_map_t::same_definition(const std::string &name, const define_map_t &other) const
+{
+	auto it = defines.find(name), other_it = other.defines.find(name);
+	if (it == defines.end() || other_it == other.defines.end())
+		return it == defines.end() && other_it == other.defines.end();
+
+	const define_body_t &a = *it->second, &b = *other_it->second;
+	if (a.body != b.body || a.has_args != b.has_args || GetSize(a.args.args) != GetSize(b.args.args))
+		return false;
+	for (int i = 0; i < GetSize(a.args.args); i++) {
+		const macro_arg_t &arg_a = a.args.args[i], &arg_b = b.args.args[i];
+		if (arg_a.name != arg_b.name || arg_a.has_default != arg_b.has_default || arg_a.default_value != arg_b.default_value)
+			return false;
+	}
+	return true;
+}
+
+static void serialize_string(std::string &data, const std::string &str)
+{
+	data += stringf("%zu:", str.size());
+	data += str;
+}
+
+static std::string deserialize_string(const std::string &data, size_t &pos)
+{
+	size_t colon = data.find(':', pos);
+	log_assert(colon != std::string::npos);
+	size_t size = std::stoul(data.substr(pos, colon - pos));
+	log_assert(colon + 1 + size <= data.size());
+	pos = colon + 1 + size;
+	return data.substr(colon + 1, size);
+}
+
+std::string define_map_t::serialize() const
+{
+	std::string data;
+	for (auto &it : defines) {
+		const define_body_t &body = *it.second;
+		serialize_string(data, it.first);
+		serialize_string(data, body.body);
+		data += body.has_args ? stringf("%d:", GetSize(body.args.args)) : std::string("-:");
+		for (auto &arg : body.args.args) {
+			serialize_string(data, arg.name);
+			data += arg.has_default ? "d" : "-";
+			serialize_string(data, arg.default_value);
+		}
+	}
+	return data;
+}
+
+void define_map_t::deserialize(const std::string &data)
+{
+	size_t pos = 0;
+	while (pos < data.size()) {
+		std::string name = deserialize_string(data, pos);
+		std::string body = deserialize_string(data, pos);
+		size_t colon = data.find(':', pos);
+		log_assert(colon != std::string::npos);
+		std::string num_args = data.substr(pos, colon - pos);
+		pos = colon + 1;
+		if (num_args == "-") {
+			add(name, body);
+			continue;
+		}
+		arg_map_t args;
+		for (int i = std::stoi(num_args); i > 0; i--) {
+			std::string arg_name = deserialize_string(data, pos);
+			bool has_default = data.at(pos++) == 'd';
+			std::string default_value = deserialize_string(data, pos);
+			args.add_arg(arg_name, has_default ? default_value.c_str() : nullptr);
+		}
+		add(name, body, &args);
+	}
+}
+
 static void input_file(std::istream &f, std::string filename)
 {
 	char buffer[513];
@@ -749,11 +826,14 @@ frontend_verilog_preproc(std::istream                 &f,
                          std::string                   filename,
                          const define_map_t           &pre_defines,
                          define_map_t                 &global_defines_cache,
-                         const std::list<std::string> &include_dirs)
+                         const std::list<std::string> &include_dirs,
+                         std::set<std::string>        *macro_lookups,
+                         std::vector<std::string>     *included_files)
 {
 	define_map_t defines;
 	defines.merge(pre_defines);
 	defines.merge(global_defines_cache);
+	defines.lookups = macro_lookups;
 
 	macro_arg_stack_t macro_arg_stack;
 	std::vector<std::string> filename_stack;
@@ -914,6 +994,8 @@ frontend_verilog_preproc(std::istream                 &f,
 			} else {
 				input_file(ff, fixed_fn);
 				yosys_input_files.insert(fixed_fn);
+				if (included_files)
+					included_files->push_back(fixed_fn);
 			}
 			continue;
 		}
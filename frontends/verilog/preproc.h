@@ -28,6 +28,7 @@
 #include <iosfwd>
 #include <list>
 #include <memory>
+#include <set>
 #include <string>
 
 YOSYS_NAMESPACE_BEGIN
@@ -60,7 +61,19 @@ struct define_map_t
 	// Print a list of definitions, using the log function
 	void log() const;
 
+	// Check if name has the same definition (or lack thereof) in both maps.
+	bool same_definition(const std::string &name, const define_map_t &other) const;
+
+	// Write the definitions to a string, and add the definitions from such
+	// a string (used to pass definitions between processes).
+	std::string serialize() const;
+	void deserialize(const std::string &data);
+
 	std::map<std::string, std::unique_ptr<define_body_t>> defines;
+
+	// If not null, the names of all macros looked up with find() are
+	// added to this set.
+	std::set<std::string> *lookups = nullptr;
 };
 
 
@@ -71,7 +84,9 @@ frontend_verilog_preproc(std::istream                 &f,
                          std::string                   filename,
                          const define_map_t           &pre_defines,
                          define_map_t                 &global_defines_cache,
-                         const std::list<std::string> &include_dirs);
+                         const std::list<std::string> &include_dirs,
+                         std::set<std::string>        *macro_lookups = nullptr,
+                         std::vector<std::string>     *included_files = nullptr);
 
 YOSYS_NAMESPACE_END
 
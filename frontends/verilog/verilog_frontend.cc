@@ -29,6 +29,9 @@
 #include "verilog_frontend.h"
 #include "preproc.h"
 #include "kernel/yosys.h"
+#include "kernel/workers.h"
+#include "backends/rtlil/rtlil_backend.h"
+#include "frontends/rtlil/rtlil_frontend.h"
 #include "libs/sha1/sha1.h"
 #include <stdarg.h>
 
@@ -63,6 +66,569 @@ static void add_package_types(dict<std::string, AST::AstNode *> &user_types, std
 	}
 }
 
+// Check if a module can be passed between processes (read_verilog -j) or cached (read_verilog -cache) as RTLIL, with
+// the AST if it has parameters (see module_needs_ast()), i.e. if it doesn't depend on other modules.
+static bool module_transferable(RTLIL::Module *module)
+{
+	if (module->name.begins_with("$abstract"))
+		return false;
+	if (module->get_bool_attribute(ID::is_interface) || module->get_bool_attribute(ID::cells_not_processed) ||
+			module->get_bool_attribute(ID::dynports))
+		return false;
+	for (auto wire : module->wires())
+		if (wire->get_bool_attribute(ID::is_interface))
+			return false;
+	for (auto cell : module->cells())
+		if (cell->has_attribute(ID::reprocess_after) || cell->get_bool_attribute(ID::is_interface))
+			return false;
+	return true;
+}
+
+// Modules with parameters are passed on with their AST, so that they can be derived later (including the blackboxes of
+// read_verilog -lib).
+static bool module_needs_ast(RTLIL::Module *module)
+{
+	return !module->avail_parameters.empty() && dynamic_cast<AST::AstModule*>(module) != nullptr;
+}
+
+// Check if a file mentions SystemVerilog interfaces. The modules that declare or use them can't be passed between
+// processes, so read_verilog -j doesn't read such files in a worker process in the first place.
+static bool mentions_interfaces(const std::string &filename)
+{
+	std::ifstream f(filename);
+	std::string line;
+	auto is_word_char = [](char ch) { return isalnum((unsigned char)ch) || ch == '_' || ch == '$'; };
+	while (std::getline(f, line))
+		for (size_t pos = line.find("interface"); pos != std::string::npos; pos = line.find("interface", pos + 1))
+			if ((pos == 0 || !is_word_char(line[pos - 1])) && (pos + 9 == line.size() || !is_word_char(line[pos + 9])))
+				return true;
+	return false;
+}
+
+static void append_field(std::string &data, const std::string &field)
+{
+	data += stringf("%zu:", field.size());
+	data += field;
+}
+
+static bool next_field(const std::string &data, size_t &pos, std::string &field)
+{
+	size_t colon = data.find(':', pos);
+	if (colon == std::string::npos || colon == pos || data.find_first_not_of("0123456789", pos) != colon)
+		return false;
+	size_t size = std::stoull(data.substr(pos, colon - pos));
+	if (size > data.size() - colon - 1)
+		return false;
+	field = data.substr(colon + 1, size);
+	pos = colon + 1 + size;
+	return true;
+}
+
+template<typename T>
+static std::string join_lines(const T &items)
+{
+	std::string text;
+	for (auto &item : items)
+		text += stringf("%s\n", item.c_str());
+	return text;
+}
+
+static std::vector<std::string> split_lines(const std::string &text)
+{
+	std::vector<std::string> lines;
+	for (size_t pos = 0, next; pos < text.size(); pos = next + 1) {
+		next = text.find('\n', pos);
+		lines.push_back(text.substr(pos, next - pos));
+	}
+	return lines;
+}
+
+// The parts of the design that reading a Verilog file can change, as needed by read_verilog -j and -cache to find
+// out what reading a file changed.
+struct VerilogReadSnapshot
+{
+	dict<RTLIL::IdString, unsigned int> modules;
+	define_map_t defines;
+	size_t num_packages, num_globals, num_bindings;
+	std::set<std::string> input_files;
+	int num_warnings;
+
+	VerilogReadSnapshot(RTLIL::Design *design)
+	{
+		for (auto &it : design->modules_)
+			modules[it.first] = it.second->hashidx_;
+		defines.clear();
+		defines.merge(*design->verilog_defines);
+		num_packages = design->verilog_packages.size();
+		num_globals = design->verilog_globals.size();
+		num_bindings = design->bindings_.size();
+		input_files = yosys_input_files;
+		num_warnings = log_warnings_count;
+	}
+
+	// Modules that were added or replaced since the snapshot.
+	std::vector<RTLIL::IdString> new_modules(RTLIL::Design *design) const
+	{
+		std::vector<RTLIL::IdString> names;
+		for (auto &it : design->modules_)
+			if (!modules.count(it.first) || modules.at(it.first) != it.second->hashidx_)
+				names.push_back(it.first);
+		return names;
+	}
+
+	// Modules of the snapshot that were removed or replaced since.
+	std::vector<RTLIL::IdString> removed_modules(RTLIL::Design *design) const
+	{
+		std::vector<RTLIL::IdString> names;
+		for (auto &it : modules)
+			if (!design->has(it.first) || design->module(it.first)->hashidx_ != it.second)
+				names.push_back(it.first);
+		return names;
+	}
+
+	std::vector<std::string> changed_defines(RTLIL::Design *design) const
+	{
+		std::vector<std::string> names;
+		for (auto &it : defines.defines)
+			if (!design->verilog_defines->same_definition(it.first, defines))
+				names.push_back(it.first);
+		for (auto &it : design->verilog_defines->defines)
+			if (!defines.defines.count(it.first))
+				names.push_back(it.first);
+		return names;
+	}
+
+	bool changed_declarations(RTLIL::Design *design) const
+	{
+		return design->verilog_packages.size() != num_packages || design->verilog_globals.size() != num_globals ||
+				design->bindings_.size() != num_bindings;
+	}
+
+	// Write the new modules (as binary RTLIL, and the ASTs of the modules that need them) and the changed macros, to be
+	// read back by VerilogReadChanges.
+	std::string dump_changes(RTLIL::Design *design) const
+	{
+		define_map_t changed;
+		std::vector<std::string> undefined;
+		changed.clear();
+		for (auto &name : changed_defines(design)) {
+			if (design->verilog_defines->find(name))
+				changed.add(name, *design->verilog_defines->find(name));
+			else
+				undefined.push_back(name);
+		}
+
+		RTLIL::Selection selection(false);
+		std::string asts;
+		for (auto name : new_modules(design)) {
+			selection.selected_modules.insert(name);
+			RTLIL::Module *module = design->module(name);
+			if (module_needs_ast(module)) {
+				append_field(asts, name.str());
+				append_field(asts, static_cast<AST::AstModule*>(module)->dump_ast());
+			}
+		}
+		std::string active_module = design->selected_active_module;
+		design->selected_active_module.clear();
+		design->selection_stack.push_back(selection);
+		std::ostringstream rtlil;
+		RTLIL_BACKEND::dump_design_binary(rtlil, design, true);
+		design->selection_stack.pop_back();
+		design->selected_active_module = active_module;
+
+		std::string data;
+		append_field(data, changed.serialize());
+		append_field(data, join_lines(undefined));
+		append_field(data, rtlil.str());
+		append_field(data, asts);
+		return data;
+	}
+};
+
+// Changes written by VerilogReadSnapshot::dump_changes().
+struct VerilogReadChanges
+{
+	RTLIL::Design *modules;
+	define_map_t defines;
+	std::vector<std::string> undefined;
+
+	VerilogReadChanges() : modules(new RTLIL::Design) { defines.clear(); }
+	~VerilogReadChanges() { delete modules; }
+
+	bool load(const std::string &data, size_t &pos, const std::string &filename)
+	{
+		std::string defines_data, undefined_data, rtlil_data, ast_data;
+		if (!next_field(data, pos, defines_data) || !next_field(data, pos, undefined_data) || !next_field(data, pos, rtlil_data) ||
+				!next_field(data, pos, ast_data))
+			return false;
+		defines.deserialize(defines_data);
+		undefined = split_lines(undefined_data);
+		std::istringstream rtlil(rtlil_data);
+		RTLIL_FRONTEND::flag_nooverwrite = false;
+		RTLIL_FRONTEND::flag_overwrite = false;
+		RTLIL_FRONTEND::flag_lib = false;
+		RTLIL_FRONTEND::parse_binary(rtlil, filename, modules);
+
+		// Turn the modules that come with an AST back into AST modules, keeping their position in the design.
+		for (size_t ast_pos = 0; ast_pos < ast_data.size();) {
+			std::string name, module_ast;
+			if (!next_field(ast_data, ast_pos, name) || !next_field(ast_data, ast_pos, module_ast) || !modules->has(name))
+				return false;
+			RTLIL::Module *module = modules->module(name);
+			AST::AstModule *ast_module = new AST::AstModule;
+			ast_module->name = module->name;
+			module->cloneInto(ast_module);
+			if (!ast_module->load_ast(module_ast)) {
+				ast_module->ast = nullptr;
+				delete ast_module;
+				return false;
+			}
+			modules->modules_.at(name) = ast_module;
+			ast_module->design = modules;
+			delete module;
+		}
+		return true;
+	}
+
+	// Move the modules to the design, in the order in which they were read, and apply the changes to the macros.
+	void apply(RTLIL::Design *design)
+	{
+		std::vector<RTLIL::Module*> module_list;
+		for (int i = GetSize(modules->modules_) - 1; i >= 0; i--)
+			module_list.push_back(modules->modules_.element(i)->second);
+		for (auto module : module_list) {
+			modules->modules_.erase(module->name);
+			design->add(module);
+		}
+		for (auto &name : undefined)
+			design->verilog_defines->erase(name);
+		design->verilog_defines->merge(defines);
+	}
+};
+
+
+// An entry of the cache of read_verilog -cache holds the files the Verilog file included, with their SHA1 hashes, and
+// the macros it looked up, followed by the changes to the design, as written by VerilogReadSnapshot::dump_changes().
+// The entry starts with a SHA1 hash of the rest, so that damaged entries are ignored.
+static bool load_cache_entry(const std::string &cache_file, const std::string &filename, RTLIL::Design *design,
+		std::set<std::string> *macro_lookups)
+{
+	std::ifstream f(cache_file, std::ios::binary);
+	if (f.fail()) {
+		log("Cache miss: no entry `%s'.\n", cache_file.c_str());
+		return false;
+	}
+	std::stringstream buffer;
+	buffer << f.rdbuf();
+	std::string data = buffer.str();
+
+	size_t pos = 0;
+	std::string checksum, payload;
+	SHA1 payload_checksum;
+	if (next_field(data, pos, checksum) && next_field(data, pos, payload) && pos == data.size())
+		payload_checksum.update(payload);
+	if (payload_checksum.final() != checksum) {
+		log("Cache miss: ignoring damaged entry `%s'.\n", cache_file.c_str());
+		return false;
+	}
+
+	pos = 0;
+	std::string includes, lookups;
+	next_field(payload, pos, includes);
+	next_field(payload, pos, lookups);
+	std::vector<std::string> include_list = split_lines(includes);
+	for (int i = 0; i+1 < GetSize(include_list); i += 2)
+		if (!check_file_exists(include_list[i]) || SHA1::from_file(include_list[i]) != include_list[i+1]) {
+			log("Cache miss: included file `%s' has changed since entry `%s' was written.\n",
+					include_list[i].c_str(), cache_file.c_str());
+			return false;
+		}
+
+	// Entries written by a version of Yosys that stored less are ignored as well.
+	VerilogReadChanges changes;
+	if (!changes.load(payload, pos, filename) || pos != payload.size()) {
+		log("Cache miss: ignoring damaged entry `%s'.\n", cache_file.c_str());
+		return false;
+	}
+	for (auto &it : changes.modules->modules_)
+		if (design->has(it.first)) {
+			log("Cache miss: module `%s' from entry `%s' already exists.\n", log_id(it.first), cache_file.c_str());
+			return false;
+		}
+
+	log("Cache hit: using entry `%s'.\n", cache_file.c_str());
+	for (int i = GetSize(changes.modules->modules_) - 1; i >= 0; i--)
+		log("Using cached module `%s'.\n", log_id(changes.modules->modules_.element(i)->first));
+	changes.apply(design);
+	for (int i = 0; i+1 < GetSize(include_list); i += 2)
+		yosys_input_files.insert(include_list[i]);
+	if (macro_lookups)
+		for (auto &name : split_lines(lookups))
+			macro_lookups->insert(name);
+	return true;
+}
+
+static void store_cache_entry(const std::string &cache_file, const VerilogReadSnapshot &snapshot,
+		const std::vector<std::string> &included_files, const std::set<std::string> &lookups, RTLIL::Design *design)
+{
+	if (log_warnings_count != snapshot.num_warnings) {
+		log("Not caching the result: reading the file caused warnings.\n");
+		return;
+	}
+	if (snapshot.changed_declarations(design) || !snapshot.removed_modules(design).empty()) {
+		log("Not caching the result: the file changed existing declarations or modules.\n");
+		return;
+	}
+	for (auto name : snapshot.new_modules(design))
+		if (!module_transferable(design->module(name))) {
+			log("Not caching the result: module `%s' may need to be elaborated again later.\n", log_id(name));
+			return;
+		}
+
+	std::string includes;
+	for (auto &name : included_files)
+		includes += stringf("%s\n%s\n", name.c_str(), SHA1::from_file(name).c_str());
+
+	std::string payload;
+	append_field(payload, includes);
+	append_field(payload, join_lines(lookups));
+	payload += snapshot.dump_changes(design);
+	SHA1 checksum;
+	checksum.update(payload);
+
+	std::string cache_dir = cache_file.substr(0, cache_file.find_last_of('/'));
+	if (!check_directory_exists(cache_dir) && !create_directory(cache_dir)) {
+		log_warning("Can't create cache directory `%s'.\n", cache_dir.c_str());
+		return;
+	}
+
+	// Write to a temporary file first, so that concurrent runs never see incomplete entries.
+	std::string temp_file = make_temp_file(cache_dir + "/tmp_XXXXXX");
+	std::ofstream f(temp_file, std::ios::binary);
+	std::string data;
+	append_field(data, checksum.final());
+	append_field(data, payload);
+	f.write(data.data(), data.size());
+	f.close();
+	if (f.fail() || rename(temp_file.c_str(), cache_file.c_str()) != 0) {
+		remove(temp_file.c_str());
+		log_warning("Can't write cache entry `%s'.\n", cache_file.c_str());
+		return;
+	}
+	log("Stored the result in cache entry `%s'.\n", cache_file.c_str());
+}
+
+// Split the code of a Verilog file (usually after preprocessing) into the sources of the modules it declares, for
+// read_verilog -lazy. Each source starts with a `line directive, so that the modules keep their source locations.
+// Returns false if there is anything else than modules at the top level (e.g. packages or global declarations),
+// because such files can't be read one module at a time.
+static bool split_modules(const std::string &code, const std::string &filename, std::vector<std::pair<RTLIL::IdString, std::string>> &modules)
+{
+	auto is_ident_char = [](char ch) { return isalnum((unsigned char)ch) || ch == '_' || ch == '$'; };
+
+	std::string cur_file = filename, nettype;
+	std::vector<std::pair<std::string, int>> file_stack;
+	int line = 1;
+
+	// The start of the current module (or of the attributes in front of it), with the location and file depth there.
+	size_t start = std::string::npos;
+	std::string start_file, start_nettype;
+	int start_line = 0, start_depth = 0;
+	bool in_module = false;
+	RTLIL::IdString name;
+
+	size_t i = 0;
+	auto skip_line = [&]() {
+		while (i < code.size() && code[i] != '\n')
+			i++;
+	};
+	auto skip_string = [&]() {
+		for (i++; i < code.size() && code[i] != '"'; i++) {
+			if (code[i] == '\\' && i + 1 < code.size())
+				i++;
+			if (code[i] == '\n')
+				line++;
+		}
+		i++;
+	};
+	auto skip_comment = [&]() {
+		size_t pos = code.find("*/", i + 2);
+		pos = pos == std::string::npos ? code.size() : pos + 2;
+		line += std::count(code.begin() + i, code.begin() + pos, '\n');
+		i = pos;
+	};
+
+	while (i < code.size())
+	{
+		char ch = code[i];
+
+		if (ch == '\n') {
+			line++, i++;
+			continue;
+		}
+		if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\f') {
+			i++;
+			continue;
+		}
+		if (code.compare(i, 2, "/*") == 0) {
+			skip_comment();
+			continue;
+		}
+		if (code.compare(i, 2, "//") == 0) {
+			skip_line();
+			continue;
+		}
+
+		if (ch == '`') {
+			size_t end = i + 1;
+			while (end < code.size() && is_ident_char(code[end]))
+				end++;
+			std::string directive = code.substr(i, end - i);
+			if (directive == "`file_push") {
+				size_t quote = code.find('"', end);
+				size_t eol = code.find('\n', end);
+				if (quote == std::string::npos || quote > eol || (eol = code.rfind('"', eol)) <= quote)
+					return false;
+				file_stack.push_back({cur_file, line});
+				cur_file = code.substr(quote + 1, eol - quote - 1);
+				line = 0;
+				i = end;
+				skip_line();
+				continue;
+			}
+			if (directive == "`file_pop") {
+				if (file_stack.empty())
+					return false;
+				cur_file = file_stack.back().first;
+				line = file_stack.back().second;
+				file_stack.pop_back();
+				i = end;
+				skip_line();
+				if (i < code.size())
+					i++;
+				continue;
+			}
+			if (directive == "`line") {
+				// `line <line> "<file>" <level>
+				std::istringstream args(code.substr(end, code.find('\n', end) - end));
+				std::string file;
+				args >> line >> file;
+				if (!args || file.size() < 2 || file.front() != '"' || file.back() != '"')
+					return false;
+				cur_file = file.substr(1, file.size() - 2);
+				i = end;
+				skip_line();
+				if (i < code.size())
+					i++;
+				continue;
+			}
+			if (directive == "`default_nettype") {
+				size_t eol = std::min(code.find('\n', end), code.size());
+				nettype = code.substr(i, eol - i);
+			}
+			// Other directives (`celldefine, `timescale with -nopp, ...) take up the rest of their line. Inside of
+			// a module they are simply part of the source of the module.
+			if (in_module) {
+				i = end;
+				continue;
+			}
+			if (start != std::string::npos)
+				return false;
+			skip_line();
+			continue;
+		}
+
+		if (ch == '"') {
+			skip_string();
+			continue;
+		}
+
+		if (!in_module && code.compare(i, 2, "(*") == 0) {
+			if (start == std::string::npos) {
+				start = i, start_line = line, start_file = cur_file;
+				start_nettype = nettype, start_depth = GetSize(file_stack);
+			}
+			i += 2;
+			while (i < code.size() && code.compare(i, 2, "*)") != 0) {
+				if (code[i] == '"')
+					skip_string();
+				else if (code[i++] == '\n')
+					line++;
+			}
+			i += 2;
+			continue;
+		}
+
+		if (ch == '\\' || is_ident_char(ch)) {
+			size_t end = i + 1;
+			if (ch == '\\')
+				while (end < code.size() && code[end] > ' ' && code[end] <= '~')
+					end++;
+			else
+				while (end < code.size() && is_ident_char(code[end]))
+					end++;
+			std::string token = code.substr(i, end - i);
+			size_t token_start = i;
+			i = end;
+
+			if (in_module) {
+				if (name.empty() && token != "automatic" && token != "static") {
+					name = RTLIL::escape_id(ch == '\\' ? token.substr(1) : token);
+					continue;
+				}
+				if (token == "module" || token == "macromodule")
+					return false;
+				if (token != "endmodule")
+					continue;
+
+				// Include an end label (`endmodule : name`) in the source of the module.
+				size_t pos = i;
+				while (pos < code.size() && (code[pos] == ' ' || code[pos] == '\t'))
+					pos++;
+				if (pos < code.size() && code[pos] == ':') {
+					for (pos++; pos < code.size() && (code[pos] == ' ' || code[pos] == '\t'); pos++) { }
+					if (pos < code.size() && (code[pos] == '\\' || is_ident_char(code[pos]))) {
+						while (pos < code.size() && code[pos] > ' ' && code[pos] <= '~' && code[pos] != ';')
+							pos++;
+						i = pos;
+					}
+				}
+
+				if (GetSize(file_stack) != start_depth || name.empty())
+					return false;
+				std::string source;
+				if (!start_nettype.empty())
+					source += start_nettype + "\n";
+				if (start_file.find_first_of(" \t\"") != std::string::npos)
+					return false;
+				source += stringf("`line %d \"%s\" 0\n", start_line, start_file.c_str());
+				source += code.substr(start, i - start);
+				source += "\n";
+				modules.push_back({name, source});
+				in_module = false;
+				start = std::string::npos;
+				continue;
+			}
+
+			if (token != "module" && token != "macromodule")
+				return false;
+			if (start == std::string::npos) {
+				start = token_start, start_line = line, start_file = cur_file;
+				start_nettype = nettype, start_depth = GetSize(file_stack);
+			}
+			in_module = true;
+			name = RTLIL::IdString();
+			continue;
+		}
+
+		if (!in_module)
+			return false;
+		i++;
+	}
+
+	return !in_module && start == std::string::npos && file_stack.empty();
+}
+
 struct VerilogFrontend : public Frontend {
 	VerilogFrontend() : Frontend("verilog", "read modules from Verilog file") { }
 	void help() override
@@ -177,6 +743,15 @@ struct VerilogFrontend : public Frontend {
 		log("        modules with the (* whitebox *) attribute will be preserved.\n");
 		log("        (* lib_whitebox *) will be treated like (* whitebox *).\n");
 		log("\n");
+		log("    -lazy\n");
+		log("        only index the modules declared in the file, and read each module\n");
+		log("        when 'hierarchy' finds the first cell that instantiates it. This is\n");
+		log("        meant for large cell libraries that are read with -lib, of which a\n");
+		log("        design only uses a few cells. Modules that are only instantiated by\n");
+		log("        later passes (e.g. techmap) must be read without -lazy. Files that\n");
+		log("        declare anything other than modules at the top level (such as\n");
+		log("        packages) are read as usual.\n");
+		log("\n");
 		log("    -nowb\n");
 		log("        delete (* whitebox *) and (* lib_whitebox *) attributes from\n");
 		log("        all modules.\n");
@@ -221,6 +796,29 @@ struct VerilogFrontend : public Frontend {
 		log("        add 'dir' to the directories which are used when searching include\n");
 		log("        files\n");
 		log("\n");
+		log("    -cache <dir>\n");
+		log("        keep a cache of the modules read from each file in the given directory\n");
+		log("        and use the cached modules instead of reading the file again, as long\n");
+		log("        as neither the file, the files it includes, the options nor the\n");
+		log("        defined macros have changed. Each file reports a cache hit or miss in\n");
+		log("        the log. Files are only cached if all their modules can be passed\n");
+		log("        between processes with -j (see below) and they neither replace existing\n");
+		log("        modules nor cause warnings. Use 'verilog_defaults -add -cache <dir>' to\n");
+		log("        cache all files.\n");
+		log("\n");
+		log("    -j <N>\n");
+		log("        when reading more than one file, read up to N files in parallel in\n");
+		log("        worker processes. The modules are added to the design in the order of\n");
+		log("        the files. Every file is read against the design as it was before\n");
+		log("        this command, so packages and global declarations used by other\n");
+		log("        files must be read by an earlier command. Files that can't be read\n");
+		log("        independently are read again one after another instead: files that\n");
+		log("        declare packages, global declarations or bind directives, modules\n");
+		log("        with interfaces, modules that are also declared by an earlier file\n");
+		log("        of this command, and files that use a macro that an earlier file of\n");
+		log("        this command defines or undefines. Files that mention interfaces are\n");
+		log("        read one after another right away.\n");
+		log("\n");
 		log("The command 'verilog_defaults' can be used to register default options for\n");
 		log("subsequent calls to 'read_verilog'.\n");
 		log("\n");
@@ -237,6 +835,156 @@ struct VerilogFrontend : public Frontend {
 		log("supported by the Yosys Verilog front-end.\n");
 		log("\n");
 	}
+	// Set in the worker processes of read_verilog -j.
+	bool in_worker_job = false;
+	std::set<std::string> *macro_lookups = nullptr;
+
+	void read_file(std::vector<std::string> args, const std::string &filename, RTLIL::Design *design)
+	{
+		std::istream *f = nullptr;
+		args.push_back(filename);
+		execute(f, std::string(), args, design);
+		delete f;
+	}
+
+	// Runs in a worker process: read the file and return the new modules as binary RTLIL, together with everything
+	// else the main process needs to know to merge them, or an empty string if the file has to be read again by the
+	// main process instead.
+	std::string read_file_job(const std::vector<std::string> &args, const std::string &filename, RTLIL::Design *design)
+	{
+		VerilogReadSnapshot snapshot(design);
+		std::set<std::string> lookups;
+
+		in_worker_job = true;
+		macro_lookups = &lookups;
+		read_file(args, filename, design);
+
+		if (snapshot.changed_declarations(design))
+			return std::string();
+		for (auto name : snapshot.new_modules(design))
+			if (!module_transferable(design->module(name)))
+				return std::string();
+
+		std::vector<std::string> input_files;
+		for (auto &name : yosys_input_files)
+			if (!snapshot.input_files.count(name))
+				input_files.push_back(name);
+
+		std::string data;
+		append_field(data, join_lines(snapshot.removed_modules(design)));
+		append_field(data, join_lines(lookups));
+		append_field(data, join_lines(input_files));
+		data += snapshot.dump_changes(design);
+		return data;
+	}
+
+	void read_files_parallel(const std::vector<std::string> &args, const std::vector<std::string> &filenames, int num_workers, RTLIL::Design *design)
+	{
+		// Names of the modules and macros changed by the files read so far. A later file that was read by a worker
+		// must be read again if it depends on them.
+		pool<RTLIL::IdString> changed_modules;
+		std::set<std::string> changed_macros;
+		bool changed_declarations = false;
+
+		auto job = [&](int idx) {
+			if (mentions_interfaces(filenames[idx]))
+				return std::string();
+			return read_file_job(args, filenames[idx], design);
+		};
+
+		auto done = [&](int idx, WorkerResult &result) {
+			const std::string &filename = filenames[idx];
+			bool use_result = result.ok && !result.data.empty() && !changed_declarations;
+
+			std::string removed, lookups, input_files;
+			VerilogReadChanges changes;
+			size_t pos = 0;
+			if (use_result) {
+				bool ok = next_field(result.data, pos, removed) && next_field(result.data, pos, lookups) &&
+						next_field(result.data, pos, input_files);
+				log_assert(ok);
+				for (auto &name : split_lines(lookups))
+					if (changed_macros.count(name))
+						use_result = false;
+				for (auto &name : split_lines(removed))
+					if (changed_modules.count(name))
+						use_result = false;
+			}
+			if (use_result) {
+				bool ok = changes.load(result.data, pos, filename);
+				log_assert(ok);
+				for (auto &it : changes.modules->modules_)
+					if (changed_modules.count(it.first))
+						use_result = false;
+			}
+
+			if (!use_result) {
+				VerilogReadSnapshot snapshot(design);
+				read_file(args, filename, design);
+				for (auto name : snapshot.new_modules(design))
+					changed_modules.insert(name);
+				for (auto &name : snapshot.changed_defines(design))
+					changed_macros.insert(name);
+				changed_declarations |= snapshot.changed_declarations(design);
+				return;
+			}
+
+			log_header(design, "Executing Verilog-2005 frontend: %s\n", filename.c_str());
+			result.replay_log();
+
+			for (auto &name : split_lines(removed))
+				if (design->has(name))
+					design->remove(design->module(name));
+			for (auto &it : changes.modules->modules_)
+				changed_modules.insert(it.first);
+			for (auto &name : changes.undefined)
+				changed_macros.insert(name);
+			for (auto &it : changes.defines.defines)
+				changed_macros.insert(it.first);
+			changes.apply(design);
+
+			for (auto &name : split_lines(input_files))
+				yosys_input_files.insert(name);
+		};
+
+		run_worker_jobs(GetSize(filenames), num_workers, job, done);
+	}
+
+	// Add the modules found by split_modules() to the lazy modules of the design. They are read from the preprocessed
+	// source with the options of this command, except for the defaults (which are added again) and -lazy.
+	void index_lazy_modules(const std::vector<std::string> &args, size_t argidx, const std::string &filename,
+			const std::vector<std::pair<RTLIL::IdString, std::string>> &modules, RTLIL::Design *design)
+	{
+		std::vector<std::string> frontend_args = {frontend_name};
+		for (size_t i = 1 + verilog_defaults.size(); i < argidx; i++) {
+			if (args[i] == "-lazy" || args[i] == "-ppdump")
+				continue;
+			if (args[i] == "-j" || args[i] == "-cache") {
+				i++;
+				continue;
+			}
+			frontend_args.push_back(args[i]);
+		}
+		frontend_args.push_back("-nopp");
+
+		std::vector<RTLIL::IdString> existing;
+		for (auto &it : modules) {
+			auto lazy = std::make_shared<RTLIL::LazyModule>();
+			lazy->frontend_args = frontend_args;
+			lazy->filename = filename;
+			lazy->source = it.second;
+			design->lazy_modules_[it.first] = lazy;
+			if (design->has(it.first))
+				existing.push_back(it.first);
+		}
+
+		log("Indexed %d modules to be read when they are first used.\n", GetSize(modules));
+
+		// Modules that replace (or are ignored in favor of) modules already in the design are read right away.
+		for (auto &name : existing)
+			design->load_lazy_module(name);
+	}
+
 	void execute(std::istream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		bool flag_nodisplay = false;
@@ -252,6 +1000,7 @@ struct VerilogFrontend : public Frontend {
 		bool flag_mem2reg = false;
 		bool flag_ppdump = false;
 		bool flag_nopp = false;
+		bool flag_lazy = false;
 		bool flag_nodpi = false;
 		bool flag_noopt = false;
 		bool flag_icells = false;
@@ -262,6 +1011,8 @@ struct VerilogFrontend : public Frontend {
 		bool flag_noblackbox = false;
 		bool flag_nowb = false;
 		bool flag_nosynthesis = false;
+		int num_workers = 0;
+		std::string cache_dir;
 		define_map_t defines_map;
 
 		std::list<std::string> include_dirs;
@@ -393,6 +1144,10 @@ struct VerilogFrontend : public Frontend {
 				defines_map.add("BLACKBOX", "");
 				continue;
 			}
+			if (arg == "-lazy") {
+				flag_lazy = true;
+				continue;
+			}
 			if (arg == "-nowb") {
 				flag_nowb = true;
 				continue;
@@ -462,15 +1217,91 @@ struct VerilogFrontend : public Frontend {
 				include_dirs.push_back(arg.substr(2));
 				continue;
 			}
+			if (arg == "-j" && argidx+1 < args.size()) {
+				num_workers = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (arg == "-cache" && argidx+1 < args.size()) {
+				cache_dir = args[++argidx];
+				continue;
+			}
 			break;
 		}
 
 		if (formal_mode || !flag_nosynthesis)
 			defines_map.add(formal_mode ? "FORMAL" : "SYNTHESIS", "1");
 
+		if (num_workers > 1 && f == nullptr && !flag_defer && !flag_lazy)
+		{
+			std::vector<std::string> filenames;
+			bool parallel = true;
+			for (size_t i = argidx; i < args.size(); i++) {
+				std::string filename = args[i];
+				if (filename.compare(0, 1, "-") == 0 || filename.compare(0, 2, "<<") == 0) {
+					parallel = false;
+					break;
+				}
+				rewrite_filename(filename);
+				for (auto &name : glob_filename(filename))
+					filenames.push_back(name);
+			}
+
+			if (parallel && GetSize(filenames) > 1) {
+				// The options for reading a single file, without the defaults (which get added again) and -j.
+				std::vector<std::string> file_args = {args[0]};
+				for (size_t i = 1 + verilog_defaults.size(); i < argidx; i++) {
+					if (args[i] == "-j") {
+						i++;
+						continue;
+					}
+					file_args.push_back(args[i]);
+				}
+				read_files_parallel(file_args, filenames, num_workers, design);
+				return;
+			}
+		}
+
+		// The options that affect the result of reading a file, for the cache key.
+		std::vector<std::string> cache_key_args;
+		for (size_t i = 1; i < argidx; i++) {
+			if (args[i] == "-j" || args[i] == "-cache") {
+				i++;
+				continue;
+			}
+			cache_key_args.push_back(args[i]);
+		}
+
+		bool opened_file = f == nullptr;
 		extra_args(f, filename, args, argidx);
 
-		log_header(design, "Executing Verilog-2005 frontend: %s\n", filename.c_str());
+		if (!in_worker_job)
+			log_header(design, "Executing Verilog-2005 frontend: %s\n", filename.c_str());
+
+		// Modules are only read lazily from files, not when another command (or loading a lazy module) passes a stream.
+		flag_lazy = flag_lazy && opened_file;
+
+		bool use_cache = !cache_dir.empty() && opened_file && !flag_lazy && check_file_exists(filename) && !flag_nooverwrite && !flag_defer &&
+				!flag_ppdump && !flag_dump_ast1 && !flag_dump_ast2 && !flag_dump_vlog1 && !flag_dump_vlog2 && !flag_dump_rtlil &&
+				design->verilog_packages.empty() && design->verilog_globals.empty();
+		std::string cache_file;
+		std::unique_ptr<VerilogReadSnapshot> cache_snapshot;
+		std::vector<std::string> included_files;
+		std::set<std::string> lookups;
+
+		if (use_cache) {
+			SHA1 key;
+			key.update(stringf("%s\n", yosys_version_str));
+			for (auto &arg : cache_key_args)
+				key.update(arg + "\n");
+			key.update(filename + "\n" + SHA1::from_file(filename) + "\n");
+			key.update(design->verilog_defines->serialize());
+			cache_file = stringf("%s/%s.cache", cache_dir.c_str(), key.final().c_str());
+			if (load_cache_entry(cache_file, filename, design, macro_lookups)) {
+				log("Successfully finished Verilog frontend.\n");
+				return;
+			}
+			cache_snapshot.reset(new VerilogReadSnapshot(design));
+		}
 
 		log("Parsing %s%s input from `%s' to AST representation.\n",
 				formal_mode ? "formal " : "", sv_mode ? "SystemVerilog" : "Verilog", filename.c_str());
@@ -485,12 +1316,31 @@ struct VerilogFrontend : public Frontend {
 		std::string code_after_preproc;
 
 		if (!flag_nopp) {
-			code_after_preproc = frontend_verilog_preproc(*f, filename, defines_map, *design->verilog_defines, include_dirs);
+			code_after_preproc = frontend_verilog_preproc(*f, filename, defines_map, *design->verilog_defines, include_dirs,
+					(use_cache || macro_lookups) ? &lookups : nullptr, &included_files);
 			if (flag_ppdump)
 				log("-- Verilog code after preprocessor --\n%s-- END OF DUMP --\n", code_after_preproc.c_str());
 			lexin = new std::istringstream(code_after_preproc);
 		}
 
+		if (flag_lazy) {
+			if (flag_nopp)
+				code_after_preproc.assign(std::istreambuf_iterator<char>(*f), std::istreambuf_iterator<char>());
+			std::vector<std::pair<RTLIL::IdString, std::string>> modules;
+			if (split_modules(code_after_preproc, filename, modules)) {
+				if (!flag_nopp)
+					delete lexin;
+				delete current_ast;
+				current_ast = NULL;
+				index_lazy_modules(args, argidx, filename, modules, design);
+				log("Successfully finished Verilog frontend.\n");
+				return;
+			}
+			log("Reading all modules because the file declares more than modules at the top level.\n");
+			if (flag_nopp)
+				lexin = new std::istringstream(code_after_preproc);
+		}
+
 		// make package typedefs available to parser
 		add_package_types(pkg_user_types, design->verilog_packages);
 
@@ -526,7 +1376,7 @@ struct VerilogFrontend : public Frontend {
 				flag_nomeminit, flag_nomem2reg, flag_mem2reg, flag_noblackbox, lib_mode, flag_nowb, flag_noopt, flag_icells, flag_pwires, flag_nooverwrite, flag_overwrite, flag_defer, default_nettype_wire);
 
 
-		if (!flag_nopp)
+		if (!flag_nopp || flag_lazy)
 			delete lexin;
 
 		// only the previous and new global type maps remain
@@ -536,6 +1386,11 @@ struct VerilogFrontend : public Frontend {
 		delete current_ast;
 		current_ast = NULL;
 
+		if (macro_lookups)
+			macro_lookups->insert(lookups.begin(), lookups.end());
+		if (use_cache)
+			store_cache_entry(cache_file, *cache_snapshot, included_files, lookups, design);
+
 		log("Successfully finished Verilog frontend.\n");
 	}
 } VerilogFrontend;
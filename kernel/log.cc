@@ -59,6 +59,8 @@ bool log_quiet_warnings = false;
 int log_verbose_level;
 string log_last_error;
 void (*log_error_atexit)() = NULL;
+void (*log_warning_forward)(const std::string &prefix, const std::string &message) = NULL;
+void (*log_header_forward)(const std::string &message) = NULL;
 void (*log_verific_callback)(int msg_type, const char *message_id, const char* file_path, unsigned int left_line, unsigned int left_col, unsigned int right_line, unsigned int right_col, const char *msg) = NULL;
 
 int log_make_debug = 0;
@@ -205,6 +207,11 @@ void logv(const char *format, va_list ap)
 
 void logv_header(RTLIL::Design *design, const char *format, va_list ap)
 {
+	if (log_header_forward) {
+		log_header_forward(vstringf(format, ap));
+		return;
+	}
+
 	bool pop_errfile = false;
 
 	log_spacer();
@@ -248,6 +255,11 @@ static void logv_warning_with_prefix(const char *prefix,
 	std::string message = vstringf(format, ap);
 	bool suppressed = false;
 
+	if (log_warning_forward) {
+		log_warning_forward(prefix, message);
+		return;
+	}
+
 	for (auto &re : log_nowarn_regexes)
 		if (std::regex_search(message, re))
 			suppressed = true;
@@ -308,6 +320,19 @@ void logv_warning_noprefix(const char *format, va_list ap)
 	logv_warning_with_prefix("", format, ap);
 }
 
+static void log_warning_with_prefix_helper(const char *prefix, const char *format, ...)
+{
+	va_list ap;
+	va_start(ap, format);
+	logv_warning_with_prefix(prefix, format, ap);
+	va_end(ap);
+}
+
+void log_warning_with_prefix(const std::string &prefix, const std::string &message)
+{
+	log_warning_with_prefix_helper(prefix.c_str(), "%s", message.c_str());
+}
+
 void log_file_warning(const std::string &filename, int lineno,
                       const char *format, ...)
 {
@@ -114,6 +114,8 @@ extern bool log_quiet_warnings;
 extern int log_verbose_level;
 extern string log_last_error;
 extern void (*log_error_atexit)();
+extern void (*log_warning_forward)(const std::string &prefix, const std::string &message);
+extern void (*log_header_forward)(const std::string &message);
 
 extern int log_make_debug;
 extern int log_force_debug;
@@ -123,6 +125,7 @@ void logv(const char *format, va_list ap);
 void logv_header(RTLIL::Design *design, const char *format, va_list ap);
 void logv_warning(const char *format, va_list ap);
 void logv_warning_noprefix(const char *format, va_list ap);
+void log_warning_with_prefix(const std::string &prefix, const std::string &message);
 [[noreturn]] void logv_error(const char *format, va_list ap);
 [[noreturn]] void logv_file_error(const string &filename, int lineno, const char *format, va_list ap);
 
@@ -38,6 +38,22 @@ int QuickConeSat::importSigBit(SigBit bit)
 
 void QuickConeSat::prepare()
 {
+	int64_t import_begin = PerformanceTimer::query();
+	pool<RTLIL::Cell*> visited, imported_now, reused;
+
+	auto queue_inputs = [&](RTLIL::Cell *cell) {
+		if (changed_cells.count(cell)) {
+			// ModWalker doesn't know about the change
+			for (auto &conn : cell->connections())
+				if (cell->input(conn.first))
+					for (auto bit : modwalker.sigmap(conn.second))
+						bits_queue.insert(bit);
+		} else {
+			auto &inputs = modwalker.cell_inputs[cell];
+			bits_queue.insert(inputs.begin(), inputs.end());
+		}
+	};
+
 	while (!bits_queue.empty())
 	{
 		pool<ModWalker::PortBit> portbits;
@@ -58,21 +74,130 @@ void QuickConeSat::prepare()
 
 		for (auto &pbit : portbits)
 		{
-			if (imported_cells.count(pbit.cell))
+			if (removed_cells.count(pbit.cell) || !visited.insert(pbit.cell).second)
+				continue;
+			if (imported_cells.count(pbit.cell)) {
+				// A cell further up the cone may have been dropped together with
+				// another cell of its epoch, so the cone is followed through
+				// cells that are still imported as well.
+				reused.insert(pbit.cell);
+				queue_inputs(pbit.cell);
 				continue;
+			}
 			if (cell_complexity(pbit.cell) > max_cell_complexity)
 				continue;
 			if (max_cell_outs && GetSize(modwalker.cell_outputs[pbit.cell]) > max_cell_outs)
 				continue;
-			auto &inputs = modwalker.cell_inputs[pbit.cell];
-			bits_queue.insert(inputs.begin(), inputs.end());
+			queue_inputs(pbit.cell);
+			if (current_epoch < 0 || GetSize(epoch_cells[current_epoch]) >= epoch_size) {
+				current_epoch = GetSize(epoch_literals);
+				epoch_literals.push_back(ez->frozen_literal());
+				epoch_cells.emplace_back();
+			}
+			ez->set_assume_guard(epoch_literals[current_epoch]);
 			satgen.importCell(pbit.cell);
-			imported_cells.insert(pbit.cell);
+			ez->set_assume_guard(0);
+			imported_cells[pbit.cell] = current_epoch;
+			epoch_cells[current_epoch].push_back(pbit.cell);
+			imported_now.insert(pbit.cell);
 		}
 
 		if (max_cell_count && GetSize(imported_cells) > max_cell_count)
 			break;
 	}
+
+	stat_imported += GetSize(imported_now);
+	stat_reused += GetSize(reused);
+	stat_import_ns += PerformanceTimer::query() - import_begin;
+}
+
+bool QuickConeSat::solve(const std::vector<int> &modelExpressions, std::vector<bool> &modelValues, const std::vector<int> &assumptions)
+{
+	std::vector<int> all_assumptions;
+	for (int lit : epoch_literals)
+		if (lit != 0)
+			all_assumptions.push_back(lit);
+	for (int lit : assumptions)
+		if (lit != 0)
+			all_assumptions.push_back(lit);
+
+	int64_t solve_begin = PerformanceTimer::query();
+	bool result = ez->solve(modelExpressions, modelValues, all_assumptions);
+	stat_solve_ns += PerformanceTimer::query() - solve_begin;
+	stat_queries++;
+	return result;
+}
+
+bool QuickConeSat::solve(int a, int b, int c, int d, int e, int f)
+{
+	std::vector<int> modelExpressions;
+	std::vector<bool> modelValues;
+	return solve(modelExpressions, modelValues, {a, b, c, d, e, f});
+}
+
+int QuickConeSat::add_constraint(int expr)
+{
+	int lit = ez->frozen_literal();
+	ez->assume(expr, lit);
+	return lit;
+}
+
+void QuickConeSat::invalidate(RTLIL::Cell *cell)
+{
+	auto it = imported_cells.find(cell);
+	if (it == imported_cells.end())
+		return;
+
+	int epoch = it->second;
+	for (auto epoch_cell : epoch_cells[epoch])
+		imported_cells.erase(epoch_cell);
+	stat_invalidated += GetSize(epoch_cells[epoch]);
+	epoch_cells[epoch].clear();
+
+	// The retired literal must be forced to false, otherwise the solver
+	// could still enable the stale constraints of this epoch.
+	int guard = ez->assume_guard();
+	ez->set_assume_guard(0);
+	ez->assume(ez->NOT(epoch_literals[epoch]));
+	ez->set_assume_guard(guard);
+	epoch_literals[epoch] = 0;
+
+	if (epoch == current_epoch)
+		current_epoch = -1;
+}
+
+void QuickConeSat::log_stats(const char *prefix)
+{
+	if (stat_queries == 0)
+		return;
+
+	int lookups = stat_imported + stat_reused;
+	double import_ms = stat_import_ns / 1e6;
+	double saved_ms = stat_imported ? import_ms * stat_reused / stat_imported : 0;
+	log("%sSAT cone cache: %d queries, %d cells imported, %d reused (%.1f%% hit rate), %d invalidated.\n",
+			prefix, stat_queries, stat_imported, stat_reused, lookups ? 100.0 * stat_reused / lookups : 0.0, stat_invalidated);
+	log("%sSAT cone cache: %.2f ms importing (about %.2f ms saved by reuse), %.2f ms solving.\n",
+			prefix, import_ms, saved_ms, stat_solve_ns / 1e6);
+}
+
+void QuickConeSat::notify_connect(RTLIL::Cell *cell, const RTLIL::IdString &port, const RTLIL::SigSpec&, const RTLIL::SigSpec &sig)
+{
+	// Module::remove() unsets all ports before deleting the cell.
+	if (sig.empty() && GetSize(cell->connections()) == 1 && cell->hasPort(port))
+		removed_cells.insert(cell);
+	else
+		changed_cells.insert(cell);
+	invalidate(cell);
+}
+
+void QuickConeSat::notify_blackout(RTLIL::Module*)
+{
+	for (auto &it : modwalker.cell_inputs)
+		removed_cells.insert(it.first);
+	for (auto &it : modwalker.cell_outputs)
+		removed_cells.insert(it.first);
+	while (!imported_cells.empty())
+		invalidate(imported_cells.begin()->first);
 }
 
 int QuickConeSat::cell_complexity(RTLIL::Cell *cell)
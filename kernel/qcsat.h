@@ -33,7 +33,17 @@ YOSYS_NAMESPACE_BEGIN
 // skipped and the solver spuriously returns SAT with a solution that
 // cannot exist in reality due to skipped constraints (ie. only UNSAT results
 // from this class should be considered binding).
-struct QuickConeSat {
+//
+// One instance can be kept for a whole module and answer many queries: the
+// cones imported for earlier queries are reused, and the solver keeps what
+// it learned.  The instance watches the module, and cells that are changed
+// or removed after they were imported are dropped from the model.  For this
+// the imported cells are grouped into epochs, each with an activation
+// literal that guards the constraints of its cells; dropping a cell retires
+// the activation literal of its epoch, and the other cells of that epoch are
+// imported again when a later query needs them.  Queries must therefore be
+// made through solve() below, not by calling ez->solve() directly.
+struct QuickConeSat : public RTLIL::Monitor {
 	ModWalker &modwalker;
 	ezSatPtr ez;
 	SatGen satgen;
@@ -50,13 +60,34 @@ struct QuickConeSat {
 	int max_cell_count = 0;
 	// If non-0, skip importing cells with more than this number of output bits.
 	int max_cell_outs = 0;
+	// The number of cells imported under one activation literal.
+	int epoch_size = 256;
 
 	// Internal state.
-	pool<RTLIL::Cell*> imported_cells;
+	dict<RTLIL::Cell*, int> imported_cells;
 	pool<RTLIL::Wire*> imported_onehot;
 	pool<RTLIL::SigBit> bits_queue;
+	std::vector<int> epoch_literals;
+	std::vector<std::vector<RTLIL::Cell*>> epoch_cells;
+	int current_epoch = -1;
+	pool<RTLIL::Cell*> changed_cells, removed_cells;
 
-	QuickConeSat(ModWalker &modwalker) : modwalker(modwalker), ez(), satgen(ez.get(), &modwalker.sigmap) {}
+	// Statistics.
+	int stat_queries = 0;
+	int stat_imported = 0;
+	int stat_reused = 0;
+	int stat_invalidated = 0;
+	int64_t stat_import_ns = 0;
+	int64_t stat_solve_ns = 0;
+
+	QuickConeSat(ModWalker &modwalker) : modwalker(modwalker), ez(), satgen(ez.get(), &modwalker.sigmap) {
+		log_assert(modwalker.module != nullptr);
+		modwalker.module->monitors.insert(this);
+	}
+
+	~QuickConeSat() {
+		modwalker.module->monitors.erase(this);
+	}
 
 	// Imports a signal into the SAT solver, queues its input cone to be
 	// imported in the next prepare() call.
@@ -67,8 +98,27 @@ struct QuickConeSat {
 	// the SAT solver.
 	void prepare();
 
+	// Solves with the given assumptions (0 for none) and the activation
+	// literals of all imported cells, optionally returning a model.
+	bool solve(int a = 0, int b = 0, int c = 0, int d = 0, int e = 0, int f = 0);
+	bool solve(const std::vector<int> &modelExpressions, std::vector<bool> &modelValues, const std::vector<int> &assumptions = std::vector<int>());
+
+	// Returns a fresh activation literal for a constraint: the constraint
+	// only holds in queries that pass the returned literal to solve().
+	int add_constraint(int expr);
+
+	// Drops a cell (and the rest of its epoch) from the model.
+	void invalidate(RTLIL::Cell *cell);
+
+	// Logs how many cells were reused from earlier queries, if any query
+	// was made.
+	void log_stats(const char *prefix = "");
+
 	// Returns the "complexity level" of a given cell.
 	static int cell_complexity(RTLIL::Cell *cell);
+
+	void notify_connect(RTLIL::Cell *cell, const RTLIL::IdString &port, const RTLIL::SigSpec &old_sig, const RTLIL::SigSpec &sig) override;
+	void notify_blackout(RTLIL::Module *module) override;
 };
 
 YOSYS_NAMESPACE_END
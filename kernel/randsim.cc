@@ -0,0 +1,397 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/randsim.h"
+#include "kernel/celltypes.h"
+
+USING_YOSYS_NAMESPACE
+
+RandomSim::RandomSim(RTLIL::Module *module, const SigMap &sigmap, int num_words) : num_words(num_words), sigmap(sigmap)
+{
+	auto index = [&](RTLIL::SigBit bit) {
+		if (bit.wire == nullptr)
+			return -1;
+		auto it = bit_index.find(bit);
+		if (it != bit_index.end())
+			return it->second;
+		int idx = GetSize(bit_index);
+		bit_index[bit] = idx;
+		return idx;
+	};
+
+	for (auto wire : module->wires())
+		for (auto bit : sigmap(wire))
+			index(bit);
+
+	// Cells of unknown types don't drive anything, i.e. their outputs are
+	// free like in SatGen. Other cells that can't be evaluated drive
+	// unknown values.
+	pool<int> driven;
+	std::vector<RTLIL::Cell*> cells;
+	for (auto cell : module->cells())
+	{
+		for (auto &conn : cell->connections())
+			for (auto bit : sigmap(conn.second))
+				index(bit);
+
+		if (!yosys_celltypes.cell_known(cell->type))
+			continue;
+
+		if (RTLIL::builtin_ff_cell_types().count(cell->type) || cell->type == ID($anyinit))
+			ffs.push_back(FfData(nullptr, cell));
+		else if (cell->type.in(ID($anyconst), ID($anyseq), ID($allconst), ID($allseq), ID($initstate)))
+			source_cells.push_back(cell);
+		else if (cell->hasPort(ID::Y) && yosys_celltypes.cell_evaluable(cell->type))
+			cells.push_back(cell);
+
+		for (auto &conn : cell->connections())
+			if (cell->output(conn.first))
+				for (auto bit : sigmap(conn.second))
+					if (bit.wire != nullptr)
+						driven.insert(bit_index.at(bit));
+	}
+
+	for (auto &it : bit_index)
+		if (!driven.count(it.second))
+			free_bits.push_back(it.second);
+
+	// Sort the combinational cells topologically. Cells on loops are left
+	// out, so the bits they drive stay unknown.
+	dict<int, int> driver;
+	for (int i = 0; i < GetSize(cells); i++)
+		for (auto bit : sigmap(cells[i]->getPort(ID::Y)))
+			if (bit.wire != nullptr)
+				driver[bit_index.at(bit)] = i;
+
+	std::vector<std::vector<int>> fanout(GetSize(cells));
+	std::vector<int> pending(GetSize(cells));
+	for (int i = 0; i < GetSize(cells); i++) {
+		pool<int> deps;
+		for (auto &conn : cells[i]->connections())
+			if (cells[i]->input(conn.first))
+				for (auto bit : sigmap(conn.second))
+					if (bit.wire != nullptr && driver.count(bit_index.at(bit)))
+						deps.insert(driver.at(bit_index.at(bit)));
+		for (int dep : deps)
+			fanout[dep].push_back(i);
+		pending[i] = GetSize(deps);
+	}
+
+	std::vector<int> queue;
+	for (int i = 0; i < GetSize(cells); i++)
+		if (pending[i] == 0)
+			queue.push_back(i);
+	for (int pos = 0; pos < GetSize(queue); pos++) {
+		comb_cells.push_back(cells[queue[pos]]);
+		for (int next : fanout[queue[pos]])
+			if (--pending[next] == 0)
+				queue.push_back(next);
+	}
+}
+
+uint64_t RandomSim::random_word()
+{
+	// xorshift64*
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return rng_state * 2685821657736338717ULL;
+}
+
+void RandomSim::get(RTLIL::SigBit bit, int word, uint64_t &v, uint64_t &d, bool prev) const
+{
+	v = 0, d = 0;
+	if (bit.wire == nullptr) {
+		if (bit.data == State::S1)
+			v = ~0ULL;
+		if (bit.data == State::S0 || bit.data == State::S1)
+			d = ~0ULL;
+		return;
+	}
+
+	auto it = bit_index.find(bit);
+	const std::vector<uint64_t> &vals = prev ? prev_val : val, &defs = prev ? prev_def : def;
+	if (it == bit_index.end() || size_t(it->second) * num_words + word >= vals.size())
+		return;
+	v = vals[size_t(it->second) * num_words + word];
+	d = defs[size_t(it->second) * num_words + word];
+}
+
+void RandomSim::set(RTLIL::SigBit bit, int word, uint64_t v, uint64_t d)
+{
+	if (bit.wire == nullptr)
+		return;
+	size_t pos = size_t(bit_index.at(bit)) * num_words + word;
+	val[pos] = v & d;
+	def[pos] = d;
+}
+
+uint64_t RandomSim::value(RTLIL::SigBit bit, int word) const
+{
+	uint64_t v, d;
+	get(sigmap(bit), word, v, d);
+	return v;
+}
+
+uint64_t RandomSim::known(RTLIL::SigBit bit, int word) const
+{
+	uint64_t v, d;
+	get(sigmap(bit), word, v, d);
+	return d;
+}
+
+void RandomSim::run(int num_frames)
+{
+	size_t size = bit_index.size() * num_words;
+	for (int frame = 0; frame < num_frames; frame++)
+	{
+		prev_val.swap(val);
+		prev_def.swap(def);
+		val.assign(size, 0);
+		def.assign(size, 0);
+
+		for (int idx : free_bits)
+			for (int w = 0; w < num_words; w++) {
+				val[size_t(idx) * num_words + w] = random_word();
+				def[size_t(idx) * num_words + w] = ~0ULL;
+			}
+
+		// SatGen keeps $initstate at 0 unless told otherwise.
+		for (auto cell : source_cells)
+			for (auto bit : sigmap(cell->getPort(ID::Y)))
+				for (int w = 0; w < num_words; w++) {
+					uint64_t v, d;
+					if (cell->type == ID($initstate))
+						set(bit, w, 0, ~0ULL);
+					else if (frame > 0 && cell->type.in(ID($anyconst), ID($allconst)))
+						get(bit, w, v, d, true), set(bit, w, v, d);
+					else
+						set(bit, w, random_word(), ~0ULL);
+				}
+
+		for (auto &ff : ffs)
+			update_ff(ff, frame == 0);
+
+		for (auto &it : fixed_values)
+			for (int w = 0; w < num_words && w < GetSize(it.second); w++)
+				set(sigmap(it.first), w, it.second[w], ~0ULL);
+
+		for (auto cell : comb_cells)
+			if (!eval_bitwise(cell))
+				eval_lanes(cell);
+	}
+}
+
+void RandomSim::update_ff(const FfData &ff, bool first_frame)
+{
+	RTLIL::SigSpec sig_q = sigmap(ff.sig_q);
+
+	if (first_frame) {
+		for (auto bit : sig_q)
+			for (int w = 0; w < num_words; w++)
+				set(bit, w, random_word(), ~0ULL);
+		return;
+	}
+
+	// SatGen has no model for latches and FFs with async inputs.
+	if (ff.has_aload || ff.has_arst || ff.has_sr)
+		return;
+
+	RTLIL::SigSpec sig_d = sigmap(ff.sig_d);
+	RTLIL::SigBit sig_srst = ff.has_srst ? sigmap(ff.sig_srst).as_bit() : RTLIL::SigBit(State::S0);
+	RTLIL::SigBit sig_ce = ff.has_ce ? sigmap(ff.sig_ce).as_bit() : RTLIL::SigBit(State::S1);
+
+	for (int i = 0; i < GetSize(sig_q); i++)
+	for (int w = 0; w < num_words; w++)
+	{
+		uint64_t v, d;
+		get(sig_d[i], w, v, d, true);
+
+		auto apply_srst = [&]() {
+			uint64_t s, ds;
+			get(sig_srst, w, s, ds, true);
+			if (!ff.pol_srst)
+				s = ~s;
+			State rval = ff.val_srst[i];
+			uint64_t rv = rval == State::S1 ? ~0ULL : 0;
+			uint64_t rd = rval == State::S0 || rval == State::S1 ? ~0ULL : 0;
+			v = (s & rv) | (~s & v);
+			d = ds & ((s & rd) | (~s & d));
+		};
+
+		if (ff.has_srst && ff.has_ce && ff.ce_over_srst)
+			apply_srst();
+		if (ff.has_ce) {
+			uint64_t c, dc, q, dq;
+			get(sig_ce, w, c, dc, true);
+			get(sig_q[i], w, q, dq, true);
+			if (!ff.pol_ce)
+				c = ~c;
+			v = (c & v) | (~c & q);
+			d = dc & ((c & d) | (~c & dq));
+		}
+		if (ff.has_srst && !(ff.has_ce && ff.ce_over_srst))
+			apply_srst();
+
+		set(sig_q[i], w, v, d);
+	}
+}
+
+// Evaluate a cell that works on every bit separately, all patterns of a word at once.
+bool RandomSim::eval_bitwise(RTLIL::Cell *cell)
+{
+	RTLIL::IdString type = cell->type;
+	bool fine = type.in(ID($_BUF_), ID($_NOT_), ID($_AND_), ID($_NAND_), ID($_OR_), ID($_NOR_), ID($_XOR_), ID($_XNOR_),
+			ID($_ANDNOT_), ID($_ORNOT_), ID($_MUX_), ID($_NMUX_), ID($_AOI3_), ID($_OAI3_), ID($_AOI4_), ID($_OAI4_));
+	bool coarse = type.in(ID($pos), ID($not), ID($and), ID($or), ID($xor), ID($xnor), ID($mux), ID($equiv));
+	if (!fine && !coarse)
+		return false;
+
+	RTLIL::SigSpec sig_y = sigmap(cell->getPort(ID::Y));
+	RTLIL::SigSpec sig_a = sigmap(cell->getPort(ID::A));
+	RTLIL::SigSpec sig_b = cell->hasPort(ID::B) ? sigmap(cell->getPort(ID::B)) : RTLIL::SigSpec();
+	RTLIL::SigSpec sig_c = cell->hasPort(ID::C) ? sigmap(cell->getPort(ID::C)) : RTLIL::SigSpec();
+	RTLIL::SigSpec sig_d = cell->hasPort(ID::D) ? sigmap(cell->getPort(ID::D)) : RTLIL::SigSpec();
+	RTLIL::SigSpec sig_s = cell->hasPort(ID::S) ? sigmap(cell->getPort(ID::S)) : RTLIL::SigSpec();
+	int width = GetSize(sig_y);
+
+	// Cells that extend their inputs are left to eval_lanes().
+	if (GetSize(sig_a) != width || (!sig_b.empty() && GetSize(sig_b) != width) || (!sig_s.empty() && GetSize(sig_s) != 1))
+		return false;
+
+	for (int i = 0; i < width; i++)
+	for (int w = 0; w < num_words; w++)
+	{
+		uint64_t a, da, b = 0, db = ~0ULL, c = 0, dc = ~0ULL, d = 0, dd = ~0ULL, s = 0, ds = ~0ULL;
+		get(sig_a[i], w, a, da);
+		if (!sig_b.empty() && type != ID($equiv))
+			get(sig_b[i], w, b, db);
+		if (!sig_c.empty())
+			get(sig_c[i], w, c, dc);
+		if (!sig_d.empty())
+			get(sig_d[i], w, d, dd);
+		if (!sig_s.empty())
+			get(sig_s[0], w, s, ds);
+
+		uint64_t y;
+		if (type.in(ID($_BUF_), ID($pos), ID($equiv)))
+			y = a;
+		else if (type.in(ID($_NOT_), ID($not)))
+			y = ~a;
+		else if (type.in(ID($_AND_), ID($and)))
+			y = a & b;
+		else if (type == ID($_NAND_))
+			y = ~(a & b);
+		else if (type.in(ID($_OR_), ID($or)))
+			y = a | b;
+		else if (type == ID($_NOR_))
+			y = ~(a | b);
+		else if (type.in(ID($_XOR_), ID($xor)))
+			y = a ^ b;
+		else if (type.in(ID($_XNOR_), ID($xnor)))
+			y = ~(a ^ b);
+		else if (type == ID($_ANDNOT_))
+			y = a & ~b;
+		else if (type == ID($_ORNOT_))
+			y = a | ~b;
+		else if (type.in(ID($_MUX_), ID($mux)))
+			y = (a & ~s) | (b & s);
+		else if (type == ID($_NMUX_))
+			y = ~((a & ~s) | (b & s));
+		else if (type == ID($_AOI3_))
+			y = ~((a & b) | c);
+		else if (type == ID($_OAI3_))
+			y = ~((a | b) & c);
+		else if (type == ID($_AOI4_))
+			y = ~((a & b) | (c & d));
+		else
+			y = ~((a | b) & (c | d));
+
+		set(sig_y[i], w, y, da & db & dc & dd & ds);
+	}
+	return true;
+}
+
+// Evaluate any other cell with CellTypes::eval(), one pattern at a time.
+void RandomSim::eval_lanes(RTLIL::Cell *cell)
+{
+	RTLIL::IdString type = cell->type;
+	bool with_s = type.in(ID($mux), ID($pmux), ID($bwmux), ID($bmux), ID($demux));
+	if (cell->hasPort(ID::C) || cell->hasPort(ID::D) || (cell->hasPort(ID::S) && !with_s))
+		return;
+
+	RTLIL::SigSpec sig_y = sigmap(cell->getPort(ID::Y));
+	std::vector<RTLIL::SigSpec> sig_args;
+	sig_args.push_back(cell->hasPort(ID::A) ? sigmap(cell->getPort(ID::A)) : RTLIL::SigSpec());
+	if (type.in(ID($bmux), ID($demux)))
+		sig_args.push_back(sigmap(cell->getPort(ID::S)));
+	else {
+		sig_args.push_back(cell->hasPort(ID::B) ? sigmap(cell->getPort(ID::B)) : RTLIL::SigSpec());
+		if (with_s)
+			sig_args.push_back(sigmap(cell->getPort(ID::S)));
+	}
+
+	std::vector<std::vector<uint64_t>> arg_vals(GetSize(sig_args)), arg_defs(GetSize(sig_args));
+	std::vector<RTLIL::Const> args(GetSize(sig_args));
+	std::vector<uint64_t> y_vals(GetSize(sig_y)), y_defs(GetSize(sig_y));
+
+	for (int w = 0; w < num_words; w++)
+	{
+		uint64_t lanes_known = ~0ULL;
+		for (int k = 0; k < GetSize(sig_args); k++) {
+			arg_vals[k].resize(GetSize(sig_args[k]));
+			arg_defs[k].resize(GetSize(sig_args[k]));
+			for (int i = 0; i < GetSize(sig_args[k]); i++) {
+				get(sig_args[k][i], w, arg_vals[k][i], arg_defs[k][i]);
+				lanes_known &= arg_defs[k][i];
+			}
+		}
+
+		std::fill(y_vals.begin(), y_vals.end(), 0);
+		std::fill(y_defs.begin(), y_defs.end(), 0);
+
+		for (int lane = 0; lane < 64; lane++)
+		{
+			if (!((lanes_known >> lane) & 1))
+				continue;
+
+			for (int k = 0; k < GetSize(sig_args); k++) {
+				args[k].bits.resize(GetSize(sig_args[k]));
+				for (int i = 0; i < GetSize(sig_args[k]); i++)
+					args[k].bits[i] = (arg_vals[k][i] >> lane) & 1 ? State::S1 : State::S0;
+			}
+
+			bool err = false;
+			RTLIL::Const y = GetSize(args) == 3 ? CellTypes::eval(cell, args[0], args[1], args[2], &err) :
+					CellTypes::eval(cell, args[0], args[1], &err);
+			if (err || GetSize(y) != GetSize(sig_y))
+				continue;
+
+			for (int i = 0; i < GetSize(sig_y); i++) {
+				if (y.bits[i] == State::S1)
+					y_vals[i] |= 1ULL << lane;
+				if (y.bits[i] == State::S0 || y.bits[i] == State::S1)
+					y_defs[i] |= 1ULL << lane;
+			}
+		}
+
+		for (int i = 0; i < GetSize(sig_y); i++)
+			set(sig_y[i], w, y_vals[i], y_defs[i]);
+	}
+}
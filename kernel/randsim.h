@@ -0,0 +1,81 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef RANDSIM_H
+#define RANDSIM_H
+
+#include "kernel/yosys.h"
+#include "kernel/sigtools.h"
+#include "kernel/ff.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// Word-parallel random simulation of a module, meant for quickly telling
+// signals apart before trying to prove them equal with SAT. Every bit is
+// simulated for 64 random patterns per word at once.
+//
+// Every simulated word comes with a mask of the patterns for which its value
+// is known. Values that depend on x bits, on cells that can't be evaluated or
+// on combinational loops are unknown, so a difference between two known
+// values is a real difference.
+//
+// The module is simulated over a number of time frames, in the same way as
+// SatGen models it: FFs start in random states in the first frame and take
+// the values of their inputs in the previous frame after that. Undriven bits,
+// the outputs of cells of unknown types and $anyseq cells take new random
+// values in every frame.
+struct RandomSim
+{
+	RandomSim(RTLIL::Module *module, const SigMap &sigmap, int num_words = 1);
+
+	// Simulate the given number of time frames with new random patterns.
+	void run(int num_frames = 1);
+
+	// The value of a bit in the last simulated frame, and the mask of the
+	// patterns for which it is known.
+	uint64_t value(RTLIL::SigBit bit, int word) const;
+	uint64_t known(RTLIL::SigBit bit, int word) const;
+
+	int num_words;
+	uint64_t rng_state = 88172645463325252ULL;
+
+	// Values (one per word) used instead of random values for some bits that
+	// are not driven by a combinational cell, e.g. to replay counterexamples.
+	// They are applied in every frame after the FFs are updated.
+	dict<RTLIL::SigBit, std::vector<uint64_t>> fixed_values;
+
+private:
+	const SigMap &sigmap;
+	dict<RTLIL::SigBit, int> bit_index;
+	std::vector<uint64_t> val, def, prev_val, prev_def;
+	std::vector<RTLIL::Cell*> comb_cells, source_cells;
+	std::vector<FfData> ffs;
+	std::vector<int> free_bits;
+
+	uint64_t random_word();
+	void get(RTLIL::SigBit bit, int word, uint64_t &v, uint64_t &d, bool prev = false) const;
+	void set(RTLIL::SigBit bit, int word, uint64_t v, uint64_t d);
+	bool eval_bitwise(RTLIL::Cell *cell);
+	void eval_lanes(RTLIL::Cell *cell);
+	void update_ff(const FfData &ff, bool first_frame);
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
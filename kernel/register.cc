@@ -19,6 +19,7 @@
 
 #include "kernel/yosys.h"
 #include "kernel/satgen.h"
+#include "libs/ezsat/ezportfolio.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -313,6 +314,7 @@ void Pass::call(RTLIL::Design *design, std::vector<std::string> args)
 		log_experimental("%s", args[0].c_str());
 
 	size_t orig_sel_stack_pos = design->selection_stack.size();
+	RTLIL::Design::ReadingOnlyScope reading_only(design, pass_register[args[0]]->read_only_flag);
 	auto state = pass_register[args[0]]->pre_execute();
 	pass_register[args[0]]->execute(args, design);
 	pass_register[args[0]]->post_execute(state);
@@ -987,10 +989,37 @@ struct MinisatSatSolver : public SatSolver {
 		yosys_satsolver = this;
 	}
 	ezSAT *create() override {
-		return new ezMiniSAT();
+		ezMiniSAT *ez = new ezMiniSAT();
+		if (yosys_design)
+			ez->simplifyCnf = yosys_design->scratchpad_get_bool("sat.simplify", true);
+		return ez;
 	}
 } MinisatSatSolver;
 
+struct PortfolioSatSolver : public SatSolver {
+	PortfolioSatSolver() : SatSolver("portfolio") { }
+	ezSAT *create() override {
+		int threads = yosys_design ? yosys_design->scratchpad_get_int("sat.threads", 0) : 0;
+		return new ezPortfolioSAT(threads);
+	}
+} PortfolioSatSolver;
+
+SatSolver *yosys_selected_satsolver()
+{
+	if (yosys_design == nullptr)
+		return yosys_satsolver;
+	std::string name = yosys_design->scratchpad_get_string("sat.solver");
+	if (name.empty())
+		return yosys_satsolver;
+	for (SatSolver *solver = yosys_satsolver_list; solver != nullptr; solver = solver->next)
+		if (solver->name == name)
+			return solver;
+	std::string names;
+	for (SatSolver *solver = yosys_satsolver_list; solver != nullptr; solver = solver->next)
+		names += stringf(" %s", solver->name.c_str());
+	log_cmd_error("Unknown SAT solver `%s' in scratchpad variable sat.solver (available:%s).\n", name.c_str(), names.c_str());
+}
+
 struct LicensePass : public Pass {
 	LicensePass() : Pass("license", "print license terms") { }
 	void help() override
@@ -43,6 +43,14 @@ struct Pass
 		experimental_flag = true;
 	}
 
+	// Commands that only read the design set this, so that they don't copy modules that are shared with saved
+	// designs (see RTLIL::Design::reading_only).
+	bool read_only_flag = false;
+
+	void read_only() {
+		read_only_flag = true;
+	}
+
 	struct pre_post_exec_state_t {
 		Pass *parent_pass;
 		int64_t begin_ns;
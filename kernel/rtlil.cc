@@ -23,6 +23,7 @@
 #include "kernel/binding.h"
 #include "frontends/verilog/verilog_frontend.h"
 #include "frontends/verilog/preproc.h"
+#include "passes/techmap/libparse.h"
 #include "backends/rtlil/rtlil_backend.h"
 
 #include <string.h>
@@ -618,13 +619,14 @@ void RTLIL::Selection::optimize(RTLIL::Design *design)
 }
 
 RTLIL::Design::Design()
-  : verilog_defines (new define_map_t)
+  : verilog_defines (new define_map_t), liberty_cache (new LibertyCache)
 {
 	static unsigned int hashidx_count = 123456789;
 	hashidx_count = mkhash_xorshift(hashidx_count);
 	hashidx_ = hashidx_count;
 
 	refcount_modules_ = 0;
+	num_shared_modules_ = 0;
 	selection_stack.push_back(RTLIL::Selection());
 
 #ifdef WITH_PYTHON
@@ -635,7 +637,7 @@ RTLIL::Design::Design()
 RTLIL::Design::~Design()
 {
 	for (auto &pr : modules_)
-		delete pr.second;
+		release(pr.second);
 	for (auto n : bindings_)
 		delete n;
 	for (auto n : verilog_packages)
@@ -657,12 +659,17 @@ std::map<unsigned int, RTLIL::Design*> *RTLIL::Design::get_all_designs(void)
 
 RTLIL::ObjRange<RTLIL::Module*> RTLIL::Design::modules()
 {
+	if (!reading_only)
+		unshare_all();
 	return RTLIL::ObjRange<RTLIL::Module*>(&modules_, &refcount_modules_);
 }
 
 RTLIL::Module *RTLIL::Design::module(const RTLIL::IdString& name)
 {
-	return modules_.count(name) ? modules_.at(name) : NULL;
+	auto it = modules_.find(name);
+	if (it == modules_.end())
+		return NULL;
+	return reading_only ? it->second : unshare(it->second);
 }
 
 const RTLIL::Module *RTLIL::Design::module(const RTLIL::IdString& name) const
@@ -670,6 +677,27 @@ const RTLIL::Module *RTLIL::Design::module(const RTLIL::IdString& name) const
 	return modules_.count(name) ? modules_.at(name) : NULL;
 }
 
+RTLIL::Module *RTLIL::Design::load_lazy_module(const RTLIL::IdString& name)
+{
+	auto it = lazy_modules_.find(name);
+	if (it == lazy_modules_.end())
+		return nullptr;
+
+	std::shared_ptr<const RTLIL::LazyModule> lazy = it->second;
+	lazy_modules_.erase(it);
+
+	log("Reading module `%s' from `%s'.\n", log_id(name), lazy->filename.c_str());
+	std::istringstream f(lazy->source);
+	Frontend::frontend_call(this, &f, lazy->filename, lazy->frontend_args);
+
+	RTLIL::Module *mod = module(name);
+	if (mod == nullptr)
+		mod = module("$abstract" + name.str());
+	if (mod == nullptr)
+		log_error("Lazily read source from `%s' does not declare module `%s'.\n", lazy->filename.c_str(), log_id(name));
+	return mod;
+}
+
 RTLIL::Module *RTLIL::Design::top_module()
 {
 	RTLIL::Module *module = nullptr;
@@ -690,6 +718,7 @@ void RTLIL::Design::add(RTLIL::Module *module)
 	log_assert(modules_.count(module->name) == 0);
 	log_assert(refcount_modules_ == 0);
 	modules_[module->name] = module;
+	lazy_modules_.erase(module->name);
 	module->design = this;
 
 	for (auto mon : monitors)
@@ -701,6 +730,99 @@ void RTLIL::Design::add(RTLIL::Module *module)
 	}
 }
 
+void RTLIL::Design::add_shared(RTLIL::Module *module)
+{
+	log_assert(module->design != nullptr && module->design != this);
+	log_assert(modules_.count(module->name) == 0);
+	log_assert(refcount_modules_ == 0);
+	modules_[module->name] = module;
+	lazy_modules_.erase(module->name);
+	if (!module->is_shared())
+		module->design->num_shared_modules_++;
+	module->shared_designs_.push_back(this);
+	num_shared_modules_++;
+
+	for (auto mon : monitors)
+		mon->notify_module_add(module);
+}
+
+RTLIL::Module *RTLIL::Design::unshare(RTLIL::Module *module)
+{
+	if (!module->is_shared())
+		return module;
+
+	log_assert(modules_.at(module->name) == module);
+	std::vector<RTLIL::Design*> others = module->shared_designs_;
+	others.push_back(module->design);
+	others.erase(std::find(others.begin(), others.end(), this));
+
+	// The other designs keep sharing the unchanged module among themselves.
+	RTLIL::Module *copy = module->clone();
+	copy->design = others.back();
+	others.pop_back();
+	copy->shared_designs_ = others;
+	others.push_back(copy->design);
+	for (auto other : others) {
+		for (auto mon : other->monitors)
+			mon->notify_module_del(module);
+		other->modules_.at(copy->name) = copy;
+		for (auto mon : other->monitors)
+			mon->notify_module_add(copy);
+	}
+	if (!copy->is_shared())
+		copy->design->num_shared_modules_--;
+
+	module->design = this;
+	module->shared_designs_.clear();
+	num_shared_modules_--;
+
+	if (yosys_xtrace) {
+		log("#X# Unshare Module: %s\n", log_id(module));
+		log_backtrace("-X- ", yosys_xtrace-1);
+	}
+	return module;
+}
+
+void RTLIL::Module::unshare_for_change()
+{
+	RTLIL::Design *keeper = yosys_get_design();
+	if (std::count(shared_designs_.begin(), shared_designs_.end(), keeper) == 0)
+		keeper = design;
+	keeper->unshare(this);
+}
+
+void RTLIL::Design::unshare_all()
+{
+	if (num_shared_modules_ == 0)
+		return;
+	for (auto &it : modules_)
+		if (it.second->is_shared())
+			unshare(it.second);
+	log_assert(num_shared_modules_ == 0);
+}
+
+// Drops this design's hold on a module, and deletes the module if no other design holds it.
+void RTLIL::Design::release(RTLIL::Module *module)
+{
+	if (!module->is_shared()) {
+		log_assert(module->design == this);
+		delete module;
+		return;
+	}
+
+	num_shared_modules_--;
+	if (module->design == this) {
+		module->design = module->shared_designs_.back();
+		module->shared_designs_.pop_back();
+	} else {
+		auto it = std::find(module->shared_designs_.begin(), module->shared_designs_.end(), this);
+		log_assert(it != module->shared_designs_.end());
+		module->shared_designs_.erase(it);
+	}
+	if (!module->is_shared())
+		module->design->num_shared_modules_--;
+}
+
 void RTLIL::Design::add(RTLIL::Binding *binding)
 {
 	log_assert(binding != nullptr);
@@ -807,11 +929,12 @@ void RTLIL::Design::remove(RTLIL::Module *module)
 	log_assert(modules_.at(module->name) == module);
 	log_assert(refcount_modules_ == 0);
 	modules_.erase(module->name);
-	delete module;
+	release(module);
 }
 
 void RTLIL::Design::rename(RTLIL::Module *module, RTLIL::IdString new_name)
 {
+	log_assert(!module->is_shared());
 	modules_.erase(module->name);
 	module->name = new_name;
 	add(module);
@@ -819,6 +942,7 @@ void RTLIL::Design::rename(RTLIL::Module *module, RTLIL::IdString new_name)
 
 void RTLIL::Design::sort()
 {
+	unshare_all();
 	scratchpad.sort();
 	modules_.sort(sort_by_id_str());
 	for (auto &it : modules_)
@@ -829,7 +953,7 @@ void RTLIL::Design::check()
 {
 #ifndef NDEBUG
 	for (auto &it : modules_) {
-		log_assert(this == it.second->design);
+		log_assert(this == it.second->design || std::count(it.second->shared_designs_.begin(), it.second->shared_designs_.end(), this) == 1);
 		log_assert(it.first == it.second->name);
 		log_assert(!it.first.empty());
 		it.second->check();
@@ -839,6 +963,7 @@ void RTLIL::Design::check()
 
 void RTLIL::Design::optimize()
 {
+	unshare_all();
 	for (auto &it : modules_)
 		it.second->optimize();
 	for (auto &it : selection_stack)
@@ -884,13 +1009,15 @@ bool RTLIL::Design::selected_whole_module(RTLIL::Module *mod) const
 	return selected_whole_module(mod->name);
 }
 
+// The selected_*modules() functions hand out modules for modification like module() does, so shared modules are
+// unshared even though the functions are const, unless the design is only being read.
 std::vector<RTLIL::Module*> RTLIL::Design::selected_modules() const
 {
 	std::vector<RTLIL::Module*> result;
 	result.reserve(modules_.size());
 	for (auto &it : modules_)
 		if (selected_module(it.first) && !it.second->get_blackbox_attribute())
-			result.push_back(it.second);
+			result.push_back(reading_only ? it.second : const_cast<RTLIL::Design*>(this)->unshare(it.second));
 	return result;
 }
 
@@ -900,7 +1027,7 @@ std::vector<RTLIL::Module*> RTLIL::Design::selected_whole_modules() const
 	result.reserve(modules_.size());
 	for (auto &it : modules_)
 		if (selected_whole_module(it.first) && !it.second->get_blackbox_attribute())
-			result.push_back(it.second);
+			result.push_back(reading_only ? it.second : const_cast<RTLIL::Design*>(this)->unshare(it.second));
 	return result;
 }
 
@@ -912,7 +1039,7 @@ std::vector<RTLIL::Module*> RTLIL::Design::selected_whole_modules_warn(bool incl
 		if (it.second->get_blackbox_attribute(include_wb))
 			continue;
 		else if (selected_whole_module(it.first))
-			result.push_back(it.second);
+			result.push_back(reading_only ? it.second : const_cast<RTLIL::Design*>(this)->unshare(it.second));
 		else if (selected_module(it.first))
 			log_warning("Ignoring partially selected module %s.\n", log_id(it.first));
 	return result;
@@ -960,6 +1087,7 @@ std::map<unsigned int, RTLIL::Module*> *RTLIL::Module::get_all_modules(void)
 
 void RTLIL::Module::makeblackbox()
 {
+	before_change();
 	pool<RTLIL::Wire*> delwires;
 
 	for (auto it = wires_.begin(); it != wires_.end(); ++it)
@@ -2139,6 +2267,7 @@ std::vector<RTLIL::Cell*> RTLIL::Module::selected_cells() const
 
 void RTLIL::Module::add(RTLIL::Wire *wire)
 {
+	before_change();
 	log_assert(!wire->name.empty());
 	log_assert(count_id(wire->name) == 0);
 	log_assert(refcount_wires_ == 0);
@@ -2148,6 +2277,7 @@ void RTLIL::Module::add(RTLIL::Wire *wire)
 
 void RTLIL::Module::add(RTLIL::Cell *cell)
 {
+	before_change();
 	log_assert(!cell->name.empty());
 	log_assert(count_id(cell->name) == 0);
 	log_assert(refcount_cells_ == 0);
@@ -2157,6 +2287,7 @@ void RTLIL::Module::add(RTLIL::Cell *cell)
 
 void RTLIL::Module::add(RTLIL::Process *process)
 {
+	before_change();
 	log_assert(!process->name.empty());
 	log_assert(count_id(process->name) == 0);
 	processes[process->name] = process;
@@ -2171,6 +2302,7 @@ void RTLIL::Module::add(RTLIL::Binding *binding)
 
 void RTLIL::Module::remove(const pool<RTLIL::Wire*> &wires)
 {
+	before_change();
 	log_assert(refcount_wires_ == 0);
 
 	struct DeleteWireWorker
@@ -2209,6 +2341,7 @@ void RTLIL::Module::remove(const pool<RTLIL::Wire*> &wires)
 
 void RTLIL::Module::remove(RTLIL::Cell *cell)
 {
+	before_change();
 	while (!cell->connections_.empty())
 		cell->unsetPort(cell->connections_.begin()->first);
 
@@ -2220,6 +2353,7 @@ void RTLIL::Module::remove(RTLIL::Cell *cell)
 
 void RTLIL::Module::remove(RTLIL::Process *process)
 {
+	before_change();
 	log_assert(processes.count(process->name) != 0);
 	processes.erase(process->name);
 	delete process;
@@ -2227,6 +2361,7 @@ void RTLIL::Module::remove(RTLIL::Process *process)
 
 void RTLIL::Module::rename(RTLIL::Wire *wire, RTLIL::IdString new_name)
 {
+	before_change();
 	log_assert(wires_[wire->name] == wire);
 	log_assert(refcount_wires_ == 0);
 	wires_.erase(wire->name);
@@ -2236,6 +2371,7 @@ void RTLIL::Module::rename(RTLIL::Wire *wire, RTLIL::IdString new_name)
 
 void RTLIL::Module::rename(RTLIL::Cell *cell, RTLIL::IdString new_name)
 {
+	before_change();
 	log_assert(cells_[cell->name] == cell);
 	log_assert(refcount_wires_ == 0);
 	cells_.erase(cell->name);
@@ -2256,6 +2392,7 @@ void RTLIL::Module::rename(RTLIL::IdString old_name, RTLIL::IdString new_name)
 
 void RTLIL::Module::swap_names(RTLIL::Wire *w1, RTLIL::Wire *w2)
 {
+	before_change();
 	log_assert(wires_[w1->name] == w1);
 	log_assert(wires_[w2->name] == w2);
 	log_assert(refcount_wires_ == 0);
@@ -2271,6 +2408,7 @@ void RTLIL::Module::swap_names(RTLIL::Wire *w1, RTLIL::Wire *w2)
 
 void RTLIL::Module::swap_names(RTLIL::Cell *c1, RTLIL::Cell *c2)
 {
+	before_change();
 	log_assert(cells_[c1->name] == c1);
 	log_assert(cells_[c2->name] == c2);
 	log_assert(refcount_cells_ == 0);
@@ -2320,6 +2458,7 @@ static bool fixup_ports_compare(const RTLIL::Wire *a, const RTLIL::Wire *b)
 
 void RTLIL::Module::connect(const RTLIL::SigSig &conn)
 {
+	before_change();
 	for (auto mon : monitors)
 		mon->notify_connect(this, conn);
 
@@ -2356,6 +2495,7 @@ void RTLIL::Module::connect(const RTLIL::SigSpec &lhs, const RTLIL::SigSpec &rhs
 
 void RTLIL::Module::new_connections(const std::vector<RTLIL::SigSig> &new_conn)
 {
+	before_change();
 	for (auto mon : monitors)
 		mon->notify_connect(this, new_conn);
 
@@ -2380,6 +2520,7 @@ const std::vector<RTLIL::SigSig> &RTLIL::Module::connections() const
 
 void RTLIL::Module::fixup_ports()
 {
+	before_change();
 	std::vector<RTLIL::Wire*> all_ports;
 
 	for (auto &w : wires_)
@@ -2440,6 +2581,7 @@ RTLIL::Cell *RTLIL::Module::addCell(RTLIL::IdString name, const RTLIL::Cell *oth
 
 RTLIL::Memory *RTLIL::Module::addMemory(RTLIL::IdString name, const RTLIL::Memory *other)
 {
+	before_change();
 	RTLIL::Memory *mem = new RTLIL::Memory;
 	mem->name = name;
 	mem->width = other->width;
@@ -3524,6 +3666,8 @@ void RTLIL::Cell::unsetPort(const RTLIL::IdString& portname)
 
 	if (conn_it != connections_.end())
 	{
+		module->before_change();
+
 		for (auto mon : module->monitors)
 			mon->notify_connect(this, conn_it->first, conn_it->second, signal);
 
@@ -3542,6 +3686,8 @@ void RTLIL::Cell::unsetPort(const RTLIL::IdString& portname)
 
 void RTLIL::Cell::setPort(const RTLIL::IdString& portname, RTLIL::SigSpec signal)
 {
+	module->before_change();
+
 	auto r = connections_.insert(portname);
 	auto conn_it = r.first;
 	if (!r.second && conn_it->second == signal)
@@ -3576,7 +3722,7 @@ bool RTLIL::Cell::known() const
 {
 	if (yosys_celltypes.cell_known(type))
 		return true;
-	if (module && module->design && module->design->module(type))
+	if (module && module->design && static_cast<const RTLIL::Design*>(module->design)->module(type))
 		return true;
 	return false;
 }
@@ -3586,8 +3732,8 @@ bool RTLIL::Cell::input(const RTLIL::IdString& portname) const
 	if (yosys_celltypes.cell_known(type))
 		return yosys_celltypes.cell_input(type, portname);
 	if (module && module->design) {
-		RTLIL::Module *m = module->design->module(type);
-		RTLIL::Wire *w = m ? m->wire(portname) : nullptr;
+		const RTLIL::Module *m = static_cast<const RTLIL::Design*>(module->design)->module(type);
+		const RTLIL::Wire *w = m ? m->wire(portname) : nullptr;
 		return w && w->port_input;
 	}
 	return false;
@@ -3598,8 +3744,8 @@ bool RTLIL::Cell::output(const RTLIL::IdString& portname) const
 	if (yosys_celltypes.cell_known(type))
 		return yosys_celltypes.cell_output(type, portname);
 	if (module && module->design) {
-		RTLIL::Module *m = module->design->module(type);
-		RTLIL::Wire *w = m ? m->wire(portname) : nullptr;
+		const RTLIL::Module *m = static_cast<const RTLIL::Design*>(module->design)->module(type);
+		const RTLIL::Wire *w = m ? m->wire(portname) : nullptr;
 		return w && w->port_output;
 	}
 	return false;
@@ -3612,11 +3758,15 @@ bool RTLIL::Cell::hasParam(const RTLIL::IdString& paramname) const
 
 void RTLIL::Cell::unsetParam(const RTLIL::IdString& paramname)
 {
+	if (module)
+		module->before_change();
 	parameters.erase(paramname);
 }
 
 void RTLIL::Cell::setParam(const RTLIL::IdString& paramname, RTLIL::Const value)
 {
+	if (module)
+		module->before_change();
 	parameters[paramname] = std::move(value);
 }
 
@@ -3626,7 +3776,7 @@ const RTLIL::Const &RTLIL::Cell::getParam(const RTLIL::IdString& paramname) cons
 	if (it != parameters.end())
 		return it->second;
 	if (module && module->design) {
-		RTLIL::Module *m = module->design->module(type);
+		const RTLIL::Module *m = static_cast<const RTLIL::Design*>(module->design)->module(type);
 		if (m)
 			return m->parameter_default_values.at(paramname);
 	}
@@ -3654,6 +3804,9 @@ void RTLIL::Cell::fixup_parameters(bool set_a_signed, bool set_b_signed)
 			type.begins_with("$verific$") || type.begins_with("$array:") || type.begins_with("$extern:"))
 		return;
 
+	if (module)
+		module->before_change();
+
 	if (type == ID($mux) || type == ID($pmux) || type == ID($bmux)) {
 		parameters[ID::WIDTH] = GetSize(connections_[ID::Y]);
 		if (type != ID($mux))
@@ -74,6 +74,7 @@ namespace RTLIL
 	struct SyncRule;
 	struct Process;
 	struct Binding;
+	struct LazyModule;
 
 	typedef std::pair<SigSpec, SigSpec> SigSig;
 
@@ -1056,6 +1057,18 @@ struct RTLIL::Monitor
 // Forward declaration; defined in preproc.h.
 struct define_map_t;
 
+// Forward declaration; defined in libparse.h.
+struct LibertyCache;
+
+// A module that a frontend has only indexed so far (see 'read_verilog -lazy'). The
+// source of the module is read with the given frontend command when it is first needed.
+struct RTLIL::LazyModule
+{
+	std::vector<std::string> frontend_args;
+	std::string filename;
+	std::string source;
+};
+
 struct RTLIL::Design
 {
 	unsigned int hashidx_;
@@ -1067,9 +1080,11 @@ struct RTLIL::Design
 	int refcount_modules_;
 	dict<RTLIL::IdString, RTLIL::Module*> modules_;
 	std::vector<RTLIL::Binding*> bindings_;
+	dict<RTLIL::IdString, std::shared_ptr<const RTLIL::LazyModule>> lazy_modules_;
 
 	std::vector<AST::AstNode*> verilog_packages, verilog_globals;
 	std::unique_ptr<define_map_t> verilog_defines;
+	std::unique_ptr<LibertyCache> liberty_cache;
 
 	std::vector<RTLIL::Selection> selection_stack;
 	dict<RTLIL::IdString, RTLIL::Selection> selection_vars;
@@ -1087,9 +1102,42 @@ struct RTLIL::Design
 		return modules_.count(id) != 0;
 	}
 
+	bool has_lazy_module(const RTLIL::IdString &id) const {
+		return lazy_modules_.count(id) != 0;
+	}
+
+	// Read a module from lazy_modules_ and return it, or nullptr if there is no such module.
+	RTLIL::Module *load_lazy_module(const RTLIL::IdString &name);
+
 	void add(RTLIL::Module *module);
 	void add(RTLIL::Binding *binding);
 
+	// Add a module that is held by another design without copying it. A shared module is only copied when one of
+	// the designs that hold it is about to change it: that design keeps the module and the other designs get a
+	// copy. The non-const module accessors (modules(), module(), selected_modules() etc.) count as a change unless
+	// the design is only being read (see reading_only), and so do the Module and Cell methods that change a module.
+	void add_shared(RTLIL::Module *module);
+
+	// Give the other designs that hold the given module a copy of it, so that this design can change it. Returns
+	// the module.
+	RTLIL::Module *unshare(RTLIL::Module *module);
+
+	// Set while the design is only being read, i.e. while a command that doesn't change modules runs (see
+	// Pass::read_only()) and while selections are evaluated. The module accessors then hand out shared modules
+	// without copying them.
+	bool reading_only = false;
+
+	struct ReadingOnlyScope {
+		RTLIL::Design *design;
+		bool saved;
+		ReadingOnlyScope(RTLIL::Design *design, bool value = true) : design(design), saved(design->reading_only) {
+			design->reading_only = value;
+		}
+		~ReadingOnlyScope() {
+			design->reading_only = saved;
+		}
+	};
+
 	RTLIL::Module *addModule(RTLIL::IdString name);
 	void remove(RTLIL::Module *module);
 	void rename(RTLIL::Module *module, RTLIL::IdString new_name);
@@ -1156,6 +1204,11 @@ struct RTLIL::Design
 #ifdef WITH_PYTHON
 	static std::map<unsigned int, RTLIL::Design*> *get_all_designs(void);
 #endif
+
+private:
+	int num_shared_modules_;
+	void unshare_all();
+	void release(RTLIL::Module *module);
 };
 
 struct RTLIL::Module : public RTLIL::AttrObject
@@ -1175,6 +1228,20 @@ public:
 	int refcount_wires_;
 	int refcount_cells_;
 
+	// Designs besides `design` that also hold this module. Modules are shared copy-on-write between designs
+	// (see Design::add_shared()).
+	std::vector<RTLIL::Design*> shared_designs_;
+
+	bool is_shared() const { return !shared_designs_.empty(); }
+
+	// Called by the methods that change the module: if it is shared, the current design (the one commands run
+	// on) keeps it, or `design` if the current design doesn't hold it, and the other designs get a copy.
+	void before_change() {
+		if (is_shared())
+			unshare_for_change();
+	}
+	void unshare_for_change();
+
 	dict<RTLIL::IdString, RTLIL::Wire*> wires_;
 	dict<RTLIL::IdString, RTLIL::Cell*> cells_;
 
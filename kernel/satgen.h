@@ -33,6 +33,10 @@ YOSYS_NAMESPACE_BEGIN
 extern struct SatSolver *yosys_satsolver_list;
 extern struct SatSolver *yosys_satsolver;
 
+// The solver named by the "sat.solver" scratchpad variable, or the default
+// solver if that variable is not set.
+struct SatSolver *yosys_selected_satsolver();
+
 struct SatSolver
 {
 	string name;
@@ -58,7 +62,7 @@ struct SatSolver
 };
 
 struct ezSatPtr : public std::unique_ptr<ezSAT> {
-	ezSatPtr() : unique_ptr<ezSAT>(yosys_satsolver->create()) { }
+	ezSatPtr() : unique_ptr<ezSAT>(yosys_selected_satsolver()->create()) { }
 };
 
 struct SatGen
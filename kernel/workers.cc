@@ -0,0 +1,372 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/workers.h"
+
+#if !defined(_WIN32) && !defined(__wasm) && !defined(EMSCRIPTEN) && !defined(YOSYS_DISABLE_SPAWN)
+#  define YOSYS_ENABLE_WORKERS
+#  include <atomic>
+#  include <errno.h>
+#  include <signal.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/types.h>
+#  include <sys/wait.h>
+#endif
+
+YOSYS_NAMESPACE_BEGIN
+
+void WorkerResult::replay_log(RTLIL::Design *design) const
+{
+	for (auto &entry : log) {
+		if (entry.kind == WorkerLogEntry::WARNING)
+			log_warning_with_prefix(entry.prefix, entry.text);
+		else if (entry.kind == WorkerLogEntry::HEADER)
+			log_header(design, "%s", entry.text.c_str());
+		else
+			Yosys::log("%s", entry.text.c_str());
+	}
+}
+
+#ifdef YOSYS_ENABLE_WORKERS
+
+namespace {
+
+struct JobDone
+{
+	int job;
+	int ok;
+};
+
+// Temporary directories of the jobs in progress, which are removed if the main process runs into log_error().
+std::vector<std::string> job_dirs;
+void (*saved_log_error_atexit)();
+
+void remove_job_dirs()
+{
+	for (auto &dir : job_dirs)
+		remove_directory(dir);
+	job_dirs.clear();
+	if (saved_log_error_atexit)
+		saved_log_error_atexit();
+}
+
+std::ostringstream *capture_stream;
+std::vector<WorkerLogEntry> *capture_log;
+
+void capture_flush()
+{
+	std::string text = capture_stream->str();
+	if (!text.empty())
+		capture_log->push_back(WorkerLogEntry{WorkerLogEntry::TEXT, std::string(), text});
+	capture_stream->str(std::string());
+}
+
+void capture_warning(const std::string &prefix, const std::string &message)
+{
+	log_warnings_count++;
+	capture_flush();
+	capture_log->push_back(WorkerLogEntry{WorkerLogEntry::WARNING, prefix, message});
+}
+
+void capture_header(const std::string &message)
+{
+	capture_flush();
+	capture_log->push_back(WorkerLogEntry{WorkerLogEntry::HEADER, std::string(), message});
+}
+
+void write_string(FILE *f, const std::string &str)
+{
+	uint64_t size = str.size();
+	fwrite(&size, sizeof(size), 1, f);
+	fwrite(str.data(), 1, str.size(), f);
+}
+
+bool read_string(FILE *f, std::string &str)
+{
+	uint64_t size;
+	if (fread(&size, sizeof(size), 1, f) != 1)
+		return false;
+	str.resize(size);
+	return size == 0 || fread(&str[0], 1, size, f) == size;
+}
+
+// Runs in a process forked from a worker for each job. Never returns.
+[[noreturn]] void run_job(int job_idx, const std::string &filename, const std::function<std::string(int)> &job)
+{
+	std::ostringstream stream;
+	std::vector<WorkerLogEntry> entries;
+	capture_stream = &stream;
+	capture_log = &entries;
+
+	// Errors and warnings are reported by the main process, which replays
+	// the log of the job or repeats a failed job itself.
+	log_files.clear();
+	log_streams.clear();
+	log_streams.push_back(&stream);
+	log_errfile = nullptr;
+	log_error_stderr = false;
+	log_error_atexit = nullptr;
+	job_dirs.clear();
+	log_cmd_error_throw = false;
+	log_warning_forward = capture_warning;
+	log_header_forward = capture_header;
+	log_expect_log.clear();
+	log_expect_warning.clear();
+	log_expect_error.clear();
+	log_hasher = nullptr;
+	log_time = false;
+
+	std::string data;
+	try {
+		data = job(job_idx);
+	} catch (...) {
+		_exit(1);
+	}
+	capture_flush();
+
+	FILE *f = fopen(filename.c_str(), "wb");
+	if (f == nullptr)
+		_exit(1);
+	uint64_t num_entries = entries.size();
+	fwrite(&num_entries, sizeof(num_entries), 1, f);
+	for (auto &entry : entries) {
+		fputc(entry.kind, f);
+		write_string(f, entry.prefix);
+		write_string(f, entry.text);
+	}
+	write_string(f, data);
+	bool ok = !ferror(f);
+	ok &= fclose(f) == 0;
+	_exit(ok ? 0 : 1);
+}
+
+bool read_result(const std::string &filename, WorkerResult &result)
+{
+	FILE *f = fopen(filename.c_str(), "rb");
+	if (f == nullptr)
+		return false;
+	uint64_t num_entries;
+	bool ok = fread(&num_entries, sizeof(num_entries), 1, f) == 1;
+	for (uint64_t i = 0; ok && i < num_entries; i++) {
+		WorkerLogEntry entry;
+		int ch = fgetc(f);
+		entry.kind = WorkerLogEntry::Kind(ch);
+		ok = ch >= WorkerLogEntry::TEXT && ch <= WorkerLogEntry::HEADER && read_string(f, entry.prefix) && read_string(f, entry.text);
+		result.log.push_back(std::move(entry));
+	}
+	ok = ok && read_string(f, result.data);
+	fclose(f);
+	if (!ok) {
+		result.log.clear();
+		result.data.clear();
+	}
+	return ok;
+}
+
+bool write_all(int fd, const void *data, size_t size)
+{
+	const char *p = (const char*)data;
+	while (size > 0) {
+		ssize_t n = write(fd, p, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n, size -= n;
+	}
+	return true;
+}
+
+bool read_all(int fd, void *data, size_t size)
+{
+	char *p = (char*)data;
+	while (size > 0) {
+		ssize_t n = read(fd, p, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n, size -= n;
+	}
+	return true;
+}
+
+pid_t wait_for(pid_t pid, int *status)
+{
+	pid_t ret;
+	do
+		ret = waitpid(pid, status, 0);
+	while (ret < 0 && errno == EINTR);
+	return ret;
+}
+
+}
+
+bool worker_processes_available()
+{
+	return true;
+}
+
+void run_worker_jobs(int num_jobs, int num_workers, const std::function<std::string(int)> &job,
+		const std::function<void(int, WorkerResult&)> &done)
+{
+	num_workers = std::max(1, std::min(num_workers, num_jobs));
+
+	// Releases everything below also when done() or log_error() throws: the
+	// workers that are still running are killed and reaped (a job process
+	// that is already running finishes on its own, its result is discarded
+	// with the temporary directory).
+	struct Cleanup {
+		std::string tempdir;
+		void *shared = MAP_FAILED;
+		int pipe_fd = -1;
+		std::vector<pid_t> workers;
+
+		~Cleanup() {
+			for (auto pid : workers)
+				kill(pid, SIGKILL);
+			for (auto pid : workers) {
+				int status;
+				wait_for(pid, &status);
+			}
+			if (pipe_fd >= 0)
+				close(pipe_fd);
+			if (shared != MAP_FAILED)
+				munmap(shared, sizeof(std::atomic<int>));
+			remove_directory(tempdir);
+			if (!job_dirs.empty() && job_dirs.back() == tempdir) {
+				job_dirs.pop_back();
+				if (job_dirs.empty())
+					log_error_atexit = saved_log_error_atexit;
+			}
+		}
+	} cleanup;
+
+	cleanup.tempdir = make_temp_dir(get_base_tmpdir() + "/yosys-workers-XXXXXX");
+	std::string tempdir = cleanup.tempdir;
+	auto job_filename = [&](int job_idx) { return stringf("%s/%d", tempdir.c_str(), job_idx); };
+
+	if (job_dirs.empty()) {
+		saved_log_error_atexit = log_error_atexit;
+		log_error_atexit = remove_job_dirs;
+	}
+	job_dirs.push_back(tempdir);
+
+	// The workers take the next job from a counter in shared memory.
+	cleanup.shared = mmap(nullptr, sizeof(std::atomic<int>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (cleanup.shared == MAP_FAILED)
+		log_error("Failed to allocate shared memory for worker processes: %s\n", strerror(errno));
+	std::atomic<int> *next_job = new (cleanup.shared) std::atomic<int>(0);
+
+	int done_pipe[2];
+	if (pipe(done_pipe) != 0)
+		log_error("Failed to create pipe for worker processes: %s\n", strerror(errno));
+	cleanup.pipe_fd = done_pipe[0];
+
+	log_flush();
+	fflush(stdout);
+	fflush(stderr);
+
+	for (int i = 0; i < num_workers; i++)
+	{
+		pid_t pid = fork();
+		if (pid < 0)
+			break;
+		if (pid > 0) {
+			cleanup.workers.push_back(pid);
+			continue;
+		}
+
+		// Worker process: fork a copy of itself for each job, so that every
+		// job starts from the same state.
+		close(done_pipe[0]);
+		while (1) {
+			int job_idx = next_job->fetch_add(1);
+			if (job_idx >= num_jobs)
+				break;
+			pid_t job_pid = fork();
+			if (job_pid == 0) {
+				close(done_pipe[1]);
+				run_job(job_idx, job_filename(job_idx), job);
+			}
+			int status = 0;
+			JobDone msg = {job_idx, 0};
+			if (job_pid > 0 && wait_for(job_pid, &status) == job_pid)
+				msg.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+			if (!write_all(done_pipe[1], &msg, sizeof(msg)))
+				break;
+		}
+		_exit(0);
+	}
+	close(done_pipe[1]);
+
+	std::vector<char> finished(num_jobs, 0);
+	int next_done = 0;
+
+	auto report = [&](int job_idx) {
+		WorkerResult result;
+		std::string filename = job_filename(job_idx);
+		if (finished[job_idx] == 1)
+			result.ok = read_result(filename, result);
+		remove(filename.c_str());
+		done(job_idx, result);
+	};
+
+	JobDone msg;
+	while (read_all(done_pipe[0], &msg, sizeof(msg))) {
+		if (msg.job < 0 || msg.job >= num_jobs)
+			continue;
+		finished[msg.job] = msg.ok ? 1 : 2;
+		while (next_done < num_jobs && finished[next_done])
+			report(next_done++);
+	}
+
+	// All workers have exited once the pipe is closed on their end.
+	for (auto pid : cleanup.workers) {
+		int status;
+		wait_for(pid, &status);
+	}
+	cleanup.workers.clear();
+
+	// Jobs that were never reported (e.g. because a worker could not be
+	// started or was killed) are passed on as failed.
+	while (next_done < num_jobs)
+		report(next_done++);
+}
+
+#else
+
+bool worker_processes_available()
+{
+	return false;
+}
+
+void run_worker_jobs(int num_jobs, int, const std::function<std::string(int)> &,
+		const std::function<void(int, WorkerResult&)> &done)
+{
+	for (int i = 0; i < num_jobs; i++) {
+		WorkerResult result;
+		done(i, result);
+	}
+}
+
+#endif
+
+YOSYS_NAMESPACE_END
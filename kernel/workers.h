@@ -0,0 +1,67 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef WORKERS_H
+#define WORKERS_H
+
+#include "kernel/yosys.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// Runs independent jobs in parallel in forked worker processes. Most of the
+// global state of Yosys (IdStrings, the frontends' parsers, the log) is not
+// thread safe, so separate processes are used instead of threads.
+//
+// Every job runs in a fresh copy of the process as it was when
+// run_worker_jobs() was called, so jobs can freely modify the design without
+// affecting each other. A job returns its result as a string, which is passed
+// to the done callback in the main process together with the log output of
+// the job. The done callback is called in job order, as soon as all earlier
+// jobs are done.
+//
+// A job that does not finish (e.g. because it called log_error()) is reported
+// with ok set to false and its log output discarded. The caller should then
+// repeat the job in the main process, where the error is reported as usual.
+
+struct WorkerLogEntry
+{
+	enum Kind { TEXT, WARNING, HEADER } kind;
+	std::string prefix, text;
+};
+
+struct WorkerResult
+{
+	bool ok = false;
+	std::string data;
+	std::vector<WorkerLogEntry> log;
+
+	// Print the log output of the job. Warnings and headers are issued again
+	// in the calling process, so that warnings are counted and checked as
+	// usual and headers are numbered as if the job ran in this process.
+	void replay_log(RTLIL::Design *design = nullptr) const;
+};
+
+bool worker_processes_available();
+
+void run_worker_jobs(int num_jobs, int num_workers, const std::function<std::string(int)> &job,
+		const std::function<void(int, WorkerResult&)> &done);
+
+YOSYS_NAMESPACE_END
+
+#endif
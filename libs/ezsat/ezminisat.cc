@@ -44,6 +44,8 @@ ezMiniSAT::ezMiniSAT() : minisatSolver(NULL)
 {
 	minisatSolver = NULL;
 	foundContradiction = false;
+	simplifyCnf = true;
+	substitutedVars = 0;
 
 	freeze(CONST_TRUE);
 	freeze(CONST_FALSE);
@@ -62,7 +64,7 @@ void ezMiniSAT::clear()
 		minisatSolver = NULL;
 	}
 	foundContradiction = false;
-	minisatVars.clear();
+	minisatLits.clear();
 #if EZMINISAT_SIMPSOLVER && EZMINISAT_INCREMENTAL
 	cnfFrozenVars.clear();
 #endif
@@ -79,12 +81,66 @@ void ezMiniSAT::freeze(int id)
 bool ezMiniSAT::eliminated(int idx)
 {
 	idx = idx < 0 ? -idx : idx;
-	if (minisatSolver != NULL && idx > 0 && idx <= int(minisatVars.size()))
-		return minisatSolver->isEliminated(minisatVars.at(idx-1));
+	if (minisatSolver != NULL && idx > 0 && idx <= int(minisatLits.size()))
+		return minisatSolver->isEliminated(Minisat::var(Minisat::toLit(minisatLits.at(idx-1))));
 	return false;
 }
 #endif
 
+static Minisat::Lit ezMiniSatLit(const std::vector<int> &minisatLits, int idx)
+{
+	if (idx > 0)
+		return Minisat::toLit(minisatLits.at(idx-1));
+	return ~Minisat::toLit(minisatLits.at(-idx-1));
+}
+
+static std::pair<int, int> ezMiniSatBinaryClause(int a, int b)
+{
+	return std::pair<int, int>(std::min(a, b), std::max(a, b));
+}
+
+// Find variables that are made equivalent to another variable (or its
+// negation) by a pair of binary clauses (a | b) & (-a | -b) in the new
+// clauses. Only variables that are not yet known to MiniSAT are substituted,
+// so the clauses that MiniSAT already has never need to be rewritten.
+// substitutions[v] is set to the literal that replaces v, or 0.
+void ezMiniSAT::substituteEquivalences(const std::vector<std::vector<int>> &cnf, std::vector<int> &substitutions)
+{
+	int numOldVars = minisatLits.size();
+	substitutions.assign(numCnfVariables()+1, 0);
+
+	auto find = [&](int lit) {
+		while (substitutions[lit > 0 ? lit : -lit] != 0)
+			lit = lit > 0 ? substitutions[lit] : -substitutions[-lit];
+		return lit;
+	};
+
+	std::set<std::pair<int, int>> binaryClauses;
+	for (auto &clause : cnf)
+		if (clause.size() == 2 && clause[0] != -clause[1])
+			binaryClauses.insert(ezMiniSatBinaryClause(clause[0], clause[1]));
+
+	for (auto &it : binaryClauses)
+	{
+		if (!binaryClauses.count(ezMiniSatBinaryClause(-it.first, -it.second)))
+			continue;
+
+		int a = find(it.first), b = find(-it.second);
+		if (a == b || a == -b)
+			continue;
+		if (abs(b) <= numOldVars)
+			std::swap(a, b);
+		if (abs(b) <= numOldVars || eliminated(abs(a)))
+			continue;
+
+		substitutions[abs(b)] = b > 0 ? a : -a;
+	}
+
+	for (int v = numOldVars+1; v < int(substitutions.size()); v++)
+		if (substitutions[v] != 0)
+			substitutions[v] = find(v);
+}
+
 #if defined(HAS_ALARM)
 ezMiniSAT *ezMiniSAT::alarmHandlerThis = NULL;
 clock_t ezMiniSAT::alarmHandlerTimeout = 0;
@@ -109,7 +165,7 @@ bool ezMiniSAT::solver(const std::vector<int> &modelExpressions, std::vector<boo
 contradiction:
 		delete minisatSolver;
 		minisatSolver = NULL;
-		minisatVars.clear();
+		minisatLits.clear();
 		foundContradiction = true;
 		return false;
 	}
@@ -138,24 +194,35 @@ contradiction:
 	const std::vector<std::vector<int>> &cnf = this->cnf();
 #endif
 
-	while (int(minisatVars.size()) < numCnfVariables())
-		minisatVars.push_back(minisatSolver->newVar());
+	std::vector<int> substitutions;
+	if (simplifyCnf)
+		substituteEquivalences(cnf, substitutions);
+
+	int numOldVars = minisatLits.size();
+	minisatLits.resize(numCnfVariables());
+
+	for (int v = numOldVars+1; v <= numCnfVariables(); v++)
+		if (substitutions.empty() || substitutions[v] == 0)
+			minisatLits[v-1] = Minisat::toInt(Minisat::mkLit(minisatSolver->newVar()));
+
+	for (int v = numOldVars+1; v <= numCnfVariables(); v++)
+		if (!substitutions.empty() && substitutions[v] != 0) {
+			minisatLits[v-1] = Minisat::toInt(ezMiniSatLit(minisatLits, substitutions[v]));
+			substitutedVars++;
+		}
 
 #if EZMINISAT_SIMPSOLVER && EZMINISAT_INCREMENTAL
 	for (auto idx : cnfFrozenVars)
-		minisatSolver->setFrozen(minisatVars.at(idx > 0 ? idx-1 : -idx-1), true);
+		minisatSolver->setFrozen(Minisat::var(ezMiniSatLit(minisatLits, idx)), true);
 	cnfFrozenVars.clear();
 #endif
 
 	for (auto &clause : cnf) {
 		Minisat::vec<Minisat::Lit> ps;
 		for (auto idx : clause) {
-			if (idx > 0)
-				ps.push(Minisat::mkLit(minisatVars.at(idx-1)));
-			else
-				ps.push(Minisat::mkLit(minisatVars.at(-idx-1), true));
+			ps.push(ezMiniSatLit(minisatLits, idx));
 #if EZMINISAT_SIMPSOLVER
-			if (minisatSolver->isEliminated(minisatVars.at(idx > 0 ? idx-1 : -idx-1))) {
+			if (minisatSolver->isEliminated(Minisat::var(ps.last()))) {
 				fprintf(stderr, "Assert in %s:%d failed! Missing call to ezsat->freeze(): %s (lit=%d)\n",
 						__FILE__, __LINE__, cnfLiteralInfo(idx).c_str(), idx);
 				abort();
@@ -172,12 +239,9 @@ contradiction:
 	Minisat::vec<Minisat::Lit> assumps;
 
 	for (auto idx : extraClauses) {
-		if (idx > 0)
-			assumps.push(Minisat::mkLit(minisatVars.at(idx-1)));
-		else
-			assumps.push(Minisat::mkLit(minisatVars.at(-idx-1), true));
+		assumps.push(ezMiniSatLit(minisatLits, idx));
 #if EZMINISAT_SIMPSOLVER
-		if (minisatSolver->isEliminated(minisatVars.at(idx > 0 ? idx-1 : -idx-1))) {
+		if (minisatSolver->isEliminated(Minisat::var(assumps.last()))) {
 			fprintf(stderr, "Assert in %s:%d failed! Missing call to ezsat->freeze(): %s\n", __FILE__, __LINE__, cnfLiteralInfo(idx).c_str());
 			abort();
 		}
@@ -201,7 +265,11 @@ contradiction:
 	}
 #endif
 
+#if EZMINISAT_SIMPSOLVER
+	bool foundSolution = minisatSolver->solve(assumps, simplifyCnf);
+#else
 	bool foundSolution = minisatSolver->solve(assumps);
+#endif
 
 #if defined(HAS_ALARM)
 	if (solverTimeout > 0) {
@@ -217,7 +285,7 @@ contradiction:
 #if !EZMINISAT_INCREMENTAL
 		delete minisatSolver;
 		minisatSolver = NULL;
-		minisatVars.clear();
+		minisatLits.clear();
 #endif
 		return false;
 	}
@@ -227,21 +295,15 @@ contradiction:
 
 	for (size_t i = 0; i < modelIdx.size(); i++)
 	{
-		int idx = modelIdx[i];
-		bool refvalue = true;
-
-		if (idx < 0)
-			idx = -idx, refvalue = false;
-
 		using namespace Minisat;
-		lbool value = minisatSolver->modelValue(minisatVars.at(idx-1));
-		modelValues[i] = (value == Minisat::lbool(refvalue));
+		lbool value = minisatSolver->modelValue(ezMiniSatLit(minisatLits, modelIdx[i]));
+		modelValues[i] = (value == l_True);
 	}
 
 #if !EZMINISAT_INCREMENTAL
 	delete minisatSolver;
 	minisatSolver = NULL;
-	minisatVars.clear();
+	minisatLits.clear();
 #endif
 	return true;
 }
@@ -44,9 +44,11 @@ private:
 	typedef Minisat::Solver Solver;
 #endif
 	Solver *minisatSolver;
-	std::vector<int> minisatVars;
+	std::vector<int> minisatLits;
 	bool foundContradiction;
 
+	void substituteEquivalences(const std::vector<std::vector<int>> &cnf, std::vector<int> &substitutions);
+
 #if EZMINISAT_SIMPSOLVER && EZMINISAT_INCREMENTAL
 	std::set<int> cnfFrozenVars;
 #endif
@@ -66,6 +68,14 @@ public:
 	virtual bool eliminated(int idx);
 #endif
 	virtual bool solver(const std::vector<int> &modelExpressions, std::vector<bool> &modelValues, const std::vector<int> &assumptions);
+
+	// Simplify the CNF before solving (enabled by default): variables that
+	// new clauses make equivalent to another variable are substituted
+	// before the clauses reach MiniSAT, and (with EZMINISAT_SIMPSOLVER)
+	// MiniSAT eliminates variables and subsumed clauses. Frozen variables
+	// are never eliminated, and models are reconstructed for the rest.
+	bool simplifyCnf;
+	int substitutedVars;
 };
 
 #endif
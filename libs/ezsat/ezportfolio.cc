@@ -0,0 +1,228 @@
+/*
+ *  ezSAT -- A simple and easy to use CNF generator for SAT solvers
+ *
+ *  Copyright (C) 2013  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+// needed for MiniSAT headers (see Minisat Makefile)
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include "ezportfolio.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <cinttypes>
+#include <chrono>
+
+#if !defined(__wasm) && !defined(__EMSCRIPTEN__)
+#  include <thread>
+#  include <mutex>
+#  include <condition_variable>
+#  define HAS_THREADS
+#endif
+
+#include "../minisat/Solver.h"
+
+ezPortfolioSAT::ezPortfolioSAT(int numSolvers) : numSolvers(numSolvers)
+{
+	if (this->numSolvers <= 0) {
+#if defined(HAS_THREADS)
+		this->numSolvers = std::thread::hardware_concurrency();
+#endif
+		this->numSolvers = std::max(2, std::min(4, this->numSolvers));
+	}
+#if !defined(HAS_THREADS)
+	this->numSolvers = 1;
+#endif
+	foundContradiction = false;
+	lastWinner = -1;
+}
+
+ezPortfolioSAT::~ezPortfolioSAT()
+{
+	for (auto s : solvers)
+		delete s;
+}
+
+void ezPortfolioSAT::clear()
+{
+	for (auto s : solvers)
+		delete s;
+	solvers.clear();
+	foundContradiction = false;
+	lastWinner = -1;
+	ezSAT::clear();
+}
+
+static Minisat::Lit ezPortfolioLit(int idx)
+{
+	if (idx > 0)
+		return Minisat::mkLit(idx-1);
+	return Minisat::mkLit(-idx-1, true);
+}
+
+bool ezPortfolioSAT::solver(const std::vector<int> &modelExpressions, std::vector<bool> &modelValues, const std::vector<int> &assumptions)
+{
+	preSolverCallback();
+
+	solverTimoutStatus = false;
+	lastWinner = -1;
+
+	if (foundContradiction) {
+		consumeCnf();
+		return false;
+	}
+
+	std::vector<int> extraClauses, modelIdx;
+
+	for (auto id : assumptions)
+		extraClauses.push_back(bind(id));
+	for (auto id : modelExpressions)
+		modelIdx.push_back(bind(id));
+
+	// The first solver uses the MiniSAT defaults, the others differ in their
+	// random seed, initial activities, restart strategy and clause
+	// minimization so that they explore different parts of the search space.
+	while (int(solvers.size()) < numSolvers) {
+		int i = solvers.size();
+		Minisat::Solver *s = new Minisat::Solver;
+		s->verbosity = 0;
+		if (i > 0) {
+			s->random_seed = 91648253 + 7919 * i;
+			s->rnd_init_act = true;
+			s->random_var_freq = 0.01 * i;
+			s->luby_restart = (i % 2) == 0;
+			s->ccmin_mode = i == 3 ? 1 : 2;
+		}
+		solvers.push_back(s);
+	}
+
+	std::vector<std::vector<int>> cnf;
+	consumeCnf(cnf);
+
+	for (auto s : solvers)
+		while (s->nVars() < numCnfVariables())
+			s->newVar();
+
+	for (auto s : solvers)
+	{
+		for (auto &clause : cnf) {
+			Minisat::vec<Minisat::Lit> ps;
+			for (auto idx : clause)
+				ps.push(ezPortfolioLit(idx));
+			if (!s->addClause(ps))
+				goto contradiction;
+		}
+		if (cnf.size() > 0 && !s->simplify())
+			goto contradiction;
+	}
+
+	if (0) {
+contradiction:
+		for (auto s : solvers)
+			delete s;
+		solvers.clear();
+		foundContradiction = true;
+		return false;
+	}
+
+	{
+		Minisat::vec<Minisat::Lit> assumps;
+		for (auto idx : extraClauses)
+			assumps.push(ezPortfolioLit(idx));
+
+		std::vector<Minisat::lbool> results(solvers.size(), Minisat::l_Undef);
+
+#if defined(HAS_THREADS)
+		std::mutex mtx;
+		std::condition_variable cv;
+		int winner = -1;
+		int running = solvers.size();
+		std::vector<std::thread> threads;
+
+		for (auto s : solvers)
+			s->clearInterrupt();
+
+		for (int i = 0; i < int(solvers.size()); i++)
+			threads.emplace_back([&, i]() {
+				Minisat::lbool res = solvers[i]->solveLimited(assumps);
+				std::lock_guard<std::mutex> lock(mtx);
+				results[i] = res;
+				running--;
+				if (winner < 0 && res != Minisat::l_Undef) {
+					winner = i;
+					for (auto s : solvers)
+						s->interrupt();
+				}
+				cv.notify_all();
+			});
+
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			auto done = [&]() { return winner >= 0 || running == 0; };
+			if (solverTimeout > 0) {
+				auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(solverTimeout);
+				if (!cv.wait_until(lock, deadline, done)) {
+					solverTimoutStatus = true;
+					for (auto s : solvers)
+						s->interrupt();
+				}
+			}
+			cv.wait(lock, [&]() { return running == 0; });
+		}
+
+		for (auto &t : threads)
+			t.join();
+
+		if (solverTimoutStatus)
+			winner = -1;
+#else
+		int winner = 0;
+		results[0] = solvers[0]->solveLimited(assumps);
+#endif
+
+		if (winner < 0 || results[winner] == Minisat::l_Undef)
+			return false;
+
+		lastWinner = winner;
+
+		if (results[winner] == Minisat::l_False)
+			return false;
+
+		Minisat::Solver *s = solvers[winner];
+		modelValues.clear();
+		modelValues.resize(modelIdx.size());
+
+		for (size_t i = 0; i < modelIdx.size(); i++)
+		{
+			int idx = modelIdx[i];
+			bool refvalue = true;
+
+			if (idx < 0)
+				idx = -idx, refvalue = false;
+
+			Minisat::lbool value = s->modelValue(Minisat::Var(idx-1));
+			modelValues[i] = (value == Minisat::lbool(refvalue));
+		}
+	}
+
+	return true;
+}
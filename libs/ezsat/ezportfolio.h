@@ -0,0 +1,52 @@
+/*
+ *  ezSAT -- A simple and easy to use CNF generator for SAT solvers
+ *
+ *  Copyright (C) 2013  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef EZPORTFOLIO_H
+#define EZPORTFOLIO_H
+
+#include "ezsat.h"
+
+namespace Minisat {
+	class Solver;
+}
+
+// Runs several differently configured MiniSAT instances on the same problem,
+// each in its own thread, and takes the answer of the first one to finish.
+// The other instances are interrupted and keep their learned clauses for the
+// next incremental call.
+class ezPortfolioSAT : public ezSAT
+{
+private:
+	std::vector<Minisat::Solver*> solvers;
+	int numSolvers;
+	bool foundContradiction;
+
+public:
+	// The number of solvers defaults to the number of hardware threads,
+	// clamped to the range 2 to 4.
+	ezPortfolioSAT(int numSolvers = 0);
+	virtual ~ezPortfolioSAT();
+	virtual void clear();
+	virtual bool solver(const std::vector<int> &modelExpressions, std::vector<bool> &modelValues, const std::vector<int> &assumptions);
+
+	// Index of the solver that answered the last call, or -1.
+	int lastWinner;
+};
+
+#endif
@@ -49,6 +49,8 @@ ezSAT::ezSAT()
 
 	non_incremental_solve_used_up = false;
 
+	assumeGuard = 0;
+
 	cnfConsumed = false;
 	cnfVariableCount = 0;
 	cnfClausesCount = 0;
@@ -408,6 +410,15 @@ void ezSAT::assume(int id)
 {
 	addhash(__LINE__);
 	addhash(id);
+	addhash(assumeGuard);
+
+	int guard = assumeGuard != 0 ? -bind(assumeGuard) : 0;
+	auto add_assumed_clause = [&](std::vector<int> clause) {
+		if (guard != 0)
+			clause.push_back(guard);
+		cnfClauses.push_back(clause);
+		cnfClausesCount++;
+	};
 
 	if (id < 0)
 	{
@@ -422,22 +433,29 @@ void ezSAT::assume(int id)
 
 			if (op == OpNot) {
 				int idx = bind(args[0]);
-				cnfClauses.push_back(std::vector<int>(1, -idx));
-				cnfClausesCount++;
+				add_assumed_clause(std::vector<int>(1, -idx));
 				return;
 			}
 			if (op == OpOr) {
 				std::vector<int> clause;
 				for (int arg : args)
 					clause.push_back(bind(arg));
-				cnfClauses.push_back(clause);
-				cnfClausesCount++;
+				add_assumed_clause(clause);
 				return;
 			}
 			if (op == OpAnd) {
-				for (int arg : args) {
-					cnfClauses.push_back(std::vector<int>(1, bind(arg)));
-					cnfClausesCount++;
+				for (int arg : args)
+					assume(arg);
+				return;
+			}
+			if (op == OpIFF) {
+				// all arguments equal: two binary clauses per argument
+				// instead of the OR-of-ANDs encoding used by bind()
+				int idx0 = bind(args[0]);
+				for (int i = 1; i < int(args.size()); i++) {
+					int idx = bind(args[i]);
+					add_assumed_clause(std::vector<int>{idx0, -idx});
+					add_assumed_clause(std::vector<int>{-idx0, idx});
 				}
 				return;
 			}
@@ -445,8 +463,7 @@ void ezSAT::assume(int id)
 	}
 
 	int idx = bind(id);
-	cnfClauses.push_back(std::vector<int>(1, idx));
-	cnfClausesCount++;
+	add_assumed_clause(std::vector<int>(1, idx));
 }
 
 void ezSAT::add_clause(const std::vector<int> &args)
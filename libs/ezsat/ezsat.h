@@ -54,6 +54,8 @@ private:
 
 	bool non_incremental_solve_used_up;
 
+	int assumeGuard;
+
 	std::map<std::string, int> literalsCache;
 	std::vector<std::string> literals;
 
@@ -164,6 +166,13 @@ public:
 	virtual bool eliminated(int idx);
 	void assume(int id);
 	void assume(int id, int context_id) { assume(OR(id, NOT(context_id))); }
+
+	// while a guard is set, everything passed to assume() only holds when
+	// the guard is true (i.e. like assume(id, guard), but without building
+	// the OR expression). use a frozen literal and pass it as an assumption
+	// to solve() to enable the guarded constraints.
+	void set_assume_guard(int id) { assumeGuard = id; }
+	int assume_guard() const { return assumeGuard; }
 	int bind(int id, bool auto_freeze = true);
 	int bound(int id) const;
 
@@ -17,3 +17,4 @@ patch -p0 < 00_PATCH_remove_zlib.patch
 patch -p0 < 00_PATCH_no_fpu_control.patch
 patch -p0 < 00_PATCH_typofixes.patch
 patch -p0 < 00_PATCH_wasm.patch
+patch -p0 < 00_PATCH_atomic_interrupt.patch
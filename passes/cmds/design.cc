@@ -26,6 +26,75 @@ YOSYS_NAMESPACE_BEGIN
 std::map<std::string, RTLIL::Design*> saved_designs;
 std::vector<RTLIL::Design*> pushed_designs;
 
+// Saved and pushed designs share the modules they have in common with each other and with the current design,
+// copy-on-write (see Design::add_shared()). A module of the current design that has been handed out to a command
+// that changes modules may still be modified through pointers that the command holds on to, so it is copied when it
+// is saved. Modules that only commands that read the design have seen since they were loaded are shared.
+
+struct DesignCopyStats {
+	int copied = 0, reused = 0;
+	size_t reused_bytes = 0;
+	int64_t start_ns = PerformanceTimer::query();
+
+	void log_summary(const char *what)
+	{
+		if (copied == 0 && reused == 0)
+			return;
+		log("%s: copied %d module%s, reused %d module%s (about %.1f kB not copied).\n", what,
+				copied, copied == 1 ? "" : "s", reused, reused == 1 ? "" : "s", reused_bytes / 1024.0);
+		log("%s took %.2f ms.\n", what, (PerformanceTimer::query() - start_ns) / 1e6);
+	}
+};
+
+// A rough estimate of the memory used by a module, for reporting.
+static size_t module_size(const RTLIL::Module *module)
+{
+	auto sig_size = [](const RTLIL::SigSpec &sig) {
+		return sizeof(RTLIL::SigSpec) + GetSize(sig.chunks()) * sizeof(RTLIL::SigChunk);
+	};
+	auto attr_size = [](const dict<RTLIL::IdString, RTLIL::Const> &attributes) {
+		size_t size = 0;
+		for (auto &it : attributes)
+			size += sizeof(it) + GetSize(it.second);
+		return size;
+	};
+
+	size_t size = sizeof(RTLIL::Module) + attr_size(module->attributes);
+	for (auto &it : module->wires_)
+		size += sizeof(RTLIL::Wire) + attr_size(it.second->attributes);
+	for (auto &it : module->memories)
+		size += sizeof(RTLIL::Memory) + attr_size(it.second->attributes);
+	for (auto &it : module->cells_) {
+		size += sizeof(RTLIL::Cell) + attr_size(it.second->attributes) + attr_size(it.second->parameters);
+		for (auto &conn : it.second->connections())
+			size += sizeof(conn) + sig_size(conn.second);
+	}
+	for (auto &conn : module->connections_)
+		size += sig_size(conn.first) + sig_size(conn.second);
+	return size;
+}
+
+// Adds a module to the given design under the given name, replacing any module of that name. The module is shared
+// instead of copied unless it belongs to the current design and is not handed over to the target design.
+static void copy_module(RTLIL::Module *module, RTLIL::IdString name, RTLIL::Design *to_design, RTLIL::Design *current_design,
+		bool handover, DesignCopyStats &stats)
+{
+	auto it = to_design->modules_.find(name);
+	if (it != to_design->modules_.end())
+		to_design->remove(it->second);
+
+	if (name == module->name && (handover || module->is_shared() || module->design != current_design)) {
+		to_design->add_shared(module);
+		stats.reused++;
+		stats.reused_bytes += module_size(module);
+	} else {
+		RTLIL::Module *copy = module->clone();
+		copy->name = name;
+		to_design->add(copy);
+		stats.copied++;
+	}
+}
+
 struct DesignPass : public Pass {
 	DesignPass() : Pass("design", "save, restore and reset current design") { }
 	~DesignPass() override {
@@ -103,6 +172,16 @@ struct DesignPass : public Pass {
 		log("\n");
 		log("Delete the design previously saved under the given name.\n");
 		log("\n");
+		log("\n");
+		log("Saved designs and the current design share the modules they have in common.\n");
+		log("A shared module is copied when a command that changes modules first accesses\n");
+		log("it in the current design: the current design keeps the module and the saved\n");
+		log("designs get the copy. Commands that only read the design, such as 'ls',\n");
+		log("'select' or 'stat', don't copy modules. Modules of the current design that\n");
+		log("other commands have accessed are copied when they are saved. The number of\n");
+		log("copied and reused modules, an estimate of the memory saved and the time taken\n");
+		log("are printed to the log.\n");
+		log("\n");
 
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
@@ -221,7 +300,9 @@ struct DesignPass : public Pass {
 				argidx = args.size();
 			}
 
-			for (auto mod : copy_from_design->modules()) {
+			// iterate over modules_ so that modules shared with other designs are not copied
+			for (auto &it : copy_from_design->modules_) {
+				RTLIL::Module *mod = it.second;
 				if (sel.selected_whole_module(mod->name)) {
 					copy_src_modules.push_back(mod);
 					continue;
@@ -291,7 +372,7 @@ struct DesignPass : public Pass {
 				for (auto mod : old_queue)
 				for (auto cell : mod->cells())
 				{
-					Module *fmod = copy_from_design->module(cell->type);
+					const Module *fmod = static_cast<const RTLIL::Design*>(copy_from_design)->module(cell->type);
 
 					if (fmod == nullptr)
 						continue;
@@ -325,27 +406,25 @@ struct DesignPass : public Pass {
 			if (!as_name.empty() && copy_src_modules.size() > 1)
 				log_cmd_error("Only one module can be selected in combination with -as.\n");
 
+			DesignCopyStats stats;
 			for (auto mod : copy_src_modules)
 			{
 				std::string trg_name = as_name.empty() ? mod->name.str() : RTLIL::escape_id(as_name);
-
-				if (copy_to_design->module(trg_name) != nullptr)
-					copy_to_design->remove(copy_to_design->module(trg_name));
-
-				RTLIL::Module *t = mod->clone();
-				t->name = trg_name;
-				t->design = copy_to_design;
-				copy_to_design->add(t);
+				copy_module(mod, trg_name, copy_to_design, design, false, stats);
 			}
+			stats.log_summary(copy_from_design != design ? "Copying from saved design" : "Copying to saved design");
 		}
 
 		if (!save_name.empty() || push_mode || push_copy_mode)
 		{
 			RTLIL::Design *design_copy = new RTLIL::Design;
 
-			for (auto mod : design->modules())
-				design_copy->add(mod->clone());
+			// -stash and -push clear the current design right away, so its modules can be handed over
+			DesignCopyStats stats;
+			for (auto &it : design->modules_)
+				copy_module(it.second, it.first, design_copy, design, reset_mode || push_mode, stats);
 
+			design_copy->lazy_modules_ = design->lazy_modules_;
 			design_copy->selection_stack = design->selection_stack;
 			design_copy->selection_vars = design->selection_vars;
 			design_copy->selected_active_module = design->selected_active_module;
@@ -357,12 +436,19 @@ struct DesignPass : public Pass {
 				pushed_designs.push_back(design_copy);
 			else
 				saved_designs[save_name] = design_copy;
+
+			stats.log_summary("Saving design");
 		}
 
 		if (reset_mode || !load_name.empty() || push_mode || pop_mode)
 		{
-			for (auto mod : design->modules().to_vector())
+			// iterate over modules_ so that modules shared with other designs are not copied before being removed
+			std::vector<RTLIL::Module*> old_modules;
+			for (auto &it : design->modules_)
+				old_modules.push_back(it.second);
+			for (auto mod : old_modules)
 				design->remove(mod);
+			design->lazy_modules_.clear();
 
 			design->selection_stack.clear();
 			design->selection_vars.clear();
@@ -388,17 +474,22 @@ struct DesignPass : public Pass {
 		{
 			RTLIL::Design *saved_design = pop_mode ? pushed_designs.back() : saved_designs.at(load_name);
 
-			for (auto mod : saved_design->modules())
-				design->add(mod->clone());
+			DesignCopyStats stats;
+			for (auto &it : saved_design->modules_)
+				copy_module(it.second, it.first, design, design, false, stats);
+
+			design->lazy_modules_ = saved_design->lazy_modules_;
 
 			design->selection_stack = saved_design->selection_stack;
 			design->selection_vars = saved_design->selection_vars;
 			design->selected_active_module = saved_design->selected_active_module;
 
+			// the modules of a popped design are handed over to the current design
 			if (pop_mode) {
 				delete saved_design;
 				pushed_designs.pop_back();
 			}
+			stats.log_summary("Loading design");
 		}
 
 		if (!delete_name.empty())
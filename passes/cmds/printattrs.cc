@@ -23,7 +23,7 @@ USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
 struct PrintAttrsPass : public Pass {
-	PrintAttrsPass() : Pass("printattrs", "print attributes of selected objects") { }
+	PrintAttrsPass() : Pass("printattrs", "print attributes of selected objects") { read_only(); }
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -632,6 +632,9 @@ static void select_filter_active_mod(RTLIL::Design *design, RTLIL::Selection &se
 
 static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_empty_warning = false)
 {
+	// Evaluating a selection doesn't change any module, so shared modules are not copied here.
+	RTLIL::Design::ReadingOnlyScope reading_only(design);
+
 	std::string arg_mod, arg_memb;
 	std::unordered_map<std::string, bool> arg_mod_found;
 	std::unordered_map<std::string, bool> arg_memb_found;
@@ -1022,7 +1025,7 @@ YOSYS_NAMESPACE_END
 PRIVATE_NAMESPACE_BEGIN
 
 struct SelectPass : public Pass {
-	SelectPass() : Pass("select", "modify and view the list of selected objects") { }
+	SelectPass() : Pass("select", "modify and view the list of selected objects") { read_only(); }
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -1610,7 +1613,7 @@ struct SelectPass : public Pass {
 } SelectPass;
 
 struct CdPass : public Pass {
-	CdPass() : Pass("cd", "a shortcut for 'select -module <name>'") { }
+	CdPass() : Pass("cd", "a shortcut for 'select -module <name>'") { read_only(); }
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -1718,7 +1721,7 @@ static void log_matches(const char *title, Module *module, const T &list)
 }
 
 struct LsPass : public Pass {
-	LsPass() : Pass("ls", "list modules or objects in modules") { }
+	LsPass() : Pass("ls", "list modules or objects in modules") { read_only(); }
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
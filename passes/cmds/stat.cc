@@ -346,17 +346,20 @@ statdata_t hierarchy_worker(std::map<RTLIL::IdString, statdata_t> &mod_stat, RTL
 	return mod_data;
 }
 
-void read_liberty_cellarea(dict<IdString, cell_area_t> &cell_area, string liberty_file)
+// The parts of a liberty file used by read_liberty_cellarea().
+static const LibertyFilter liberty_filter = {
+	"/library/cell/area",
+	"/library/cell/ff",
+};
+
+void read_liberty_cellarea(RTLIL::Design *design, dict<IdString, cell_area_t> &cell_area, string liberty_file)
 {
-	std::ifstream f;
-	f.open(liberty_file.c_str());
 	yosys_input_files.insert(liberty_file);
-	if (f.fail())
+	std::shared_ptr<const LibertyAst> library = design->liberty_cache->load(liberty_file, liberty_filter);
+	if (library == nullptr)
 		log_cmd_error("Can't open liberty file `%s': %s\n", liberty_file.c_str(), strerror(errno));
-	LibertyParser libparser(f);
-	f.close();
 
-	for (auto cell : libparser.ast->children)
+	for (auto cell : library->children)
 	{
 		if (cell->id != "cell" || cell->args.size() != 1)
 			continue;
@@ -369,7 +372,10 @@ void read_liberty_cellarea(dict<IdString, cell_area_t> &cell_area, string libert
 }
 
 struct StatPass : public Pass {
-	StatPass() : Pass("stat", "print some statistics") { }
+	StatPass() : Pass("stat", "print some statistics") {
+		LibertyCache::register_filter(liberty_filter);
+		read_only();
+	}
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -418,7 +424,7 @@ struct StatPass : public Pass {
 			if (args[argidx] == "-liberty" && argidx+1 < args.size()) {
 				string liberty_file = args[++argidx];
 				rewrite_filename(liberty_file);
-				read_liberty_cellarea(cell_area, liberty_file);
+				read_liberty_cellarea(design, cell_area, liberty_file);
 				continue;
 			}
 			if (args[argidx] == "-tech" && argidx+1 < args.size()) {
@@ -19,6 +19,8 @@
 
 #include "kernel/yosys.h"
 #include "kernel/satgen.h"
+#include "kernel/workers.h"
+#include "kernel/randsim.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -58,7 +60,12 @@ struct EquivSimpleWorker
 			return true;
 
 		for (auto &conn : cell->connections())
-			if (yosys_celltypes.cell_input(cell->type, conn.first))
+			if (yosys_celltypes.cell_input(cell->type, conn.first)) {
+				// The SAT model of a $equiv cell is a buffer from A to Y, so B is
+				// not part of the cone. Like this the cones don't depend on the
+				// other $equiv cells that have been proven so far.
+				if (cell->type == ID($equiv) && conn.first == ID::B)
+					continue;
 				for (auto bit : sigmap(conn.second)) {
 					if (RTLIL::builtin_ff_cell_types().count(cell->type)) {
 						if (!conn.first.in(ID::CLK, ID::C))
@@ -66,6 +73,7 @@ struct EquivSimpleWorker
 					} else
 						find_input_cone(next_seed, cells_cone, bits_cone, cells_stop, bits_stop, input_bits, bit);
 				}
+			}
 		return false;
 	}
 
@@ -301,12 +309,28 @@ struct EquivSimplePass : public Pass {
 		log("    -seq <N>\n");
 		log("        the max. number of time steps to be considered (default = 1)\n");
 		log("\n");
+		log("    -sim <N>\n");
+		log("        before using SAT, simulate the module with N words of 64 random\n");
+		log("        patterns each, over as many time steps as the SAT problems. $equiv\n");
+		log("        cells whose inputs differ in simulation are not passed to SAT, and\n");
+		log("        $equiv cells whose inputs are the same signal are marked as proven\n");
+		log("        right away. The remaining cells go to SAT in the same groups by output\n");
+		log("        wire as without this option (see -nogroup): the bits of one wire\n");
+		log("        usually share most of their input cones, which the group solves only\n");
+		log("        once, while equal simulation values say nothing about shared logic.\n");
+		log("\n");
+		log("    -j <N>\n");
+		log("        prove up to N groups of $equiv cells at once in worker processes.\n");
+		log("        The results and the log output are the same as without this option.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, Design *design) override
 	{
 		bool verbose = false, short_cones = false, model_undef = false, nogroup = false;
 		int success_counter = 0;
 		int max_seq = 1;
+		int num_workers = 0;
+		int sim_words = 0;
 
 		log_header(design, "Executing EQUIV_SIMPLE pass.\n");
 
@@ -332,6 +356,14 @@ struct EquivSimplePass : public Pass {
 				max_seq = atoi(args[++argidx].c_str());
 				continue;
 			}
+			if (args[argidx] == "-sim" && argidx+1 < args.size()) {
+				sim_words = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-j" && argidx+1 < args.size()) {
+				num_workers = atoi(args[++argidx].c_str());
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
@@ -374,6 +406,45 @@ struct EquivSimplePass : public Pass {
 							bit2driver[bit] = cell;
 			}
 
+			// Cells that don't need to go to SAT after simulation.
+			pool<Cell*> skipped_cells;
+
+			if (sim_words > 0)
+			{
+				RandomSim sim(module, sigmap, sim_words);
+				sim.run(max_seq + 1);
+
+				int trivial_counter = 0, refuted_counter = 0;
+				for (auto &it : unproven_equiv_cells)
+				for (auto &it2 : it.second)
+				{
+					Cell *cell = it2.second;
+					SigBit bit_a = sigmap(cell->getPort(ID::A)).as_bit();
+					SigBit bit_b = sigmap(cell->getPort(ID::B)).as_bit();
+
+					if (bit_a == bit_b) {
+						cell->setPort(ID::B, cell->getPort(ID::A));
+						skipped_cells.insert(cell);
+						trivial_counter++;
+						continue;
+					}
+
+					for (int w = 0; w < sim_words; w++)
+						if ((sim.value(bit_a, w) ^ sim.value(bit_b, w)) & sim.known(bit_a, w) & sim.known(bit_b, w)) {
+							if (verbose)
+								log("  $equiv cell %s (%s) is refuted by simulation.\n", log_id(cell), log_signal(cell->getPort(ID::Y)));
+							skipped_cells.insert(cell);
+							refuted_counter++;
+							break;
+						}
+				}
+
+				log("Simulated %d random patterns: %d $equiv cells are trivially proven, %d are refuted.\n",
+						64 * sim_words, trivial_counter, refuted_counter);
+				success_counter += trivial_counter;
+			}
+
+			vector<vector<Cell*>> groups;
 			unproven_equiv_cells.sort();
 			for (auto it : unproven_equiv_cells)
 			{
@@ -381,11 +452,59 @@ struct EquivSimplePass : public Pass {
 
 				vector<Cell*> cells;
 				for (auto it2 : it.second)
-					cells.push_back(it2.second);
+					if (!skipped_cells.count(it2.second))
+						cells.push_back(it2.second);
+				if (!cells.empty())
+					groups.push_back(cells);
+			}
 
-				EquivSimpleWorker worker(cells, sigmap, bit2driver, max_seq, short_cones, verbose, model_undef);
-				success_counter += worker.run();
+			auto prove_groups = [&](int begin, int end) {
+				int counter = 0;
+				for (int i = begin; i < end; i++) {
+					EquivSimpleWorker worker(groups[i], sigmap, bit2driver, max_seq, short_cones, verbose, model_undef);
+					counter += worker.run();
+				}
+				return counter;
+			};
+
+			if (num_workers <= 1 || GetSize(groups) < 2 || !worker_processes_available()) {
+				success_counter += prove_groups(0, GetSize(groups));
+				continue;
 			}
+
+			// A $equiv cell is modelled as a buffer from A to Y and the cones
+			// don't include B, so proving a group doesn't change the problems
+			// of the other groups and the groups can be proven independently.
+			// Each job takes a range of groups and returns which of their cells
+			// it proved.
+			int num_jobs = std::min(GetSize(groups), num_workers * 8);
+			auto job_begin = [&](int job_idx) { return int(int64_t(job_idx) * GetSize(groups) / num_jobs); };
+
+			auto job = [&](int job_idx) {
+				prove_groups(job_begin(job_idx), job_begin(job_idx + 1));
+				std::string proven;
+				for (int i = job_begin(job_idx); i < job_begin(job_idx + 1); i++)
+					for (auto cell : groups[i])
+						proven += cell->getPort(ID::A) == cell->getPort(ID::B) ? '1' : '0';
+				return proven;
+			};
+
+			auto done = [&](int job_idx, WorkerResult &result) {
+				if (!result.ok) {
+					success_counter += prove_groups(job_begin(job_idx), job_begin(job_idx + 1));
+					return;
+				}
+				result.replay_log();
+				size_t pos = 0;
+				for (int i = job_begin(job_idx); i < job_begin(job_idx + 1); i++)
+					for (auto cell : groups[i])
+						if (pos < result.data.size() && result.data[pos++] == '1') {
+							cell->setPort(ID::B, cell->getPort(ID::A));
+							success_counter++;
+						}
+			};
+
+			run_worker_jobs(num_jobs, num_workers, job, done);
 		}
 
 		log("Proved %d previously unproven $equiv cells.\n", success_counter);
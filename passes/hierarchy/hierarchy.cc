@@ -19,7 +19,11 @@
  */
 
 #include "kernel/yosys.h"
+#include "kernel/workers.h"
+#include "frontends/ast/ast.h"
 #include "frontends/verific/verific.h"
+#include "frontends/rtlil/rtlil_frontend.h"
+#include "backends/rtlil/rtlil_backend.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <set>
@@ -318,8 +322,31 @@ struct IFExpander
 	}
 };
 
-// Get a module needed by a cell, either by deriving an abstract module or by
-// loading one from a directory in libdirs.
+// Where the time of the hierarchy pass goes, for the summary at the end of the pass.
+struct HierarchyStats
+{
+	int64_t derive_ns = 0, workers_ns = 0, read_ns = 0;
+	int derived = 0, derived_in_workers = 0, read = 0;
+};
+
+static HierarchyStats hierarchy_stats;
+
+// Derive a module, adding the time it takes to the statistics.
+template<typename F>
+static RTLIL::IdString timed_derive(RTLIL::Design *design, F derive)
+{
+	int num_modules = GetSize(design->modules_);
+	int64_t begin = PerformanceTimer::query();
+	RTLIL::IdString name = derive();
+	hierarchy_stats.derive_ns += PerformanceTimer::query() - begin;
+	if (GetSize(design->modules_) > num_modules)
+		hierarchy_stats.derived++;
+	return name;
+}
+
+// Get a module needed by a cell, either by deriving an abstract module, by
+// reading one that was indexed by 'read_verilog -lazy', or by loading one from
+// a directory in libdirs.
 //
 // If the module can't be found and check is true then exit with an error
 // message. Otherwise, return a pointer to the module if we derived or loaded
@@ -332,9 +359,18 @@ RTLIL::Module *get_module(RTLIL::Design                  &design,
                           const std::vector<std::string> &libdirs)
 {
 	std::string cell_type = cell.type.str();
+	if (design.has_lazy_module(cell.type)) {
+		int64_t begin = PerformanceTimer::query();
+		RTLIL::Module *mod = design.load_lazy_module(cell.type);
+		hierarchy_stats.read_ns += PerformanceTimer::query() - begin;
+		hierarchy_stats.read++;
+		if (!mod->name.begins_with("$abstract"))
+			return mod;
+	}
+
 	RTLIL::Module *abs_mod = design.module("$abstract" + cell_type);
 	if (abs_mod) {
-		cell.type = abs_mod->derive(&design, cell.parameters);
+		cell.type = timed_derive(&design, [&]() { return abs_mod->derive(&design, cell.parameters); });
 		cell.parameters.clear();
 		RTLIL::Module *mod = design.module(cell.type);
 		log_assert(mod);
@@ -359,7 +395,10 @@ RTLIL::Module *get_module(RTLIL::Design                  &design,
 			if (!check_file_exists(filename))
 				continue;
 
+			int64_t begin = PerformanceTimer::query();
 			Frontend::frontend_call(&design, NULL, filename, ext.second);
+			hierarchy_stats.read_ns += PerformanceTimer::query() - begin;
+			hierarchy_stats.read++;
 			RTLIL::Module *mod = design.module(cell.type);
 			if (!mod)
 				log_error("File `%s' from libdir does not declare module `%s'.\n",
@@ -439,6 +478,133 @@ void check_cell_connections(const RTLIL::Module &module, RTLIL::Cell &cell, RTLI
 	}
 }
 
+// Check if a derived module can be passed from a worker process to the main process as plain RTLIL, i.e. if nothing
+// will need its AST later.
+static bool derived_module_transferable(RTLIL::Module *module)
+{
+	if (module->get_bool_attribute(ID::interfaces_replaced_in_module) || module->get_bool_attribute(ID::is_interface))
+		return false;
+	for (auto wire : module->wires())
+		if (wire->get_bool_attribute(ID::is_interface))
+			return false;
+	for (auto cell : module->cells())
+		if (cell->has_attribute(ID::reprocess_after) || cell->get_bool_attribute(ID::is_interface))
+			return false;
+	return true;
+}
+
+// Name positional parameters ($1, $2, ...) like AstModule::derive() does, so that the same parameterization
+// given by position and by name is derived once.
+static dict<RTLIL::IdString, RTLIL::Const> normalize_parameters(const AST::AstModule *module,
+		const dict<RTLIL::IdString, RTLIL::Const> &parameters)
+{
+	dict<RTLIL::IdString, RTLIL::Const> normalized = parameters;
+	int para_counter = 0;
+	for (auto child : module->ast->children) {
+		if (child->type != AST::AST_PARAMETER)
+			continue;
+		para_counter++;
+		RTLIL::IdString positional = stringf("$%d", para_counter);
+		auto it = normalized.find(positional);
+		if (it == normalized.end())
+			continue;
+		if (!normalized.count(child->str))
+			normalized[child->str] = it->second;
+		normalized.erase(positional);
+	}
+	normalized.sort();
+	return normalized;
+}
+
+// Derive the modules for the cells with parameters in the used modules in worker processes, before expand_module()
+// gets to them. Derivations that involve interfaces or that depend on modules that are not in the design yet are
+// left to expand_module(), as are derivations that fail.
+static void derive_in_workers(RTLIL::Design *design, const std::set<RTLIL::Module*, IdString::compare_ptr_by_name<Module>> &used_modules,
+		int num_workers)
+{
+	std::vector<std::pair<RTLIL::IdString, dict<RTLIL::IdString, RTLIL::Const>>> jobs;
+	pool<std::pair<RTLIL::IdString, dict<RTLIL::IdString, RTLIL::Const>>> seen;
+
+	for (auto module : used_modules)
+	for (auto cell : module->cells())
+	{
+		if (cell->parameters.empty() || cell->type.begins_with("$array:") || design->has_lazy_module(cell->type))
+			continue;
+		RTLIL::Module *mod = design->module(cell->type);
+		if (mod == nullptr && cell->type.begins_with("\\"))
+			mod = design->module("$abstract" + cell->type.str());
+		if (mod == nullptr || dynamic_cast<AST::AstModule*>(mod) == nullptr || mod->get_blackbox_attribute() ||
+				mod->get_bool_attribute(ID::is_interface))
+			continue;
+		bool has_interface_ports = false;
+		for (auto wire : mod->wires())
+			if (wire->get_bool_attribute(ID::is_interface))
+				has_interface_ports = true;
+		if (has_interface_ports)
+			continue;
+		auto job = std::make_pair(mod->name, normalize_parameters(static_cast<AST::AstModule*>(mod), cell->parameters));
+		if (seen.insert(job).second)
+			jobs.push_back(job);
+	}
+
+	if (GetSize(jobs) < 2)
+		return;
+
+	// Runs in a worker process: derive the module and return its name and the module as binary RTLIL.
+	auto job = [&](int idx) {
+		RTLIL::Module *mod = design->module(jobs[idx].first);
+		int num_modules = GetSize(design->modules_);
+		RTLIL::IdString name;
+		if (mod->name.begins_with("$abstract"))
+			name = mod->derive(design, jobs[idx].second);
+		else
+			name = mod->derive(design, jobs[idx].second, dict<RTLIL::IdString, RTLIL::Module*>(), dict<RTLIL::IdString, RTLIL::IdString>());
+
+		RTLIL::Module *derived = design->module(name);
+		if (GetSize(design->modules_) != num_modules + 1 || derived == nullptr || !derived_module_transferable(derived))
+			return std::string();
+
+		RTLIL::Selection selection(false);
+		selection.selected_modules.insert(name);
+		std::string active_module = design->selected_active_module;
+		design->selected_active_module.clear();
+		design->selection_stack.push_back(selection);
+		std::ostringstream rtlil;
+		RTLIL_BACKEND::dump_design_binary(rtlil, design, true);
+		design->selection_stack.pop_back();
+		design->selected_active_module = active_module;
+		return name.str() + "\n" + rtlil.str();
+	};
+
+	auto done = [&](int, WorkerResult &result) {
+		if (!result.ok || result.data.empty())
+			return;
+		size_t eol = result.data.find('\n');
+		RTLIL::IdString name = result.data.substr(0, eol);
+		if (design->has(name))
+			return;
+
+		result.replay_log(design);
+		std::istringstream rtlil(result.data.substr(eol + 1));
+		RTLIL::Design *derived = new RTLIL::Design;
+		RTLIL_FRONTEND::flag_nooverwrite = false;
+		RTLIL_FRONTEND::flag_overwrite = false;
+		RTLIL_FRONTEND::flag_lib = false;
+		RTLIL_FRONTEND::parse_binary(rtlil, "<hierarchy -j>", derived);
+		RTLIL::Module *mod = derived->module(name);
+		log_assert(mod != nullptr);
+		derived->modules_.erase(name);
+		design->add(mod);
+		delete derived;
+		hierarchy_stats.derived_in_workers++;
+	};
+
+	log("Deriving %d modules in %d worker processes.\n", GetSize(jobs), std::min(num_workers, GetSize(jobs)));
+	int64_t begin = PerformanceTimer::query();
+	run_worker_jobs(GetSize(jobs), num_workers, job, done);
+	hierarchy_stats.workers_ns += PerformanceTimer::query() - begin;
+}
+
 bool expand_module(RTLIL::Design *design, RTLIL::Module *module, bool flag_check, bool flag_simcheck, bool flag_smtcheck,
 		   std::vector<std::string> &libdirs)
 {
@@ -527,10 +693,12 @@ bool expand_module(RTLIL::Design *design, RTLIL::Module *module, bool flag_check
 			continue;
 		}
 
-		cell->type = mod->derive(design,
-					 cell->parameters,
-					 if_expander.interfaces_to_add_to_submodule,
-					 if_expander.modports_used_in_submodule);
+		cell->type = timed_derive(design, [&]() {
+			return mod->derive(design,
+					   cell->parameters,
+					   if_expander.interfaces_to_add_to_submodule,
+					   if_expander.modports_used_in_submodule);
+		});
 		cell->parameters.clear();
 		did_something = true;
 
@@ -728,6 +896,10 @@ RTLIL::Wire *find_implicit_port_wire(Module *module, Cell *cell, const std::stri
 
 struct HierarchyPass : public Pass {
 	HierarchyPass() : Pass("hierarchy", "check, expand and clean up design hierarchy") { }
+	void on_shutdown() override
+	{
+		AST::derive_cache.clear();
+	}
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -800,6 +972,27 @@ struct HierarchyPass : public Pass {
 		log("       This option can be specified multiple times to override multiple\n");
 		log("       parameters. String values must be passed in double quotes (\").\n");
 		log("\n");
+		log("    -j <N>\n");
+		log("        derive up to N parameterized modules at once in worker processes.\n");
+		log("        Modules derived this way are plain RTLIL modules without the AST\n");
+		log("        they were derived from. Modules with interfaces, modules that refer\n");
+		log("        to modules that are not derived yet and modules that fail to derive\n");
+		log("        are derived one after another as usual.\n");
+		log("\n");
+		log("    -nocache\n");
+		log("        do not use the derive cache, and free the modules it holds. The derive\n");
+		log("        cache keeps the modules derived by this pass, keyed by the AST of the\n");
+		log("        module they were derived from and the parameters, so that they don't\n");
+		log("        have to be derived again when the pass runs again (e.g. after reading\n");
+		log("        the design again). Modules whose derivation looked up other modules or\n");
+		log("        caused warnings are not cached. The cache holds modules with up to\n");
+		log("        a million wires and cells in total, the least recently used modules\n");
+		log("        are dropped first. It is freed when Yosys exits.\n");
+		log("\n");
+		log("    -stats\n");
+		log("        print how much time was spent deriving modules (in this process and in\n");
+		log("        worker processes), reading modules and on everything else.\n");
+		log("\n");
 		log("In -generate mode this pass generates blackbox modules for the given cell\n");
 		log("types (wildcards supported). For this the design is searched for cells that\n");
 		log("match the given types and then the given port declarations are used to\n");
@@ -813,6 +1006,9 @@ struct HierarchyPass : public Pass {
 		log("using positional arguments). When <num> is not specified, the <portname> can\n");
 		log("also contain wildcard characters.\n");
 		log("\n");
+		log("Modules that were indexed by 'read_verilog -lazy' are read when this pass\n");
+		log("finds the first cell that instantiates them.\n");
+		log("\n");
 		log("This pass ignores the current selection and always operates on all modules\n");
 		log("in the current design.\n");
 		log("\n");
@@ -836,6 +1032,9 @@ struct HierarchyPass : public Pass {
 		bool nodefaults = false;
 		bool nokeep_prints = false;
 		bool nokeep_asserts = false;
+		bool nocache = false;
+		bool print_stats = false;
+		int num_workers = 0;
 		std::vector<std::string> generate_cells;
 		std::vector<generate_port_decl_t> generate_ports;
 		std::map<std::string, std::string> parameters;
@@ -918,6 +1117,18 @@ struct HierarchyPass : public Pass {
 				nokeep_asserts = true;
 				continue;
 			}
+			if (args[argidx] == "-nocache") {
+				nocache = true;
+				continue;
+			}
+			if (args[argidx] == "-stats") {
+				print_stats = true;
+				continue;
+			}
+			if (args[argidx] == "-j" && argidx+1 < args.size()) {
+				num_workers = atoi(args[++argidx].c_str());
+				continue;
+			}
 			if (args[argidx] == "-libdir" && argidx+1 < args.size()) {
 				libdirs.push_back(args[++argidx]);
 				continue;
@@ -946,10 +1157,31 @@ struct HierarchyPass : public Pass {
 		}
 		extra_args(args, argidx, design, false);
 
+		hierarchy_stats = HierarchyStats();
+		int64_t begin_ns = PerformanceTimer::query();
+		int cache_hits_before = AST::derive_cache.hits;
+
+		// The derive cache is only used by this pass, as other passes may derive
+		// modules in ways that the key of the cache doesn't capture.
+		struct DeriveCacheGuard {
+			DeriveCacheGuard(bool enable) {
+				AST::derive_cache.enabled = enable;
+				if (!enable)
+					AST::derive_cache.clear();
+			}
+			~DeriveCacheGuard() { AST::derive_cache.enabled = false; }
+		} derive_cache_guard(!nocache);
+
 		if (!load_top_mod.empty())
 		{
 			IdString top_name = RTLIL::escape_id(load_top_mod);
 			IdString abstract_id = "$abstract" + RTLIL::escape_id(load_top_mod);
+			if (design->has_lazy_module(top_name)) {
+				int64_t begin = PerformanceTimer::query();
+				design->load_lazy_module(top_name);
+				hierarchy_stats.read_ns += PerformanceTimer::query() - begin;
+				hierarchy_stats.read++;
+			}
 			top_mod = design->module(top_name);
 
 			dict<RTLIL::IdString, RTLIL::Const> top_parameters;
@@ -963,9 +1195,9 @@ struct HierarchyPass : public Pass {
 			}
 
 			if (top_mod == nullptr && design->module(abstract_id))
-				top_mod = design->module(design->module(abstract_id)->derive(design, top_parameters));
+				top_mod = design->module(timed_derive(design, [&]() { return design->module(abstract_id)->derive(design, top_parameters); }));
 			else if (top_mod != nullptr && !top_parameters.empty())
-				top_mod = design->module(top_mod->derive(design, top_parameters));
+				top_mod = design->module(timed_derive(design, [&]() { return top_mod->derive(design, top_parameters); }));
 
 			if (top_mod != nullptr && top_mod->name != top_name) {
 				Module *m = top_mod->clone();
@@ -1013,7 +1245,7 @@ struct HierarchyPass : public Pass {
 				if (module->name.begins_with("$abstract"))
 					abstract_ids.push_back(module->name);
 			for (auto abstract_id : abstract_ids)
-				design->module(abstract_id)->derive(design, {});
+				timed_derive(design, [&]() { return design->module(abstract_id)->derive(design, {}); });
 			for (auto abstract_id : abstract_ids)
 				design->remove(design->module(abstract_id));
 		}
@@ -1042,7 +1274,7 @@ struct HierarchyPass : public Pass {
 				top_parameters[RTLIL::escape_id(para.first)] = sig_value.as_const();
 			}
 
-			top_mod = design->module(top_mod->derive(design, top_parameters));
+			top_mod = design->module(timed_derive(design, [&]() { return top_mod->derive(design, top_parameters); }));
 
 			if (top_mod != nullptr && top_mod->name != top_name) {
 				Module *m = top_mod->clone();
@@ -1080,6 +1312,9 @@ struct HierarchyPass : public Pass {
 					used_modules.insert(mod);
 			}
 
+			if (num_workers > 1 && worker_processes_available())
+				derive_in_workers(design, used_modules, num_workers);
+
 			for (auto module : used_modules) {
 				if (expand_module(design, module, flag_check, flag_simcheck, flag_smtcheck, libdirs))
 					did_something = true;
@@ -1476,6 +1711,25 @@ struct HierarchyPass : public Pass {
 		for (auto module : blackbox_derivatives)
 			design->remove(module);
 
+		if (hierarchy_stats.derived || hierarchy_stats.derived_in_workers || hierarchy_stats.read) {
+			double total_ms = (PerformanceTimer::query() - begin_ns) / 1e6;
+			double derive_ms = hierarchy_stats.derive_ns / 1e6, workers_ms = hierarchy_stats.workers_ns / 1e6;
+			double read_ms = hierarchy_stats.read_ns / 1e6;
+			log("\n");
+			log("Derived %d modules (%d from the derive cache), read %d modules (read_verilog -lazy or -libdir).\n",
+					hierarchy_stats.derived, AST::derive_cache.hits - cache_hits_before, hierarchy_stats.read);
+			if (num_workers > 1)
+				log("Derived %d modules in worker processes.\n", hierarchy_stats.derived_in_workers);
+			if (print_stats) {
+				log("Time spent in the hierarchy pass: %.2f ms\n", total_ms);
+				log("  deriving modules: %.2f ms\n", derive_ms);
+				if (num_workers > 1)
+					log("  deriving modules in worker processes: %.2f ms\n", workers_ms);
+				log("  reading modules: %.2f ms\n", read_ms);
+				log("  everything else: %.2f ms\n", total_ms - derive_ms - workers_ms - read_ms);
+			}
+		}
+
 		log_pop();
 	}
 } HierarchyPass;
@@ -104,7 +104,7 @@ struct MemQueryCache
 		int aeq = addr_eq(port.addr, wport.addr);
 		int wen_sat = qcsat.importSigBit(wen);
 		qcsat.prepare();
-		bool res = qcsat.ez->solve(aeq, wen_sat, port_ren);
+		bool res = qcsat.solve(aeq, wen_sat, port_ren);
 		cache_can_collide_rdwr[key] = res;
 		return res;
 	}
@@ -125,7 +125,7 @@ struct MemQueryCache
 		int wen1_sat = qcsat.importSigBit(wen1);
 		int wen2_sat = qcsat.importSigBit(wen2);
 		qcsat.prepare();
-		bool res = qcsat.ez->solve(wen1_sat, wen2_sat, aeq1, aeq2, port_ren);
+		bool res = qcsat.solve(wen1_sat, wen2_sat, aeq1, aeq2, port_ren);
 		cache_can_collide_together[key] = res;
 		return res;
 	}
@@ -145,7 +145,7 @@ struct MemQueryCache
 		if (neg_sel)
 			sel_sat = qcsat.ez->NOT(sel_sat);
 		qcsat.prepare();
-		bool res = !qcsat.ez->solve(port_ren, qcsat.ez->XOR(sel_expected, sel_sat));
+		bool res = !qcsat.solve(port_ren, qcsat.ez->XOR(sel_expected, sel_sat));
 		cache_is_w2rbyp[key] = res;
 		return res;
 	}
@@ -161,7 +161,7 @@ struct MemQueryCache
 		if (neg_sel)
 			sel_sat = qcsat.ez->NOT(sel_sat);
 		qcsat.prepare();
-		bool res = !qcsat.ez->solve(port_ren, sel_sat);
+		bool res = !qcsat.solve(port_ren, sel_sat);
 		cache_impossible_with_ren[key] = res;
 		return res;
 	}
@@ -186,11 +186,11 @@ struct MemQueryCache
 		for (int i = 0; i < GetSize(sig_s); i++) {
 			int sbit = qcsat.importSigBit(sig_s[i]);
 			qcsat.prepare();
-			if (!qcsat.ez->solve(port_ren, sel_sat, qcsat.ez->NOT(sbit))) {
+			if (!qcsat.solve(port_ren, sel_sat, qcsat.ez->NOT(sbit))) {
 				bit = driver.cell->getPort(ID::B)[i * width + driver.offset];
 				return true;
 			}
-			if (qcsat.ez->solve(port_ren, sel_sat, sbit))
+			if (qcsat.solve(port_ren, sel_sat, sbit))
 				all_0 = false;
 		}
 		if (all_0) {
@@ -607,13 +607,14 @@ struct MemoryDffWorker
 	void run()
 	{
 		std::vector<Mem> memories = Mem::get_selected_memories(module);
+		QuickConeSat qcsat(modwalker);
 		for (auto &mem : memories) {
-			QuickConeSat qcsat(modwalker);
 			for (int i = 0; i < GetSize(mem.rd_ports); i++) {
 				if (!mem.rd_ports[i].clk_enable)
 					handle_rd_port(mem, qcsat, i);
 			}
 		}
+		qcsat.log_stats();
 		for (auto &mem : memories) {
 			for (int i = 0; i < GetSize(mem.rd_ports); i++) {
 				if (!mem.rd_ports[i].clk_enable)
@@ -132,11 +132,12 @@ typedef std::vector<MemConfig> MemConfigs;
 struct MapWorker {
 	Module *module;
 	ModWalker modwalker;
+	QuickConeSat qcsat;
 	SigMap sigmap;
 	SigMap sigmap_xmux;
 	FfInitVals initvals;
 
-	MapWorker(Module *module) : module(module), modwalker(module->design, module), sigmap(module), sigmap_xmux(module), initvals(&sigmap, module) {
+	MapWorker(Module *module) : module(module), modwalker(module->design, module), qcsat(modwalker), sigmap(module), sigmap_xmux(module), initvals(&sigmap, module) {
 		for (auto cell : module->cells())
 		{
 			if (cell->type == ID($mux))
@@ -170,7 +171,7 @@ struct Swizzle {
 
 struct MemMapping {
 	MapWorker &worker;
-	QuickConeSat qcsat;
+	QuickConeSat &qcsat;
 	Mem &mem;
 	const Library &lib;
 	const PassOptions &opts;
@@ -185,7 +186,7 @@ struct MemMapping {
 	dict<std::pair<int, int>, bool> wr_excludes_srst_cache;
 	std::string rejected_cfg_debug_msgs;
 
-	MemMapping(MapWorker &worker, Mem &mem, const Library &lib, const PassOptions &opts) : worker(worker), qcsat(worker.modwalker), mem(mem), lib(lib), opts(opts) {
+	MemMapping(MapWorker &worker, Mem &mem, const Library &lib, const PassOptions &opts) : worker(worker), qcsat(worker.qcsat), mem(mem), lib(lib), opts(opts) {
 		determine_style();
 		logic_ok = determine_logic_ok();
 		if (GetSize(mem.wr_ports) == 0)
@@ -260,7 +261,7 @@ struct MemMapping {
 		int wr_en = get_wr_en(wpidx);
 		int rd_en = qcsat.importSigBit(mem.rd_ports[rpidx].en[0]);
 		qcsat.prepare();
-		bool res = !qcsat.ez->solve(wr_en, qcsat.ez->NOT(rd_en));
+		bool res = !qcsat.solve(wr_en, qcsat.ez->NOT(rd_en));
 		wr_implies_rd_cache.insert({key, res});
 		return res;
 	}
@@ -273,7 +274,7 @@ struct MemMapping {
 		int wr_en = get_wr_en(wpidx);
 		int rd_en = qcsat.importSigBit(mem.rd_ports[rpidx].en[0]);
 		qcsat.prepare();
-		bool res = !qcsat.ez->solve(wr_en, rd_en);
+		bool res = !qcsat.solve(wr_en, rd_en);
 		wr_excludes_rd_cache.insert({key, res});
 		return res;
 	}
@@ -290,7 +291,7 @@ struct MemMapping {
 			srst = qcsat.ez->AND(srst, rd_en);
 		}
 		qcsat.prepare();
-		bool res = !qcsat.ez->solve(wr_en, srst);
+		bool res = !qcsat.solve(wr_en, srst);
 		wr_excludes_srst_cache.insert({key, res});
 		return res;
 	}
@@ -2260,6 +2261,7 @@ struct MemoryLibMapPass : public Pass {
 					map.emit(map.cfgs[idx]);
 				}
 			}
+			worker.qcsat.log_stats();
 		}
 	}
 } MemoryLibMapPass;
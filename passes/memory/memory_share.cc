@@ -293,7 +293,7 @@ struct MemoryShareWorker
 	// Consolidate write ports using sat-based resource sharing
 	// --------------------------------------------------------
 
-	void consolidate_wr_using_sat(Mem &mem)
+	void consolidate_wr_using_sat(Mem &mem, QuickConeSat &qcsat)
 	{
 		if (GetSize(mem.wr_ports) <= 1)
 			return;
@@ -378,8 +378,6 @@ struct MemoryShareWorker
 
 			// Okay, time to actually run the SAT solver.
 
-			QuickConeSat qcsat(modwalker);
-
 			// create SAT representation of common input cone of all considered EN signals
 
 			dict<int, int> port_to_sat_variable;
@@ -389,7 +387,7 @@ struct MemoryShareWorker
 
 			qcsat.prepare();
 
-			log("  Common input cone for all EN signals: %d cells.\n", GetSize(qcsat.imported_cells));
+			log("  Common input cone for all EN signals: %d cells (SAT model of the module so far).\n", GetSize(qcsat.imported_cells));
 
 			log("  Size of unconstrained SAT problem: %d variables, %d clauses\n", qcsat.ez->numCnfVariables(), qcsat.ez->numCnfClauses());
 
@@ -406,7 +404,7 @@ struct MemoryShareWorker
 					if (port2.removed)
 						continue;
 
-					if (qcsat.ez->solve(port_to_sat_variable.at(idx1), port_to_sat_variable.at(idx2))) {
+					if (qcsat.solve(port_to_sat_variable.at(idx1), port_to_sat_variable.at(idx2))) {
 						log("  According to SAT solver sharing of port %d with port %d is not possible.\n", idx1, idx2);
 						continue;
 					}
@@ -502,9 +500,12 @@ struct MemoryShareWorker
 			return;
 
 		modwalker.setup(module);
+		QuickConeSat qcsat(modwalker);
 
 		for (auto &mem : memories)
-			consolidate_wr_using_sat(mem);
+			consolidate_wr_using_sat(mem, qcsat);
+
+		qcsat.log_stats();
 	}
 };
 
@@ -49,9 +49,9 @@ struct OptMemPriorityPass : public Pass {
 		int total_count = 0;
 		for (auto module : design->selected_modules()) {
 			modwalker.setup(module);
+			QuickConeSat qcsat(modwalker);
 			for (auto &mem : Mem::get_selected_memories(module)) {
 				bool mem_changed = false;
-				QuickConeSat qcsat(modwalker);
 				for (int i = 0; i < GetSize(mem.wr_ports); i++) {
 					auto &wport1 = mem.wr_ports[i];
 					for (int j = 0; j < GetSize(mem.wr_ports); j++) {
@@ -81,7 +81,7 @@ struct OptMemPriorityPass : public Pass {
 							int wen1_sat = qcsat.importSigBit(wen1);
 							int wen2_sat = qcsat.importSigBit(wen2);
 							qcsat.prepare();
-							if (qcsat.ez->solve(wen1_sat, wen2_sat, addr_eq)) {
+							if (qcsat.solve(wen1_sat, wen2_sat, addr_eq)) {
 								ok = false;
 								break;
 							}
@@ -97,6 +97,7 @@ struct OptMemPriorityPass : public Pass {
 				if (mem_changed)
 					mem.emit();
 			}
+			qcsat.log_stats();
 		}
 
 		if (total_count)
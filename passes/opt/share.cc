@@ -1276,14 +1276,14 @@ struct ShareWorker
 				qcsat.prepare();
 
 				int sub1 = qcsat.ez->expression(qcsat.ez->OpOr, cell_active);
-				if (!qcsat.ez->solve(sub1)) {
+				if (!qcsat.solve(sub1)) {
 					log("      According to the SAT solver the cell %s is never active. Sharing is pointless, we simply remove it.\n", log_id(cell));
 					cells_to_remove.insert(cell);
 					break;
 				}
 
 				int sub2 = qcsat.ez->expression(qcsat.ez->OpOr, other_cell_active);
-				if (!qcsat.ez->solve(sub2)) {
+				if (!qcsat.solve(sub2)) {
 					log("      According to the SAT solver the cell %s is never active. Sharing is pointless, we simply remove it.\n", log_id(other_cell));
 					cells_to_remove.insert(other_cell);
 					shareable_cells.erase(other_cell);
@@ -1301,7 +1301,7 @@ struct ShareWorker
 				log("      Size of SAT problem: %d cells, %d variables, %d clauses\n",
 						GetSize(sat_cells), qcsat.ez->numCnfVariables(), qcsat.ez->numCnfClauses());
 
-				if (qcsat.ez->solve(sat_model, sat_model_values)) {
+				if (qcsat.solve(sat_model, sat_model_values)) {
 					log("      According to the SAT solver this pair of cells can not be shared.\n");
 					log("      Model from SAT solver: %s = %d'", log_signal(all_ctrl_signals), GetSize(sat_model_values));
 					for (int i = GetSize(sat_model_values)-1; i >= 0; i--)
@@ -0,0 +1,589 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+#include "kernel/sigtools.h"
+#include "kernel/celltypes.h"
+#include "kernel/satgen.h"
+#include "kernel/randsim.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct FraigOptions
+{
+	int sim_words = 4;
+	bool inv_mode = false;
+	bool equiv_mode = false;
+	bool verbose = false;
+	int timeout = 0;
+};
+
+struct FraigWorker
+{
+	RTLIL::Design *design;
+	RTLIL::Module *module;
+	const FraigOptions &opts;
+
+	SigMap sigmap;
+	CellTypes ct;
+
+	// Driving cell and topological depth of every combinational signal bit.
+	// Bits that are not driven by a combinational cell have depth 0.
+	dict<RTLIL::SigBit, RTLIL::Cell*> drivers;
+	dict<RTLIL::SigBit, int> depth;
+
+	// Bits that depend on x or z constants. SatGen models these constants as
+	// 0, so these bits are neither merged nor used to prove $equiv cells.
+	pool<RTLIL::SigBit> undef_driven;
+
+	// Signals proven equal are merged in the SigMap used for SAT, so that
+	// logic imported later refers to the representatives directly.
+	SigMap sat_sigmap;
+	ezSatPtr ez;
+	SatGen satgen;
+	pool<RTLIL::Cell*> imported_cells;
+
+	// The inputs of the imported logic cones, whose values in the SAT models
+	// are replayed in simulation to refute later candidates without SAT.
+	std::vector<RTLIL::SigBit> leaf_bits;
+	std::vector<int> leaf_lits;
+	pool<RTLIL::SigBit> leaf_pool;
+	std::unique_ptr<RandomSim> cex_sim;
+	int cex_count = 0;
+	bool cex_pending = false;
+
+	int sat_calls = 0, proved = 0, proved_inv = 0, proved_const = 0, refuted = 0, refuted_sim = 0, timeouts = 0;
+
+	struct equiv_bit_t
+	{
+		RTLIL::SigBit bit;
+		bool inverted;
+	};
+
+	FraigWorker(RTLIL::Design *design, RTLIL::Module *module, const FraigOptions &opts) :
+			design(design), module(module), opts(opts), sigmap(module), sat_sigmap(module), satgen(ez.get(), &sat_sigmap)
+	{
+		if (opts.timeout > 0)
+			ez->setSolverTimeout(opts.timeout);
+		ct.setup_internals();
+		ct.setup_stdcells();
+	}
+
+	bool is_sweepable(RTLIL::Cell *cell)
+	{
+		// The sources of free values are better left as inputs. A $equiv cell
+		// is modelled as a buffer from A to Y.
+		if (cell->type.in(ID($anyconst), ID($anyseq), ID($allconst), ID($allseq), ID($initstate)))
+			return false;
+		return ct.cell_known(cell->type);
+	}
+
+	void find_drivers()
+	{
+		pool<RTLIL::SigBit> multi_driven;
+		dict<RTLIL::Cell*, int> pending;
+		dict<RTLIL::SigBit, pool<RTLIL::Cell*>> users;
+
+		for (auto cell : module->cells()) {
+			if (!is_sweepable(cell))
+				continue;
+			for (auto &conn : cell->connections())
+				if (ct.cell_output(cell->type, conn.first))
+					for (auto bit : sigmap(conn.second)) {
+						if (bit.wire == nullptr)
+							continue;
+						if (drivers.count(bit))
+							multi_driven.insert(bit);
+						drivers[bit] = cell;
+					}
+		}
+		for (auto bit : multi_driven)
+			drivers.erase(bit);
+
+		// Kahn's algorithm over the combinational cells. Cells on a logic loop
+		// are never reached, so their outputs don't get a depth.
+		std::vector<RTLIL::Cell*> queue;
+		for (auto cell : module->cells()) {
+			if (!is_sweepable(cell))
+				continue;
+			pool<RTLIL::Cell*> deps;
+			for (auto &conn : cell->connections())
+				if (!ct.cell_output(cell->type, conn.first))
+					for (auto bit : sigmap(conn.second)) {
+						auto it = drivers.find(bit);
+						if (it != drivers.end() && it->second != cell && !deps.count(it->second)) {
+							deps.insert(it->second);
+							users[bit].insert(cell);
+						}
+					}
+			pending[cell] = GetSize(deps);
+			if (deps.empty())
+				queue.push_back(cell);
+		}
+
+		dict<RTLIL::Cell*, pool<RTLIL::Cell*>> cell_users;
+		for (auto &it : users)
+			for (auto user : it.second)
+				cell_users[drivers.at(it.first)].insert(user);
+
+		for (size_t i = 0; i < queue.size(); i++) {
+			RTLIL::Cell *cell = queue[i];
+			int d = 0;
+			bool undef = false;
+			for (auto &conn : cell->connections())
+				if (!ct.cell_output(cell->type, conn.first))
+					for (auto bit : sigmap(conn.second)) {
+						if (drivers.count(bit) && drivers.at(bit) != cell)
+							d = std::max(d, depth.at(bit));
+						if (bit == State::Sx || bit == State::Sz || undef_driven.count(bit))
+							undef = true;
+					}
+			for (auto &conn : cell->connections())
+				if (ct.cell_output(cell->type, conn.first))
+					for (auto bit : sigmap(conn.second))
+						if (drivers.count(bit) && drivers.at(bit) == cell) {
+							depth[bit] = d + 1;
+							if (undef)
+								undef_driven.insert(bit);
+						}
+			for (auto user : cell_users[cell])
+				if (--pending.at(user) == 0)
+					queue.push_back(user);
+		}
+	}
+
+	int bit_depth(RTLIL::SigBit bit)
+	{
+		if (bit.wire == nullptr)
+			return -1;
+		if (drivers.count(bit))
+			return depth.count(bit) ? depth.at(bit) : INT_MAX;
+		return 0;
+	}
+
+	int import_bit(RTLIL::SigBit bit)
+	{
+		std::vector<RTLIL::SigBit> stack = {bit};
+		while (!stack.empty()) {
+			RTLIL::SigBit b = stack.back();
+			stack.pop_back();
+			auto it = drivers.find(b);
+			if (it == drivers.end() && b.wire != nullptr && !leaf_pool.count(b)) {
+				leaf_pool.insert(b);
+				leaf_bits.push_back(b);
+				leaf_lits.push_back(satgen.importSigSpec(b).front());
+			}
+			if (it == drivers.end() || imported_cells.count(it->second))
+				continue;
+			RTLIL::Cell *cell = it->second;
+			imported_cells.insert(cell);
+			// Outputs of cells SatGen can't model are left unconstrained,
+			// which can only make proofs fail.
+			if (!satgen.importCell(cell) && opts.verbose)
+				log("    Leaving outputs of %s cell %s unconstrained.\n", log_id(cell->type), log_id(cell));
+			for (auto &conn : cell->connections())
+				if (!ct.cell_output(cell->type, conn.first))
+					for (auto in : sigmap(conn.second))
+						stack.push_back(in);
+		}
+		return satgen.importSigSpec(bit).front();
+	}
+
+	// Stores a counterexample in the next pattern of the counterexample
+	// simulation, overwriting the oldest one.
+	void add_cex(const std::vector<bool> &model)
+	{
+		int word = (cex_count / 64) % cex_sim->num_words;
+		uint64_t mask = 1ULL << (cex_count % 64);
+		for (int i = 0; i < GetSize(leaf_bits); i++) {
+			auto &values = cex_sim->fixed_values[leaf_bits[i]];
+			values.resize(cex_sim->num_words);
+			if (model[i])
+				values[word] |= mask;
+			else
+				values[word] &= ~mask;
+		}
+		cex_count++;
+		cex_pending = true;
+	}
+
+	// Checks whether the two bits differ in any of the known counterexamples.
+	// The bits that are not part of a counterexample take random values,
+	// which are just as good at telling signals apart.
+	bool cex_refutes(RTLIL::SigBit a, RTLIL::SigBit b, bool inverted)
+	{
+		if (cex_count == 0)
+			return false;
+		if (cex_pending) {
+			cex_sim->run();
+			cex_pending = false;
+		}
+		for (int w = 0; w < cex_sim->num_words; w++) {
+			uint64_t diff = cex_sim->value(a, w) ^ cex_sim->value(b, w) ^ (inverted ? ~0ULL : 0);
+			if (diff & cex_sim->known(a, w) & cex_sim->known(b, w))
+				return true;
+		}
+		return false;
+	}
+
+	// Tries to prove that the two bits are equal (or complementary) in all
+	// cases, and adds that fact to the solver for the following proofs.
+	// Returns 1 if proven, 0 if refuted and -1 on timeout.
+	int prove(RTLIL::SigBit a, RTLIL::SigBit b, bool inverted)
+	{
+		int lit_a = import_bit(a);
+		int lit_b = import_bit(b);
+		if (inverted)
+			lit_b = ez->NOT(lit_b);
+		sat_calls++;
+		std::vector<bool> model;
+		if (ez->solve(leaf_lits, model, ez->XOR(lit_a, lit_b))) {
+			add_cex(model);
+			return 0;
+		}
+		if (ez->getSolverTimoutStatus())
+			return -1;
+		ez->assume(ez->IFF(lit_a, lit_b));
+		return 1;
+	}
+
+	std::vector<std::vector<equiv_bit_t>> find_candidates()
+	{
+		RandomSim sim(module, sigmap, opts.sim_words);
+		sim.run();
+
+		std::vector<RTLIL::SigBit> bits = {State::S0, State::S1};
+		pool<RTLIL::SigBit> seen;
+		auto add_bits = [&](const RTLIL::SigSpec &sig) {
+			for (auto bit : sigmap(sig))
+				if (bit.wire != nullptr && bit_depth(bit) != INT_MAX && !undef_driven.count(bit) && !seen.count(bit)) {
+					seen.insert(bit);
+					bits.push_back(bit);
+				}
+		};
+		for (auto cell : module->cells())
+			for (auto &conn : cell->connections())
+				add_bits(conn.second);
+		for (auto wire : module->wires())
+			if (wire->port_input)
+				add_bits(wire);
+
+		// Group bits by their simulated values. Bits that are unknown for
+		// some patterns are left out.
+		dict<std::vector<uint64_t>, int> class_index;
+		std::vector<std::vector<equiv_bit_t>> classes;
+		int num_signals = 0;
+		for (auto bit : bits) {
+			std::vector<uint64_t> sig(opts.sim_words);
+			bool known = true;
+			for (int w = 0; w < opts.sim_words && known; w++) {
+				known = sim.known(bit, w) == ~0ULL;
+				sig[w] = sim.value(bit, w);
+			}
+			if (!known)
+				continue;
+			bool inverted = opts.inv_mode && (sig[0] & 1);
+			if (inverted)
+				for (auto &word : sig)
+					word = ~word;
+			auto it = class_index.find(sig);
+			if (it == class_index.end()) {
+				class_index[sig] = GetSize(classes);
+				classes.push_back({equiv_bit_t{bit, inverted}});
+			} else
+				classes[it->second].push_back(equiv_bit_t{bit, inverted});
+		}
+
+		std::vector<std::vector<equiv_bit_t>> candidates;
+		for (auto &cls : classes) {
+			if (GetSize(cls) < 2)
+				continue;
+			std::stable_sort(cls.begin(), cls.end(), [&](const equiv_bit_t &a, const equiv_bit_t &b) {
+				return bit_depth(a.bit) < bit_depth(b.bit);
+			});
+			num_signals += GetSize(cls);
+			candidates.push_back(std::move(cls));
+		}
+
+		log("  Simulated %d random patterns: %d candidate classes with %d signal bits.\n",
+				64 * opts.sim_words, GetSize(candidates), num_signals);
+		return candidates;
+	}
+
+	// Proves the members of the classes equal to the class member that is
+	// closest to the inputs. The members are visited in topological order,
+	// so that the inputs of a signal are merged before the signal itself is
+	// tried. A refuted member is tried against the representative of the class
+	// split off by an earlier refutation, or starts that class itself.
+	std::vector<std::pair<equiv_bit_t, equiv_bit_t>> sweep(const std::vector<std::vector<equiv_bit_t>> &classes)
+	{
+		std::vector<equiv_bit_t> reps;
+		std::vector<int> splits;
+		std::vector<std::pair<equiv_bit_t, int>> members;
+		for (auto &cls : classes) {
+			for (int i = 1; i < GetSize(cls); i++)
+				members.push_back({cls[i], GetSize(reps)});
+			reps.push_back(cls.front());
+			splits.push_back(-1);
+		}
+		std::stable_sort(members.begin(), members.end(), [&](const std::pair<equiv_bit_t, int> &a, const std::pair<equiv_bit_t, int> &b) {
+			return bit_depth(a.first.bit) < bit_depth(b.first.bit);
+		});
+
+		std::vector<std::pair<equiv_bit_t, equiv_bit_t>> merges;
+		for (auto &it : members)
+		{
+			equiv_bit_t member = it.first;
+			int cls = it.second;
+
+			while (1) {
+				equiv_bit_t rep = reps[cls];
+				bool inverted = rep.inverted != member.inverted;
+
+				// Constants and free variables (bits that are not driven by a
+				// combinational cell) are never merged into anything.
+				int result = 0;
+				if (bit_depth(member.bit) > 0) {
+					if (cex_refutes(rep.bit, member.bit, inverted))
+						refuted_sim++;
+					else if ((result = prove(rep.bit, member.bit, inverted)) == 0) {
+						if (opts.verbose)
+							log("    Refuted %s == %s%s.\n", log_signal(member.bit), inverted ? "~" : "", log_signal(rep.bit));
+						refuted++;
+					}
+				}
+
+				if (result > 0) {
+					if (opts.verbose)
+						log("    Proved %s == %s%s.\n", log_signal(member.bit), inverted ? "~" : "", log_signal(rep.bit));
+					proved++;
+					if (inverted)
+						proved_inv++;
+					if (rep.bit.wire == nullptr)
+						proved_const++;
+					if (!inverted)
+						sat_sigmap.add(member.bit, rep.bit);
+					merges.push_back({rep, member});
+					break;
+				}
+
+				if (result < 0) {
+					if (opts.verbose)
+						log("    Timeout proving %s == %s%s.\n", log_signal(member.bit), inverted ? "~" : "", log_signal(rep.bit));
+					timeouts++;
+					break;
+				}
+
+				if (splits[cls] < 0) {
+					splits[cls] = GetSize(reps);
+					reps.push_back(member);
+					splits.push_back(-1);
+					break;
+				}
+				cls = splits[cls];
+			}
+		}
+		return merges;
+	}
+
+	int rewire(const std::vector<std::pair<equiv_bit_t, equiv_bit_t>> &merges)
+	{
+		dict<RTLIL::SigBit, RTLIL::SigBit> inverters;
+		int rewired = 0;
+
+		for (auto &it : merges)
+		{
+			RTLIL::SigBit master = it.first.bit;
+			RTLIL::SigBit slave = it.second.bit;
+			bool inverted = it.first.inverted != it.second.inverted;
+
+			RTLIL::Cell *drv = drivers.at(slave);
+			if (!design->selected(module, slave.wire) || drv->type == ID($equiv))
+				continue;
+
+			// Don't replace an inverter with another one.
+			if (inverted && drv->type == ID($_NOT_) && sigmap(drv->getPort(ID::A)) == master)
+				continue;
+
+			RTLIL::Wire *dummy_wire = module->addWire(NEW_ID);
+			for (auto &port : drv->connections_)
+				if (ct.cell_output(drv->type, port.first))
+					sigmap(port.second).replace(slave, dummy_wire, &port.second);
+
+			if (inverted && master.wire == nullptr)
+				master = master == State::S0 ? State::S1 : State::S0;
+			else if (inverted) {
+				if (inverters.count(master) == 0) {
+					RTLIL::Wire *inv_wire = module->addWire(NEW_ID);
+					module->addNotGate(NEW_ID, master, inv_wire);
+					inverters[master] = inv_wire;
+				}
+				master = inverters.at(master);
+			}
+
+			module->connect(slave, master);
+			rewired++;
+		}
+		return rewired;
+	}
+
+	int prove_equiv_cells()
+	{
+		int count = 0, skipped = 0;
+		for (auto cell : module->selected_cells()) {
+			if (cell->type != ID($equiv))
+				continue;
+			RTLIL::SigSpec sig_a = sigmap(cell->getPort(ID::A));
+			RTLIL::SigSpec sig_b = sigmap(cell->getPort(ID::B));
+			if (sig_a == sig_b)
+				continue;
+			bool undef = false;
+			for (auto bit : RTLIL::SigSpec({sig_a, sig_b}))
+				if (bit == State::Sx || bit == State::Sz || undef_driven.count(bit))
+					undef = true;
+			if (undef) {
+				if (opts.verbose)
+					log("    Not proving $equiv cell %s, it depends on x or z constants.\n", log_id(cell));
+				skipped++;
+				continue;
+			}
+			bool ok = true;
+			for (int i = 0; i < GetSize(sig_a) && ok; i++)
+				ok = prove(sig_a[i], sig_b[i], false) > 0;
+			if (opts.verbose)
+				log("    %s $equiv cell %s.\n", ok ? "Proved" : "Failed to prove", log_id(cell));
+			if (ok) {
+				cell->setPort(ID::B, cell->getPort(ID::A));
+				count++;
+			}
+		}
+		if (skipped)
+			log("  Skipped %d $equiv cells that depend on x or z constants.\n", skipped);
+		return count;
+	}
+
+	int run()
+	{
+		log("Running SAT sweeping on module %s:\n", log_id(module));
+
+		find_drivers();
+		cex_sim.reset(new RandomSim(module, sigmap, opts.sim_words));
+		auto merges = sweep(find_candidates());
+
+		log("  Proved %d equivalences (%d inverted, %d constant) and refuted %d candidates in %d SAT calls.\n",
+				proved, proved_inv, proved_const, refuted, sat_calls);
+		log("  Simulating %d counterexamples refuted %d more candidate pairs without SAT calls.\n", cex_count, refuted_sim);
+		if (timeouts)
+			log("  Gave up on %d candidates after reaching the timeout.\n", timeouts);
+
+		if (opts.equiv_mode) {
+			int count = prove_equiv_cells();
+			log("  Proved %d previously unproven $equiv cells.\n", count);
+			return count;
+		}
+
+		int rewired = rewire(merges);
+		log("  Rewired %d signal bits in module %s.\n", rewired, log_id(module));
+		return rewired;
+	}
+};
+
+struct FraigPass : public Pass {
+	FraigPass() : Pass("fraig", "perform functional reduction using SAT sweeping") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    fraig [options] [selection]\n");
+		log("\n");
+		log("This pass performs functional reduction in the circuit using SAT sweeping.\n");
+		log("Signals are first sorted into candidate equivalence classes by random\n");
+		log("simulation. The candidates are then proven equal to the class member that\n");
+		log("is closest to the inputs, in topological order and using a single incremental\n");
+		log("SAT solver instance, so that every proven equivalence simplifies the\n");
+		log("following proofs. Proven signals are connected to their class representative.\n");
+		log("\n");
+		log("The outputs of FFs and other non-combinational cells are treated as inputs.\n");
+		log("Signals that depend on x or z constants are left alone, as are $equiv cells\n");
+		log("whose inputs depend on them.\n");
+		log("Run 'opt_clean' afterwards to remove the logic that is no longer used.\n");
+		log("\n");
+		log("    -sim <N>\n");
+		log("        simulate N*64 random patterns to find candidates (default: 4)\n");
+		log("\n");
+		log("    -inv\n");
+		log("        also find inverted equivalences (connected using $_NOT_ cells)\n");
+		log("\n");
+		log("    -equiv\n");
+		log("        do not rewire the circuit. Instead, use the proven equivalences to\n");
+		log("        prove the selected $equiv cells, like 'equiv_simple' does. This\n");
+		log("        scales better than 'equiv_simple' on large flat netlists.\n");
+		log("\n");
+		log("    -timeout <N>\n");
+		log("        give up on a candidate after N seconds (default: no timeout)\n");
+		log("\n");
+		log("    -v\n");
+		log("        print every proven and refuted candidate\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		FraigOptions opts;
+
+		log_header(design, "Executing FRAIG pass (functional reduction using SAT sweeping).\n");
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-sim" && argidx+1 < args.size()) {
+				opts.sim_words = std::max(1, atoi(args[++argidx].c_str()));
+				continue;
+			}
+			if (args[argidx] == "-inv") {
+				opts.inv_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-equiv") {
+				opts.equiv_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-timeout" && argidx+1 < args.size()) {
+				opts.timeout = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-v") {
+				opts.verbose = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		int count = 0;
+		for (auto module : design->selected_modules())
+			count += FraigWorker(design, module, opts).run();
+
+		if (opts.equiv_mode)
+			log("Proved %d previously unproven $equiv cells.\n", count);
+		else
+			log("Rewired a total of %d signal bits.\n", count);
+	}
+} FraigPass;
+
+PRIVATE_NAMESPACE_END
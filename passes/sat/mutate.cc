@@ -19,6 +19,9 @@
 
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
+#include "kernel/satgen.h"
+#include "kernel/randsim.h"
+#include "kernel/workers.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -424,7 +427,7 @@ void database_reduce(std::vector<mutate_t> &database, const mutate_opts_t &opts,
 	log("Covered %d/%d wire bits (%.2f%%).\n", covered_wirebit_cnt, GetSize(coverdb.wirebit_db), 100.0 * covered_wirebit_cnt / GetSize(coverdb.wirebit_db));
 }
 
-void mutate_list(Design *design, const mutate_opts_t &opts, const string &filename, const string &srcsfile, int N)
+std::vector<mutate_t> mutate_database(Design *design, const mutate_opts_t &opts, const string &srcsfile, int N)
 {
 	pool<string> sources;
 	std::vector<mutate_t> database;
@@ -544,6 +547,35 @@ void mutate_list(Design *design, const mutate_opts_t &opts, const string &filena
 			sout << s << std::endl;
 	}
 
+	return database;
+}
+
+string mutate_args(const mutate_t &entry)
+{
+	string str = stringf(" -mode %s", entry.mode.c_str());
+	if (!entry.module.empty())
+		str += stringf(" -module %s", log_id(entry.module));
+	if (!entry.cell.empty())
+		str += stringf(" -cell %s", log_id(entry.cell));
+	if (!entry.port.empty())
+		str += stringf(" -port %s", log_id(entry.port));
+	if (entry.portbit >= 0)
+		str += stringf(" -portbit %d", entry.portbit);
+	if (entry.ctrlbit >= 0)
+		str += stringf(" -ctrlbit %d", entry.ctrlbit);
+	if (!entry.wire.empty())
+		str += stringf(" -wire %s", log_id(entry.wire));
+	if (entry.wirebit >= 0)
+		str += stringf(" -wirebit %d", entry.wirebit);
+	for (auto &s : entry.src)
+		str += stringf(" -src %s", s.c_str());
+	return str;
+}
+
+void mutate_list(Design *design, const mutate_opts_t &opts, const string &filename, const string &srcsfile, int N)
+{
+	std::vector<mutate_t> database = mutate_database(design, opts, srcsfile, N);
+
 	std::ofstream fout;
 
 	if (!filename.empty()) {
@@ -569,23 +601,7 @@ void mutate_list(Design *design, const mutate_opts_t &opts, const string &filena
 		string str = "mutate";
 		if (!opts.ctrl_name.empty())
 			str += stringf(" -ctrl %s %d %d", log_id(opts.ctrl_name), opts.ctrl_width, ctrl_value++);
-		str += stringf(" -mode %s", entry.mode.c_str());
-		if (!entry.module.empty())
-			str += stringf(" -module %s", log_id(entry.module));
-		if (!entry.cell.empty())
-			str += stringf(" -cell %s", log_id(entry.cell));
-		if (!entry.port.empty())
-			str += stringf(" -port %s", log_id(entry.port));
-		if (entry.portbit >= 0)
-			str += stringf(" -portbit %d", entry.portbit);
-		if (entry.ctrlbit >= 0)
-			str += stringf(" -ctrlbit %d", entry.ctrlbit);
-		if (!entry.wire.empty())
-			str += stringf(" -wire %s", log_id(entry.wire));
-		if (entry.wirebit >= 0)
-			str += stringf(" -wirebit %d", entry.wirebit);
-		for (auto &s : entry.src)
-			str += stringf(" -src %s", s.c_str());
+		str += mutate_args(entry);
 		if (filename.empty())
 			log("%s\n", str.c_str());
 		else
@@ -726,6 +742,459 @@ void mutate_cnot(Design *design, const mutate_opts_t &opts, bool one)
 	cell->setPort(opts.port, s);
 }
 
+struct mutate_eval_opts_t {
+	int seq = 1;
+	int sim_words = 0;
+	bool sat = true;
+};
+
+// Compares a mutated copy of a module with the original module. Both copies
+// see the same inputs, undriven wires and $any* values and start in the same
+// state, which is taken from the init attributes where there are any. The
+// mutation is killed if an output of the module differs within the given
+// number of time steps.
+struct MutateEvalWorker
+{
+	Module *gold, *gate;
+	SigMap sigmap_gold, sigmap_gate;
+	const mutate_eval_opts_t &eopts;
+
+	SigSpec free_gold, free_gate;
+	SigSpec const_gold, const_gate;
+	SigSpec state_gold, state_gate;
+	SigSpec out_gold, out_gate;
+	dict<SigBit, State> init_gold;
+	bool black_boxes = false;
+
+	MutateEvalWorker(Module *gold, Module *gate, const mutate_eval_opts_t &eopts) :
+			gold(gold), gate(gate), sigmap_gold(gold), sigmap_gate(gate), eopts(eopts)
+	{
+		// Mutations only add cells and wires, so everything in the original
+		// module has a counterpart of the same name in the mutated copy.
+		pool<SigBit> driven;
+		for (auto cell : gold->cells())
+		{
+			Cell *gate_cell = gate->cell(cell->name);
+
+			if (cell->type.in(ID($anyconst), ID($allconst))) {
+				const_gold.append(cell->getPort(ID::Y));
+				const_gate.append(gate_cell->getPort(ID::Y));
+			} else if (cell->type.in(ID($anyseq), ID($allseq)) || !yosys_celltypes.cell_known(cell->type)) {
+				black_boxes |= !cell->type.in(ID($anyseq), ID($allseq));
+				for (auto &conn : cell->connections())
+					if (cell->output(conn.first)) {
+						free_gold.append(conn.second);
+						free_gate.append(gate_cell->getPort(conn.first));
+					}
+			} else if (RTLIL::builtin_ff_cell_types().count(cell->type) || cell->type == ID($anyinit)) {
+				state_gold.append(cell->getPort(ID::Q));
+				state_gate.append(gate_cell->getPort(ID::Q));
+			}
+
+			for (auto &conn : cell->connections())
+				if (cell->output(conn.first))
+					for (auto bit : sigmap_gold(conn.second))
+						driven.insert(bit);
+		}
+
+		for (auto wire : gold->wires())
+		{
+			Wire *gate_wire = gate->wire(wire->name);
+
+			for (int i = 0; i < GetSize(wire); i++) {
+				SigBit bit = sigmap_gold(SigBit(wire, i));
+				if (bit.wire == nullptr || driven.count(bit))
+					continue;
+				driven.insert(bit);
+				free_gold.append(bit);
+				free_gate.append(SigBit(gate_wire, i));
+			}
+
+			if (wire->port_output) {
+				out_gold.append(wire);
+				out_gate.append(gate_wire);
+			}
+
+			if (wire->attributes.count(ID::init)) {
+				Const initval = wire->attributes.at(ID::init);
+				for (int i = 0; i < GetSize(wire) && i < GetSize(initval); i++)
+					if (initval[i] == State::S0 || initval[i] == State::S1)
+						init_gold[sigmap_gold(SigBit(wire, i))] = initval[i];
+			}
+		}
+	}
+
+	// Returns the first time step in which an output differs for one of the
+	// simulated patterns, or 0. Cells of unknown types get random outputs, so
+	// modules with such cells are not simulated.
+	int simulate()
+	{
+		if (black_boxes)
+			return 0;
+
+		RandomSim sim_gold(gold, sigmap_gold, eopts.sim_words);
+		RandomSim sim_gate(gate, sigmap_gate, eopts.sim_words);
+		uint64_t rng_state = 88172645463325252ULL;
+
+		auto random_words = [&]() {
+			std::vector<uint64_t> words(eopts.sim_words);
+			for (auto &w : words) {
+				rng_state ^= rng_state >> 12;
+				rng_state ^= rng_state << 25;
+				rng_state ^= rng_state >> 27;
+				w = rng_state * 2685821657736338717ULL;
+			}
+			return words;
+		};
+
+		std::vector<std::vector<uint64_t>> const_words;
+		for (int i = 0; i < GetSize(const_gold); i++)
+			const_words.push_back(random_words());
+
+		for (int step = 1; step <= eopts.seq; step++)
+		{
+			sim_gold.fixed_values.clear();
+			sim_gate.fixed_values.clear();
+
+			for (int i = 0; i < GetSize(free_gold); i++)
+				sim_gold.fixed_values[free_gold[i]] = sim_gate.fixed_values[free_gate[i]] = random_words();
+
+			for (int i = 0; i < GetSize(const_gold); i++)
+				sim_gold.fixed_values[const_gold[i]] = sim_gate.fixed_values[const_gate[i]] = const_words[i];
+
+			// The FFs would start in different random states otherwise.
+			if (step == 1)
+				for (int i = 0; i < GetSize(state_gold); i++) {
+					std::vector<uint64_t> words = random_words();
+					auto it = init_gold.find(sigmap_gold(state_gold[i]));
+					if (it != init_gold.end())
+						words.assign(eopts.sim_words, it->second == State::S1 ? ~0ULL : 0);
+					sim_gold.fixed_values[state_gold[i]] = sim_gate.fixed_values[state_gate[i]] = words;
+				}
+
+			sim_gold.run();
+			sim_gate.run();
+
+			for (int i = 0; i < GetSize(out_gold); i++)
+			for (int w = 0; w < eopts.sim_words; w++) {
+				uint64_t known = sim_gold.known(out_gold[i], w) & sim_gate.known(out_gate[i], w);
+				if ((sim_gold.value(out_gold[i], w) ^ sim_gate.value(out_gate[i], w)) & known)
+					return step;
+			}
+		}
+
+		return 0;
+	}
+
+	// Returns the first time step in which an output can differ, 0 if the
+	// outputs are the same in all time steps, or -1 if the fanout of the
+	// mutation has FFs that can't be modelled, or if an output can only be
+	// shown to differ through cells that can't be modelled.
+	//
+	// Only the fanout of the mutation is imported from the mutated copy. The
+	// other signals of the copy are the same as in the original module, so
+	// the variables of the original module are used for them, and only the
+	// cone of the original module that these signals and the outputs depend
+	// on is imported.
+	int prove(IdString mutated_cell)
+	{
+		auto gold_bit = [&](SigBit bit) {
+			if (bit.wire == nullptr)
+				return bit;
+			Wire *wire = gold->wire(bit.wire->name);
+			log_assert(wire != nullptr);
+			return sigmap_gold(SigBit(wire, bit.offset));
+		};
+
+		// The fanout starts at the mutated cell, the cells added by the
+		// mutation and the cells reading a signal that the mutation tied to
+		// a constant.
+		pool<Cell*> affected_cells;
+		pool<SigBit> affected_bits;
+		std::vector<Cell*> affected;
+		dict<SigBit, std::vector<Cell*>> gate_readers;
+		for (auto cell : gate->cells())
+		{
+			bool seed = cell->name == mutated_cell || gold->cell(cell->name) == nullptr;
+			for (auto &conn : cell->connections()) {
+				if (cell->output(conn.first))
+					continue;
+				for (auto bit : conn.second) {
+					SigBit mapped = sigmap_gate(bit);
+					if (mapped.wire != nullptr)
+						gate_readers[mapped].push_back(cell);
+					else if (!seed && bit.wire != nullptr && gold_bit(bit) != mapped)
+						seed = true;
+				}
+			}
+			if (seed && affected_cells.insert(cell).second)
+				affected.push_back(cell);
+		}
+
+		for (int pos = 0; pos < GetSize(affected); pos++)
+			for (auto &conn : affected[pos]->connections())
+				if (affected[pos]->output(conn.first))
+					for (auto bit : sigmap_gate(conn.second)) {
+						if (bit.wire == nullptr || !affected_bits.insert(bit).second || !gate_readers.count(bit))
+							continue;
+						for (auto reader : gate_readers.at(bit))
+							if (affected_cells.insert(reader).second)
+								affected.push_back(reader);
+					}
+
+		// Inputs of the fanout that come from outside of it, as pairs of a
+		// bit in the mutated copy and the same bit in the original module.
+		std::vector<std::pair<SigBit, SigBit>> links;
+		pool<SigBit> needed_bits;
+		for (auto cell : affected) {
+			for (auto &conn : cell->connections()) {
+				if (cell->output(conn.first))
+					continue;
+				for (auto bit : conn.second)
+					if (sigmap_gate(bit).wire != nullptr && !affected_bits.count(sigmap_gate(bit))) {
+						links.push_back({bit, gold_bit(bit)});
+						needed_bits.insert(links.back().second);
+					}
+			}
+			if (Cell *gold_cell = gold->cell(cell->name))
+				for (auto &conn : gold_cell->connections())
+					for (auto bit : sigmap_gold(conn.second))
+						needed_bits.insert(bit);
+		}
+
+		SigSpec diff_gold, diff_gate;
+		for (int i = 0; i < GetSize(out_gate); i++)
+			if (sigmap_gate(out_gate[i]).wire == nullptr || affected_bits.count(sigmap_gate(out_gate[i]))) {
+				diff_gold.append(out_gold[i]);
+				diff_gate.append(out_gate[i]);
+				needed_bits.insert(sigmap_gold(out_gold[i]));
+			}
+
+		if (diff_gate.empty())
+			return 0;
+
+		dict<SigBit, Cell*> gold_drivers;
+		for (auto cell : gold->cells())
+			for (auto &conn : cell->connections())
+				if (cell->output(conn.first))
+					for (auto bit : sigmap_gold(conn.second))
+						if (bit.wire != nullptr)
+							gold_drivers[bit] = cell;
+
+		pool<Cell*> cone_cells;
+		std::vector<Cell*> cone;
+		std::vector<SigBit> queue(needed_bits.begin(), needed_bits.end());
+		while (!queue.empty()) {
+			SigBit bit = queue.back();
+			queue.pop_back();
+			if (!gold_drivers.count(bit) || !cone_cells.insert(gold_drivers.at(bit)).second)
+				continue;
+			Cell *cell = gold_drivers.at(bit);
+			cone.push_back(cell);
+			for (auto &conn : cell->connections())
+				if (!cell->output(conn.first))
+					for (auto b : sigmap_gold(conn.second))
+						if (b.wire != nullptr)
+							queue.push_back(b);
+		}
+
+		ezSatPtr ez;
+		SatGen satgen_gold(ez.get(), &sigmap_gold, "gold:");
+		SatGen satgen_gate(ez.get(), &sigmap_gate, "gate:");
+
+		// The outputs of cells that SatGen doesn't support (e.g. instances of
+		// other modules) can take any value, so they can make the outputs
+		// differ where the real cells can't.
+		bool black_boxes = false;
+
+		for (int step = 1; step <= eopts.seq; step++)
+		{
+			for (auto cell : cone)
+				if (!satgen_gold.importCell(cell, step) && !cell->type.in(ID($anyconst), ID($allconst), ID($anyseq), ID($allseq)))
+					black_boxes = true;
+
+			for (auto cell : affected)
+			{
+				Cell *gold_cell = gold->cell(cell->name);
+				bool imported = satgen_gate.importCell(cell, step);
+				bool is_ff = RTLIL::builtin_ff_cell_types().count(cell->type) || cell->type == ID($anyinit);
+				bool is_source = cell->type.in(ID($anyconst), ID($allconst), ID($anyseq), ID($allseq));
+
+				if (imported && !is_source && !(is_ff && step == 1))
+					continue;
+
+				// Cells that SatGen doesn't support are treated as
+				// deterministic black boxes: equal inputs give equal outputs.
+				// FFs start in the same state and $any* cells give the same
+				// values in both copies.
+				if (gold_cell == nullptr || (is_ff && !imported))
+					return -1;
+				if (!imported)
+					black_boxes = true;
+
+				SigSpec in_gold, in_gate, bb_out_gold, bb_out_gate;
+				for (auto &conn : gold_cell->connections())
+					if (gold_cell->output(conn.first)) {
+						bb_out_gold.append(conn.second);
+						bb_out_gate.append(cell->getPort(conn.first));
+					} else if (!imported) {
+						in_gold.append(conn.second);
+						in_gate.append(cell->getPort(conn.first));
+					}
+
+				int in_eq = ez->vec_eq(satgen_gold.importSigSpec(in_gold, step), satgen_gate.importSigSpec(in_gate, step));
+				int out_eq = ez->vec_eq(satgen_gold.importSigSpec(bb_out_gold, step), satgen_gate.importSigSpec(bb_out_gate, step));
+				ez->assume(ez->OR(ez->NOT(in_eq), out_eq));
+			}
+
+			for (auto &it : links)
+				ez->assume(ez->IFF(satgen_gate.importSigSpec(it.first, step).front(), satgen_gold.importSigSpec(it.second, step).front()));
+
+			if (step == 1)
+				for (auto cell : cone)
+					if (RTLIL::builtin_ff_cell_types().count(cell->type) || cell->type == ID($anyinit))
+						for (auto bit : sigmap_gold(cell->getPort(ID::Q)))
+							if (init_gold.count(bit)) {
+								int lit = satgen_gold.importSigSpec(bit, step).front();
+								ez->assume(init_gold.at(bit) == State::S1 ? lit : ez->NOT(lit));
+							}
+
+			int diff = ez->vec_ne(satgen_gold.importSigSpec(diff_gold, step), satgen_gate.importSigSpec(diff_gate, step));
+			if (ez->solve(diff))
+				return black_boxes ? -1 : step;
+		}
+
+		return 0;
+	}
+};
+
+// Applies the mutation to a copy of its module and compares the copy with the
+// original module. The design is left unchanged.
+string mutate_eval(Design *design, const mutate_t &entry, const mutate_eval_opts_t &eopts)
+{
+	Module *module = design->module(entry.module);
+	Module *mutant = design->addModule(NEW_ID);
+	module->cloneInto(mutant);
+
+	mutate_opts_t opts;
+	opts.module = mutant->name;
+	opts.cell = entry.cell;
+	opts.port = entry.port;
+	opts.portbit = entry.portbit;
+	opts.ctrlbit = entry.ctrlbit;
+
+	{
+		LogMakeDebugHdl mkdebug(true);
+		if (entry.mode == "inv")
+			mutate_inv(design, opts);
+		else if (entry.mode == "const0" || entry.mode == "const1")
+			mutate_const(design, opts, entry.mode == "const1");
+		else
+			mutate_cnot(design, opts, entry.mode == "cnot1");
+	}
+
+	string result;
+	MutateEvalWorker worker(module, mutant, eopts);
+
+	int step = eopts.sim_words > 0 ? worker.simulate() : 0;
+	if (step > 0)
+		result = stringf("killed (sim, step %d)", step);
+	else if (!eopts.sat)
+		result = "undetected";
+	else if ((step = worker.prove(entry.cell)) > 0)
+		result = stringf("killed (sat, step %d)", step);
+	else
+		result = step < 0 ? "unknown" : "survived";
+
+	design->remove(mutant);
+	return result;
+}
+
+void mutate_eval_list(Design *design, const mutate_opts_t &opts, const mutate_eval_opts_t &eopts,
+		const string &filename, const string &srcsfile, int N, int num_workers)
+{
+	std::vector<mutate_t> database = mutate_database(design, opts, srcsfile, N);
+	std::vector<string> results(GetSize(database));
+
+	auto eval_range = [&](int begin, int end) {
+		for (int i = begin; i < end; i++)
+			results[i] = mutate_eval(design, database[i], eopts);
+	};
+
+	if (num_workers <= 1 || GetSize(database) < 2 || !worker_processes_available())
+	{
+		eval_range(0, GetSize(database));
+	}
+	else
+	{
+		// Every worker process starts from a copy-on-write image of the
+		// design, so the mutants don't need to be undone or reparsed. Each
+		// job evaluates a range of mutations and returns their results.
+		int num_jobs = std::min(GetSize(database), num_workers * 8);
+		auto job_begin = [&](int job_idx) { return int(int64_t(job_idx) * GetSize(database) / num_jobs); };
+
+		auto job = [&](int job_idx) {
+			string data;
+			for (int i = job_begin(job_idx); i < job_begin(job_idx + 1); i++)
+				data += mutate_eval(design, database[i], eopts) + "\n";
+			return data;
+		};
+
+		auto done = [&](int job_idx, WorkerResult &result) {
+			if (!result.ok) {
+				eval_range(job_begin(job_idx), job_begin(job_idx + 1));
+				return;
+			}
+			result.replay_log();
+			size_t pos = 0;
+			for (int i = job_begin(job_idx); i < job_begin(job_idx + 1); i++) {
+				size_t next = result.data.find('\n', pos);
+				results[i] = result.data.substr(pos, next - pos);
+				pos = next + 1;
+			}
+		};
+
+		run_worker_jobs(num_jobs, num_workers, job, done);
+	}
+
+	std::ofstream fout;
+
+	if (!filename.empty()) {
+		fout.open(filename, std::ios::out | std::ios::trunc);
+		if (!fout.is_open())
+			log_error("Could not open file \"%s\" with write access.\n", filename.c_str());
+	}
+
+	int killed_sim = 0, killed_sat = 0, survived = 0, undetected = 0, unknown = 0;
+
+	for (int i = 0; i < GetSize(database); i++)
+	{
+		string str = results[i] + ": mutate" + mutate_args(database[i]);
+		if (filename.empty())
+			log("%s\n", str.c_str());
+		else
+			fout << str << std::endl;
+
+		if (results[i].compare(0, 13, "killed (sim, ") == 0)
+			killed_sim++;
+		else if (results[i].compare(0, 13, "killed (sat, ") == 0)
+			killed_sat++;
+		else if (results[i] == "survived")
+			survived++;
+		else if (results[i] == "undetected")
+			undetected++;
+		else
+			unknown++;
+	}
+
+	int killed = killed_sim + killed_sat;
+	int total = GetSize(database) - unknown;
+	log("Killed %d of %d mutations (%d by simulation, %d by SAT), %d survived, %d undetected, %d unknown.\n",
+			killed, GetSize(database), killed_sim, killed_sat, survived, undetected, unknown);
+	if (total > 0)
+		log("Mutation score: %.1f%%\n", 100.0 * killed / total);
+}
+
 struct MutatePass : public Pass {
 	MutatePass() : Pass("mutate", "generate or apply design mutations") { }
 	void help() override
@@ -771,6 +1240,39 @@ struct MutatePass : public Pass {
 		log("          weight_cover pick_cover_prcnt\n");
 		log("\n");
 		log("\n");
+		log("    mutate -list N -eval [options] [selection]\n");
+		log("\n");
+		log("Create a list of N mutations as above, and evaluate the mutations in this\n");
+		log("process instead of printing them. Every mutation is applied to a copy of its\n");
+		log("module, which is compared with the original module: both see the same inputs\n");
+		log("and start in the same state, taken from the init attributes where there are\n");
+		log("any. A mutation is killed if an output of its module can differ. The result\n");
+		log("of every mutation and the options for 'mutate -mode' are printed, followed by\n");
+		log("a summary. Mutations in modules with unsupported FFs (e.g. async resets) are\n");
+		log("reported as unknown; use async2sync first. Instances of other modules and\n");
+		log("other cells that can't be modelled can drive any value, so mutations whose\n");
+		log("effect only reaches the outputs together with such cells are reported as\n");
+		log("unknown as well (or as undetected with -nosat); use flatten first.\n");
+		log("\n");
+		log("The -o, -s, -seed, -cfg and filter options are the same as above, except that\n");
+		log("-o writes the results. Additional options:\n");
+		log("\n");
+		log("    -seq N\n");
+		log("        Number of time steps to compare (default 1)\n");
+		log("\n");
+		log("    -sim N\n");
+		log("        Before using SAT, simulate N words of 64 random patterns each.\n");
+		log("        Mutations that simulation kills are not passed to SAT.\n");
+		log("\n");
+		log("    -nosat\n");
+		log("        Only use simulation (requires -sim). Mutations that are not killed are\n");
+		log("        reported as undetected instead of survived.\n");
+		log("\n");
+		log("    -j N\n");
+		log("        Evaluate mutations in up to N worker processes at once. The results are\n");
+		log("        the same as without this option.\n");
+		log("\n");
+		log("\n");
 		log("    mutate -mode MODE [options]\n");
 		log("\n");
 		log("Apply the given mutation.\n");
@@ -795,9 +1297,12 @@ struct MutatePass : public Pass {
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		mutate_opts_t opts;
+		mutate_eval_opts_t eopts;
 		string filename;
 		string srcsfile;
 		int N = -1;
+		bool eval = false;
+		int num_workers = 0;
 
 		log_header(design, "Executing MUTATE pass.\n");
 
@@ -820,6 +1325,26 @@ struct MutatePass : public Pass {
 				opts.seed = atoi(args[++argidx].c_str());
 				continue;
 			}
+			if (args[argidx] == "-eval") {
+				eval = true;
+				continue;
+			}
+			if (args[argidx] == "-seq" && argidx+1 < args.size()) {
+				eopts.seq = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-sim" && argidx+1 < args.size()) {
+				eopts.sim_words = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-nosat") {
+				eopts.sat = false;
+				continue;
+			}
+			if (args[argidx] == "-j" && argidx+1 < args.size()) {
+				num_workers = atoi(args[++argidx].c_str());
+				continue;
+			}
 			if (args[argidx] == "-none") {
 				opts.none = true;
 				continue;
@@ -922,6 +1447,19 @@ struct MutatePass : public Pass {
 		}
 		extra_args(args, argidx, design);
 
+		if (eval) {
+			if (N < 0)
+				log_cmd_error("Option -eval can only be used with -list.\n");
+			if (!opts.ctrl_name.empty())
+				log_cmd_error("Options -eval and -ctrl are exclusive.\n");
+			if (eopts.seq < 1)
+				log_cmd_error("Invalid -seq argument.\n");
+			if (eopts.sim_words <= 0 && !eopts.sat)
+				log_cmd_error("Option -nosat requires -sim.\n");
+			mutate_eval_list(design, opts, eopts, filename, srcsfile, N, num_workers);
+			return;
+		}
+
 		if (N >= 0) {
 			mutate_list(design, opts, filename, srcsfile, N);
 			return;
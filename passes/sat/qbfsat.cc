@@ -19,6 +19,7 @@
 
 #include "kernel/yosys.h"
 #include "kernel/consteval.h"
+#include "kernel/satgen.h"
 #include "qbfsat.h"
 
 USING_YOSYS_NAMESPACE
@@ -211,7 +212,184 @@ void assume_miter_outputs(RTLIL::Module *module, bool assume_neg) {
 	module->addAssume("$assume_qbfsat_miter_outputs", wires_to_assume[0], RTLIL::S1);
 }
 
+// In-process counterexample-guided solver for the same problem that
+// yosys-smtbmc solves with "-t 1 -g": find values for the existential bits
+// such that all $assume and $assert conditions hold in the initial time step
+// for all values of the universal bits. The existential bits are the outputs
+// of $anyconst and $anyseq cells, the initial FF states and undriven bits, and
+// the universal bits are the outputs of $allconst and $allseq cells.
+//
+// The synthesis solver collects one copy of the problem per counterexample,
+// with the universal bits fixed to the counterexample and the existential bits
+// shared, and proposes candidates. The verification solver holds a single
+// copy of the problem and looks for universal values that break a candidate.
+// Both solvers are used incrementally for the whole run.
+struct QbfCegarSolver
+{
+	RTLIL::Module *module;
+	SigMap sigmap;
+	RTLIL::SigSpec sig_exists, sig_forall;
+	dict<RTLIL::SigBit, int> exists_index;
+	dict<int, bool> init_values;
+
+	QbfCegarSolver(RTLIL::Module *module) : module(module), sigmap(module)
+	{
+		pool<RTLIL::SigBit> driven;
+
+		for (auto cell : module->cells()) {
+			if (!yosys_celltypes.cell_known(cell->type))
+				log_cmd_error("Can't solve QBF-SAT problem with the built-in solver: unsupported cell %s (%s).\n", log_id(cell), log_id(cell->type));
+			bool universal = cell->type.in(ID($allconst), ID($allseq));
+			bool existential = cell->type.in(ID($anyconst), ID($anyseq)) || RTLIL::builtin_ff_cell_types().count(cell->type);
+			for (auto &conn : cell->connections()) {
+				if (!cell->output(conn.first))
+					continue;
+				for (auto bit : sigmap(conn.second)) {
+					if (bit.wire == nullptr || driven.count(bit))
+						continue;
+					driven.insert(bit);
+					if (universal)
+						sig_forall.append(bit);
+					else if (existential)
+						add_exists(bit);
+				}
+			}
+		}
+
+		for (auto wire : module->wires())
+			for (auto bit : sigmap(wire))
+				if (bit.wire != nullptr && !driven.count(bit)) {
+					driven.insert(bit);
+					add_exists(bit);
+				}
+
+		for (auto wire : module->wires()) {
+			if (!wire->attributes.count(ID::init))
+				continue;
+			RTLIL::Const init = wire->attributes.at(ID::init);
+			RTLIL::SigSpec sig = sigmap(wire);
+			for (int i = 0; i < GetSize(sig) && i < GetSize(init); i++)
+				if (exists_index.count(sig[i]) && (init[i] == RTLIL::State::S0 || init[i] == RTLIL::State::S1))
+					init_values[exists_index.at(sig[i])] = init[i] == RTLIL::State::S1;
+		}
+	}
+
+	void add_exists(RTLIL::SigBit bit)
+	{
+		exists_index[bit] = GetSize(sig_exists);
+		sig_exists.append(bit);
+	}
+
+	// Import a copy of the problem with the given prefix and return the
+	// literal that is true if all $assume and $assert conditions hold.
+	int import_problem(ezSAT *ez, const std::string &prefix, std::vector<int> &exists, std::vector<int> &forall)
+	{
+		SatGen satgen(ez, &sigmap, prefix);
+		satgen.setInitState(1);
+		for (auto cell : module->cells())
+			if (!cell->type.in(ID($allconst), ID($allseq), ID($cover)) && !satgen.importCell(cell, 1))
+				log_cmd_error("Can't solve QBF-SAT problem with the built-in solver: unsupported cell %s (%s).\n", log_id(cell), log_id(cell->type));
+		exists = satgen.importSigSpec(sig_exists, 1);
+		forall = satgen.importSigSpec(sig_forall, 1);
+		return ez->AND(satgen.importAssumes(1), satgen.importAsserts(1));
+	}
+
+	QbfSolutionType solve(int timeout, bool quiet)
+	{
+		QbfSolutionType ret;
+		ezSatPtr ez_synth, ez_verify;
+		std::vector<int> verify_exists, verify_forall;
+		int verify_ok = import_problem(ez_verify.get(), "", verify_exists, verify_forall);
+
+		std::vector<int> synth_exists;
+		for (int i = 0; i < GetSize(sig_exists); i++)
+			synth_exists.push_back(ez_synth->frozen_literal());
+		for (auto &it : init_values)
+			ez_synth->assume(it.second ? synth_exists[it.first] : ez_synth->NOT(synth_exists[it.first]));
+
+		if (!quiet)
+			log("Running built-in CEGAR solver on %d existential and %d universal bits.\n", GetSize(sig_exists), GetSize(sig_forall));
+
+		int64_t begin = PerformanceTimer::query();
+		int iterations = 0;
+
+		// Returns false if the timeout has expired, otherwise sets the solver
+		// timeout to the remaining time.
+		auto set_timeout = [&](ezSAT *ez) {
+			if (timeout == 0)
+				return true;
+			int remaining = timeout - int((PerformanceTimer::query() - begin) / 1000000000);
+			if (remaining <= 0)
+				return false;
+			ez->setSolverTimeout(remaining);
+			return true;
+		};
+
+		while (1)
+		{
+			iterations++;
+
+			std::vector<bool> exists_values;
+			if (!set_timeout(ez_synth.get()) || !ez_synth->solve(synth_exists, exists_values)) {
+				if (timeout == 0 || !ez_synth->getSolverTimoutStatus()) {
+					ret.sat = false;
+					ret.unknown = false;
+				}
+				break;
+			}
+
+			std::vector<int> assumptions;
+			for (int i = 0; i < GetSize(verify_exists); i++)
+				assumptions.push_back(exists_values[i] ? verify_exists[i] : ez_verify->NOT(verify_exists[i]));
+			assumptions.push_back(ez_verify->NOT(verify_ok));
+
+			std::vector<bool> forall_values;
+			if (!set_timeout(ez_verify.get()) || !ez_verify->solve(verify_forall, forall_values, assumptions)) {
+				if (timeout == 0 || !ez_verify->getSolverTimoutStatus()) {
+					ret.sat = true;
+					ret.unknown = false;
+					for (auto cell : module->cells()) {
+						if (cell->type != ID($anyconst))
+							continue;
+						std::string value;
+						for (auto bit : sigmap(cell->getPort(ID::Y))) {
+							auto it = exists_index.find(bit);
+							bool bit_value = it != exists_index.end() ? exists_values[it->second] : bit == RTLIL::State::S1;
+							value = (bit_value ? "1" : "0") + value;
+						}
+						ret.hole_to_value[cell->get_strpool_attribute(ID::src)] = value;
+					}
+				}
+				break;
+			}
+
+			std::vector<int> cex_exists, cex_forall;
+			int cex_ok = import_problem(ez_synth.get(), stringf("cex%d:", iterations), cex_exists, cex_forall);
+			ez_synth->assume(ez_synth->vec_eq(cex_exists, synth_exists));
+			for (int i = 0; i < GetSize(cex_forall); i++)
+				ez_synth->assume(forall_values[i] ? cex_forall[i] : ez_synth->NOT(cex_forall[i]));
+			ez_synth->assume(cex_ok);
+		}
+
+		if (ret.unknown)
+			log_warning("solver timed out\n");
+
+		ret.solver_time = (PerformanceTimer::query() - begin) / 1e9f;
+		if (!quiet) {
+			log("CEGAR loop finished after %d iteration%s.\n", iterations, iterations == 1 ? "" : "s");
+			log("Solver finished in %.3f seconds.\n", ret.solver_time);
+		}
+		return ret;
+	}
+};
+
 QbfSolutionType call_qbf_solver(RTLIL::Module *mod, const QbfSolveOptions &opt, const std::string &tempdir_name, const bool quiet = false, const int iter_num = 0) {
+	if (opt.solver == opt.Solver::Builtin) {
+		log_header(mod->design, "Solving QBF-SAT problem.\n");
+		QbfCegarSolver solver(mod);
+		return solver.solve(opt.timeout, quiet);
+	}
+
 	//Execute and capture stdout from `yosys-smtbmc -s z3 -t 1 -g --binary [--dump-smt2 <file>]`
 	QbfSolutionType ret;
 	const std::string yosys_smtbmc_exe = proc_self_dirname() + "yosys-smtbmc";
@@ -251,7 +429,8 @@ QbfSolutionType call_qbf_solver(RTLIL::Module *mod, const QbfSolveOptions &opt,
 
 QbfSolutionType qbf_solve(RTLIL::Module *mod, const QbfSolveOptions &opt) {
 	QbfSolutionType ret, best_soln;
-	const std::string tempdir_name = make_temp_dir(get_base_tmpdir() + "/yosys-qbfsat-XXXXXX");
+	const bool builtin_solver = opt.solver == opt.Solver::Builtin;
+	const std::string tempdir_name = builtin_solver? "" : make_temp_dir(get_base_tmpdir() + "/yosys-qbfsat-XXXXXX");
 	RTLIL::Module *module = mod;
 	RTLIL::Design *design = module->design;
 	std::string module_name = module->name.str();
@@ -291,6 +470,9 @@ QbfSolutionType qbf_solve(RTLIL::Module *mod, const QbfSolveOptions &opt) {
 		Pass::call(module->design, "opt");
 	}
 
+	if (builtin_solver && opt.nobisection && !opt.nooptimize && wire_to_optimize_name != "")
+		log_warning("The built-in solver can't optimize wire \"%s\" without bisection, ignoring it.\n", wire_to_optimize_name.c_str());
+
 	if (opt.nobisection || opt.nooptimize || wire_to_optimize_name == "") {
 		ret = call_qbf_solver(module, opt, tempdir_name, false, 0);
 	} else {
@@ -371,7 +553,7 @@ QbfSolutionType qbf_solve(RTLIL::Module *mod, const QbfSolveOptions &opt) {
 		}
 	}
 
-	if(!opt.nocleanup)
+	if(!opt.nocleanup && !builtin_solver)
 		remove_directory(tempdir_name);
 
 	Pass::call(design, "design -pop");
@@ -418,6 +600,8 @@ QbfSolveOptions parse_args(const std::vector<std::string> &args) {
 					opt.solver = opt.Solver::CVC4;
 				else if (args[opt.argidx+1] == "cvc5")
 					opt.solver = opt.Solver::CVC5;
+				else if (args[opt.argidx+1] == "builtin")
+					opt.solver = opt.Solver::Builtin;
 				else
 					log_cmd_error("Unknown solver \"%s\".\n", args[opt.argidx+1].c_str());
 				opt.argidx++;
@@ -499,6 +683,13 @@ QbfSolveOptions parse_args(const std::vector<std::string> &args) {
 		break;
 	}
 
+	if (opt.solver == opt.Solver::Builtin) {
+		if (opt.dump_final_smt2)
+			log_cmd_error("Option -dump-final-smt2 can't be used with the built-in solver.\n");
+		if (!opt.solver_options.empty())
+			log_cmd_error("Option -solver-option can't be used with the built-in solver.\n");
+	}
+
 	return opt;
 }
 
@@ -544,8 +735,15 @@ struct QbfSatPass : public Pass {
 		log("        hope that the solver supports optimizing quantified bitvector problems.\n");
 		log("\n");
 		log("    -solver <solver>\n");
-		log("        Use a particular solver. Choose one of: \"z3\", \"yices\", \"cvc4\"\n");
-		log("        and \"cvc5\". (default: yices)\n");
+		log("        Use a particular solver. Choose one of: \"z3\", \"yices\", \"cvc4\",\n");
+		log("        \"cvc5\" and \"builtin\". (default: yices)\n");
+		log("\n");
+		log("        The \"builtin\" solver runs a counterexample-guided loop on two SAT\n");
+		log("        solvers inside Yosys instead of calling yosys-smtbmc, which is much\n");
+		log("        faster for small problems. It does not write any SMT-LIBv2 files, so\n");
+		log("        -dump-final-smt2, -solver-option and -show-smtbmc don't apply, and it\n");
+		log("        only optimizes wires using the bisection approach. The timeout applies\n");
+		log("        to each run of the loop.\n");
 		log("\n");
 		log("    -solver-option <name> <value>\n");
 		log("        Set the specified solver option in the SMT-LIBv2 problem file.\n");
@@ -27,6 +27,7 @@
 #include "kernel/sigtools.h"
 #include "kernel/log.h"
 #include "kernel/satgen.h"
+#include "kernel/workers.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <algorithm>
@@ -64,6 +65,7 @@ struct SatHelper
 	SigSet<RTLIL::Cell*> show_drivers;
 	int max_timestep, timeout;
 	bool gotTimeout;
+	int unique_state_constraints;
 
 	SatHelper(RTLIL::Design *design, RTLIL::Module *module, bool enable_undef, bool set_def_formal) :
 		design(design), module(module), sigmap(module), ct(design), satgen(ez.get(), &sigmap)
@@ -78,6 +80,7 @@ struct SatHelper
 		max_timestep = -1;
 		timeout = 0;
 		gotTimeout = false;
+		unique_state_constraints = 0;
 	}
 
 	void check_undef_enabled(const RTLIL::SigSpec &sig)
@@ -434,11 +437,174 @@ struct SatHelper
 		return ez->expression(ezSAT::OpAnd, prove_bits);
 	}
 
-	void force_unique_state(int timestep_from, int timestep_to)
+	// A single property for -prove-each: one -prove or -prove-x expression
+	// or one $assert cell.
+	struct Property {
+		std::string description;
+		std::pair<std::string, std::string> expr;
+		bool prove_x = false;
+		RTLIL::Cell *assert_cell = nullptr;
+	};
+
+	std::vector<Property> get_properties()
+	{
+		std::vector<Property> properties;
+
+		for (auto &s : prove) {
+			Property prop;
+			prop.description = stringf("%s = %s", s.first.c_str(), s.second.c_str());
+			prop.expr = s;
+			properties.push_back(prop);
+		}
+
+		for (auto &s : prove_x) {
+			Property prop;
+			prop.description = stringf("%s = %s (-prove-x)", s.first.c_str(), s.second.c_str());
+			prop.expr = s;
+			prop.prove_x = true;
+			properties.push_back(prop);
+		}
+
+		if (prove_asserts)
+			for (auto cell : module->cells())
+				if (cell->type == ID($assert)) {
+					Property prop;
+					prop.description = stringf("assert %s", log_id(cell));
+					std::string src = cell->get_src_attribute();
+					if (!src.empty())
+						prop.description += stringf(" (%s)", src.c_str());
+					prop.assert_cell = cell;
+					properties.push_back(prop);
+				}
+
+		return properties;
+	}
+
+	int setup_property(const Property &prop, int timestep = -1)
+	{
+		if (prop.assert_cell != nullptr)
+		{
+			RTLIL::SigSpec sig_a = sigmap(prop.assert_cell->getPort(ID::A));
+			RTLIL::SigSpec sig_en = sigmap(prop.assert_cell->getPort(ID::EN));
+			show_signal_pool.add(sig_a);
+			show_signal_pool.add(sig_en);
+
+			int check = satgen.importDefSigSpec(sig_a, timestep).front();
+			int enable = satgen.importDefSigSpec(sig_en, timestep).front();
+			if (satgen.model_undef) {
+				check = ez->AND(ez->NOT(satgen.importUndefSigSpec(sig_a, timestep).front()), check);
+				enable = ez->AND(ez->NOT(satgen.importUndefSigSpec(sig_en, timestep).front()), enable);
+			}
+			return ez->OR(check, ez->NOT(enable));
+		}
+
+		RTLIL::SigSpec lhs, rhs;
+
+		if (!RTLIL::SigSpec::parse_sel(lhs, design, module, prop.expr.first))
+			log_cmd_error("Failed to parse lhs proof expression `%s'.\n", prop.expr.first.c_str());
+		if (!RTLIL::SigSpec::parse_rhs(lhs, rhs, module, prop.expr.second))
+			log_cmd_error("Failed to parse rhs proof expression `%s'.\n", prop.expr.second.c_str());
+		show_signal_pool.add(sigmap(lhs));
+		show_signal_pool.add(sigmap(rhs));
+
+		if (lhs.size() != rhs.size())
+			log_cmd_error("Proof expression with different lhs and rhs sizes: %s (%s, %d bits) vs. %s (%s, %d bits)\n",
+				prop.expr.first.c_str(), log_signal(lhs), lhs.size(), prop.expr.second.c_str(), log_signal(rhs), rhs.size());
+
+		if (!prop.prove_x) {
+			check_undef_enabled(lhs), check_undef_enabled(rhs);
+			return satgen.signals_eq(lhs, rhs, timestep);
+		}
+
+		std::vector<int> value_lhs = satgen.importDefSigSpec(lhs, timestep);
+		std::vector<int> value_rhs = satgen.importDefSigSpec(rhs, timestep);
+
+		std::vector<int> undef_lhs = satgen.importUndefSigSpec(lhs, timestep);
+		std::vector<int> undef_rhs = satgen.importUndefSigSpec(rhs, timestep);
+
+		std::vector<int> prove_bits;
+		for (size_t i = 0; i < value_lhs.size(); i++)
+			prove_bits.push_back(ez->OR(undef_lhs.at(i), ez->AND(ez->NOT(undef_rhs.at(i)), ez->NOT(ez->XOR(value_lhs.at(i), value_rhs.at(i))))));
+		return ez->expression(ezSAT::OpAnd, prove_bits);
+	}
+
+	// Solves with the states in the time steps from timestep_from to
+	// timestep_to required to be unique. The constraints are only added for
+	// pairs of time steps that have the same state in a model, after which
+	// the problem is solved again. In most models all states are unique
+	// anyway, so this avoids adding a quadratic number of constraints in deep
+	// induction proofs.
+	bool solve_unique_states(int timestep_from, int timestep_to, int assumption)
 	{
+		RTLIL::SigSpec state_signals = satgen.initial_state.export_all();
+		std::vector<int> expressions = modelExpressions;
+		for (int i = timestep_from; i <= timestep_to; i++) {
+			std::vector<int> state = satgen.importSigSpec(state_signals, i);
+			expressions.insert(expressions.end(), state.begin(), state.end());
+			if (satgen.model_undef) {
+				std::vector<int> undef = satgen.importUndefSigSpec(state_signals, i);
+				expressions.insert(expressions.end(), undef.begin(), undef.end());
+			}
+		}
+
+		int state_width = GetSize(state_signals) * (satgen.model_undef ? 2 : 1);
+		while (1)
+		{
+			log_assert(gotTimeout == false);
+			ez->setSolverTimeout(timeout);
+			bool success = ez->solve(expressions, modelValues, assumption);
+			if (ez->getSolverTimoutStatus())
+				gotTimeout = true;
+			if (!success)
+				return false;
+
+			// Undef bits are compared in the same way as in SatGen::signals_eq().
+			bool found_duplicate = false;
+			dict<std::vector<bool>, int> first_timestep;
+			for (int i = timestep_from; i <= timestep_to; i++) {
+				auto begin = modelValues.begin() + modelExpressions.size() + (i - timestep_from) * state_width;
+				std::vector<bool> state(begin, begin + GetSize(state_signals));
+				if (satgen.model_undef)
+					for (int j = 0; j < GetSize(state_signals); j++) {
+						bool undef = begin[GetSize(state_signals) + j];
+						state[j] = state[j] || undef;
+						state.push_back(undef);
+					}
+				auto it = first_timestep.find(state);
+				if (it == first_timestep.end()) {
+					first_timestep[state] = i;
+					continue;
+				}
+				ez->assume(ez->NOT(satgen.signals_eq(state_signals, state_signals, it->second, i)));
+				unique_state_constraints++;
+				found_duplicate = true;
+			}
+
+			modelValues.resize(modelExpressions.size());
+			if (!found_duplicate)
+				return true;
+		}
+	}
+
+	// Writes the problem to a DIMACS file, with all the unique-state
+	// constraints that solve_unique_states() adds only when needed. They are
+	// added to a copy of the problem, so that the solver still gets them
+	// lazily.
+	void dump_cnf_unique_states(FILE *f, int timestep_from, int timestep_to)
+	{
+		ezSAT dump_ez(*ez.get());
+		ezSAT *live_ez = satgen.ez;
+		auto imported_signals = satgen.imported_signals;
+		satgen.ez = &dump_ez;
+
 		RTLIL::SigSpec state_signals = satgen.initial_state.export_all();
 		for (int i = timestep_from; i < timestep_to; i++)
-			ez->assume(ez->NOT(satgen.signals_eq(state_signals, state_signals, i, timestep_to)));
+			for (int j = i + 1; j <= timestep_to; j++)
+				dump_ez.assume(dump_ez.NOT(satgen.signals_eq(state_signals, state_signals, i, j)));
+
+		satgen.ez = live_ez;
+		satgen.imported_signals.swap(imported_signals);
+		dump_ez.printDIMACS(f, false);
 	}
 
 	bool solve(const std::vector<int> &assumptions)
@@ -900,6 +1066,142 @@ void print_qed()
 	log("\n");
 }
 
+std::string property_file_name(const std::string &file_name, int index)
+{
+	size_t pos = file_name.rfind('.');
+	if (pos == std::string::npos || file_name.find('/', pos) != std::string::npos)
+		return file_name + stringf("_%d", index);
+	return file_name.substr(0, pos) + stringf("_%d", index) + file_name.substr(pos);
+}
+
+struct ProveEachOptions {
+	int seq_len = 0, prove_skip = 0, num_workers = 0;
+	bool verify = false, falsify = false, fail_on_timeout = false;
+	std::string vcd_file_name, json_file_name;
+};
+
+// Checks every property separately on a single unrolling of the design, so
+// that a failing property doesn't hide the others. The properties are solved
+// one after the other under assumptions, so the solver keeps what it learned
+// from the earlier ones. With -j, ranges of properties are solved in worker
+// processes, which start from a copy of the unrolled problem. Their statuses
+// match a serial run, but their counterexamples can differ.
+void prove_each_property(SatHelper &sathelper, const ProveEachOptions &opts)
+{
+	std::vector<SatHelper::Property> properties = sathelper.get_properties();
+	std::vector<int> property_lits;
+
+	if (properties.empty())
+		log_cmd_error("Got -prove-each but nothing to prove!\n");
+
+	if (opts.seq_len == 0) {
+		sathelper.setup();
+		for (auto &prop : properties)
+			property_lits.push_back(sathelper.setup_property(prop));
+	} else {
+		std::vector<std::vector<int>> prove_bits(GetSize(properties));
+		for (int timestep = 1; timestep <= opts.seq_len; timestep++) {
+			sathelper.setup(timestep, timestep == 1);
+			if (timestep > opts.prove_skip)
+				for (int i = 0; i < GetSize(properties); i++)
+					prove_bits[i].push_back(sathelper.setup_property(properties[i], timestep));
+		}
+		for (auto &bits : prove_bits)
+			property_lits.push_back(sathelper.ez->expression(ezSAT::OpAnd, bits));
+	}
+	sathelper.generate_model();
+
+	log("\nChecking %d properties with %d variables and %d clauses..\n", GetSize(properties),
+			sathelper.ez->numCnfVariables(), sathelper.ez->numCnfClauses());
+	log_flush();
+
+	// 'P' (pass), 'F' (fail) or 'T' (timeout) and the solver time for every property
+	std::vector<char> status(GetSize(properties));
+	std::vector<double> solve_ms(GetSize(properties));
+
+	auto prove_range = [&](int begin, int end) {
+		for (int i = begin; i < end; i++)
+		{
+			log("\nProperty %d: %s\n", i+1, properties[i].description.c_str());
+
+			int64_t solve_begin = PerformanceTimer::query();
+			bool found = sathelper.solve(sathelper.ez->NOT(property_lits[i]));
+			solve_ms[i] = (PerformanceTimer::query() - solve_begin) / 1e6;
+
+			if (found) {
+				status[i] = 'F';
+				log("Property %d: FAIL (%.2f ms), counterexample:\n", i+1, solve_ms[i]);
+				sathelper.print_model();
+				if (!opts.vcd_file_name.empty())
+					sathelper.dump_model_to_vcd(property_file_name(opts.vcd_file_name, i+1));
+				if (!opts.json_file_name.empty())
+					sathelper.dump_model_to_json(property_file_name(opts.json_file_name, i+1));
+			} else if (sathelper.gotTimeout) {
+				status[i] = 'T';
+				sathelper.gotTimeout = false;
+				log("Property %d: TIMEOUT (%.2f ms)\n", i+1, solve_ms[i]);
+			} else {
+				status[i] = 'P';
+				log("Property %d: PASS (%.2f ms)\n", i+1, solve_ms[i]);
+			}
+		}
+	};
+
+	if (opts.num_workers <= 1 || GetSize(properties) < 2 || !worker_processes_available())
+	{
+		prove_range(0, GetSize(properties));
+	}
+	else
+	{
+		int num_jobs = std::min(GetSize(properties), opts.num_workers * 8);
+		auto job_begin = [&](int job_idx) { return int(int64_t(job_idx) * GetSize(properties) / num_jobs); };
+
+		auto job = [&](int job_idx) {
+			prove_range(job_begin(job_idx), job_begin(job_idx + 1));
+			std::string data;
+			for (int i = job_begin(job_idx); i < job_begin(job_idx + 1); i++)
+				data += stringf("%c %.17g\n", status[i], solve_ms[i]);
+			return data;
+		};
+
+		auto done = [&](int job_idx, WorkerResult &result) {
+			if (!result.ok) {
+				prove_range(job_begin(job_idx), job_begin(job_idx + 1));
+				return;
+			}
+			result.replay_log();
+			std::istringstream data(result.data);
+			for (int i = job_begin(job_idx); i < job_begin(job_idx + 1); i++)
+				data >> status[i] >> solve_ms[i];
+			log_assert(!data.fail());
+		};
+
+		run_worker_jobs(num_jobs, opts.num_workers, job, done);
+	}
+
+	int passed = 0, failed = 0, timeouts = 0;
+	log("\nProperty results:\n");
+	for (int i = 0; i < GetSize(properties); i++) {
+		const char *text = status[i] == 'P' ? "PASS" : status[i] == 'F' ? "FAIL" : "TIMEOUT";
+		log("  %5d  %-7s  %10.2f ms  %s\n", i+1, text, solve_ms[i], properties[i].description.c_str());
+		passed += status[i] == 'P', failed += status[i] == 'F', timeouts += status[i] == 'T';
+	}
+	log("Checked %d properties: %d passed, %d failed, %d timed out.\n", GetSize(properties), passed, failed, timeouts);
+
+	if (opts.verify && failed) {
+		log("\n");
+		log_error("Called with -verify and proof did fail!\n");
+	}
+	if (opts.falsify && passed) {
+		log("\n");
+		log_error("Called with -falsify and proof did succeed!\n");
+	}
+	if (opts.fail_on_timeout && timeouts) {
+		log("\n");
+		log_error("Called with -verify and proof did time out!\n");
+	}
+}
+
 struct SatPass : public Pass {
 	SatPass() : Pass("sat", "solve a SAT problem in the circuit") { }
 	void help() override
@@ -1040,6 +1342,25 @@ struct SatPass : public Pass {
 		log("    -prove-asserts\n");
 		log("        Prove that all asserts in the design hold.\n");
 		log("\n");
+		log("    -prove-each\n");
+		log("        Check every -prove and -prove-x expression and every assert (with\n");
+		log("        -prove-asserts) as a separate property instead of proving all of\n");
+		log("        them at once. The design is unrolled once and the properties are\n");
+		log("        solved one after the other under assumptions. The result, solver\n");
+		log("        time and counterexample of every property are printed, followed by\n");
+		log("        a summary. -dump_vcd and -dump_json write one file per failing\n");
+		log("        property, with the number of the property appended to the file name.\n");
+		log("        -verify fails if any property fails, -falsify if any property holds.\n");
+		log("        Not supported with -tempinduct.\n");
+		log("\n");
+		log("    -j <N>\n");
+		log("        With -prove-each, check up to N ranges of properties at once in worker\n");
+		log("        processes. Every property gets the same PASS or FAIL status as without\n");
+		log("        this option (unless -timeout is reached). The counterexamples, and with\n");
+		log("        them the files written by -dump_vcd and -dump_json, can differ: each\n");
+		log("        range starts with a fresh solver, while a serial run carries what the\n");
+		log("        solver learned from one property over to the next.\n");
+		log("\n");
 		log("    -prove-skip <N>\n");
 		log("        Do not enforce the prove-condition for the first <N> time steps.\n");
 		log("\n");
@@ -1071,6 +1392,22 @@ struct SatPass : public Pass {
 		log("    -falsify-no-timeout\n");
 		log("        Like -falsify but do not return an error for timeouts.\n");
 		log("\n");
+		log("The SAT solver used by this and all other SAT-based passes can be selected\n");
+		log("with the scratchpad variable 'sat.solver' (e.g. 'scratchpad -set sat.solver\n");
+		log("portfolio'). The following solvers are available:\n");
+		log("\n");
+		log("    minisat\n");
+		log("        MiniSAT (default). Before solving, variables that are equivalent to\n");
+		log("        other variables are substituted, and MiniSAT eliminates variables and\n");
+		log("        subsumed clauses. Set the scratchpad variable 'sat.simplify' to 0 to\n");
+		log("        disable this.\n");
+		log("\n");
+		log("    portfolio\n");
+		log("        Several differently configured MiniSAT instances running in parallel\n");
+		log("        threads. The first one to finish answers the query. The number of\n");
+		log("        threads is set with the scratchpad variable 'sat.threads' (default:\n");
+		log("        number of hardware threads, between 2 and 4).\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
@@ -1085,7 +1422,8 @@ struct SatPass : public Pass {
 		bool show_regs = false, show_public = false, show_all = false;
 		bool ignore_unknown_cells = false, falsify = false, tempinduct_def = false, set_init_def = false;
 		bool tempinduct_baseonly = false, tempinduct_inductonly = false, set_assumes = false;
-		int tempinduct_skip = 0, stepsize = 1;
+		bool prove_each = false;
+		int tempinduct_skip = 0, stepsize = 1, num_workers = 0;
 		std::string vcd_file_name, json_file_name, cnf_file_name;
 
 		log_header(design, "Executing SAT pass (solving SAT problems in the circuit).\n");
@@ -1223,6 +1561,14 @@ struct SatPass : public Pass {
 				prove_asserts = true;
 				continue;
 			}
+			if (args[argidx] == "-prove-each") {
+				prove_each = true;
+				continue;
+			}
+			if (args[argidx] == "-j" && argidx+1 < args.size()) {
+				num_workers = atoi(args[++argidx].c_str());
+				continue;
+			}
 			if (args[argidx] == "-prove-skip" && argidx+1 < args.size()) {
 				prove_skip = atoi(args[++argidx].c_str());
 				continue;
@@ -1341,6 +1687,12 @@ struct SatPass : public Pass {
 		if (!prove.size() && !prove_x.size() && !prove_asserts && tempinduct)
 			log_cmd_error("Got -tempinduct but nothing to prove!\n");
 
+		if (prove_each && tempinduct)
+			log_cmd_error("Options -prove-each and -tempinduct don't work with each other.\n");
+
+		if (prove_each && (loopcount != 0 || max_undef || !cnf_file_name.empty()))
+			log_cmd_error("The options -max, -all, -max_undef and -dump_cnf are not supported with -prove-each!\n");
+
 		if (prove_skip && tempinduct)
 			log_cmd_error("Options -prove-skip and -tempinduct don't work with each other. Use -seq instead of -prove-skip.\n");
 
@@ -1460,16 +1812,18 @@ struct SatPass : public Pass {
 					int property = basecase.setup_proof(seq_len + inductlen);
 					basecase.generate_model();
 
-					if (inductlen > 1)
-						basecase.force_unique_state(seq_len + 1, seq_len + inductlen);
-
 					if (tempinduct_skip < inductlen)
 					{
 						log("\n[base case %d] Solving problem with %d variables and %d clauses..\n",
 								inductlen, basecase.ez->numCnfVariables(), basecase.ez->numCnfClauses());
 						log_flush();
 
-						if (basecase.solve(basecase.ez->NOT(property))) {
+						int64_t solve_begin = PerformanceTimer::query();
+						bool found_model = basecase.solve_unique_states(seq_len + 1, seq_len + inductlen, basecase.ez->NOT(property));
+						log("[base case %d] Solver time: %.2f ms.\n", inductlen, (PerformanceTimer::query() - solve_begin) / 1e6);
+						log("[base case %d] %d unique-state constraints so far.\n", inductlen, basecase.unique_state_constraints);
+
+						if (found_model) {
 							log("SAT temporal induction proof finished - model found for base case: FAIL!\n");
 							print_proof_failed();
 							basecase.print_model();
@@ -1503,9 +1857,6 @@ struct SatPass : public Pass {
 					int property = inductstep.setup_proof(inductlen + 1);
 					inductstep.generate_model();
 
-					if (inductlen > 1)
-						inductstep.force_unique_state(1, inductlen + 1);
-
 					if (inductlen <= tempinduct_skip || inductlen <= initsteps || inductlen % stepsize != 0)
 					{
 						if (inductlen < tempinduct_skip)
@@ -1533,7 +1884,7 @@ struct SatPass : public Pass {
 							log("Dumping CNF to file `%s'.\n", cnf_file_name.c_str());
 							cnf_file_name.clear();
 
-							inductstep.ez->printDIMACS(f, false);
+							inductstep.dump_cnf_unique_states(f, 1, inductlen + 1);
 							fclose(f);
 						}
 
@@ -1541,7 +1892,12 @@ struct SatPass : public Pass {
 								inductlen, inductstep.ez->numCnfVariables(), inductstep.ez->numCnfClauses());
 						log_flush();
 
-						if (!inductstep.solve(inductstep.ez->NOT(property))) {
+						int64_t solve_begin = PerformanceTimer::query();
+						bool found_model = inductstep.solve_unique_states(1, inductlen + 1, inductstep.ez->NOT(property));
+						log("[induction step %d] Solver time: %.2f ms.\n", inductlen, (PerformanceTimer::query() - solve_begin) / 1e6);
+						log("[induction step %d] %d unique-state constraints so far.\n", inductlen, inductstep.unique_state_constraints);
+
+						if (!found_model) {
 							if (inductstep.gotTimeout)
 								goto timeout;
 							log("Induction step proven: SUCCESS!\n");
@@ -1610,6 +1966,20 @@ struct SatPass : public Pass {
 			sathelper.satgen.ignore_div_by_zero = ignore_div_by_zero;
 			sathelper.ignore_unknown_cells = ignore_unknown_cells;
 
+			if (prove_each) {
+				ProveEachOptions opts;
+				opts.seq_len = seq_len;
+				opts.prove_skip = prove_skip;
+				opts.num_workers = num_workers;
+				opts.verify = verify;
+				opts.falsify = falsify;
+				opts.fail_on_timeout = fail_on_timeout;
+				opts.vcd_file_name = vcd_file_name;
+				opts.json_file_name = json_file_name;
+				prove_each_property(sathelper, opts);
+				return;
+			}
+
 			if (seq_len == 0) {
 				sathelper.setup();
 				if (sathelper.prove.size() || sathelper.prove_x.size() || sathelper.prove_asserts)
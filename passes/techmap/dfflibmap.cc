@@ -32,6 +32,15 @@ struct cell_mapping {
 };
 static std::map<RTLIL::IdString, cell_mapping> cell_mappings;
 
+// The parts of a liberty file used by find_cell() and find_cell_sr().
+static const LibertyFilter liberty_filter = {
+	"/library/cell/dont_use",
+	"/library/cell/area",
+	"/library/cell/ff/*",
+	"/library/cell/pin/direction",
+	"/library/cell/pin/function",
+};
+
 static void logmap(IdString dff)
 {
 	if (cell_mappings.count(dff) == 0) {
@@ -434,7 +443,9 @@ static void dfflibmap(RTLIL::Design *design, RTLIL::Module *module)
 }
 
 struct DfflibmapPass : public Pass {
-	DfflibmapPass() : Pass("dfflibmap", "technology mapping of flip-flops") { }
+	DfflibmapPass() : Pass("dfflibmap", "technology mapping of flip-flops") {
+		LibertyCache::register_filter(liberty_filter);
+	}
 	void help() override
 	{
 		log("\n");
@@ -519,33 +530,30 @@ struct DfflibmapPass : public Pass {
 		if (liberty_file.empty())
 			log_cmd_error("Missing `-liberty liberty_file' option!\n");
 
-		std::ifstream f;
-		f.open(liberty_file.c_str());
-		if (f.fail())
+		std::shared_ptr<const LibertyAst> library = design->liberty_cache->load(liberty_file, liberty_filter);
+		if (library == nullptr)
 			log_cmd_error("Can't open liberty file `%s': %s\n", liberty_file.c_str(), strerror(errno));
-		LibertyParser libparser(f);
-		f.close();
-
-		find_cell(libparser.ast, ID($_DFF_N_), false, false, false, false, dont_use_cells);
-		find_cell(libparser.ast, ID($_DFF_P_), true, false, false, false, dont_use_cells);
-
-		find_cell(libparser.ast, ID($_DFF_NN0_), false, true, false, false, dont_use_cells);
-		find_cell(libparser.ast, ID($_DFF_NN1_), false, true, false, true, dont_use_cells);
-		find_cell(libparser.ast, ID($_DFF_NP0_), false, true, true, false, dont_use_cells);
-		find_cell(libparser.ast, ID($_DFF_NP1_), false, true, true, true, dont_use_cells);
-		find_cell(libparser.ast, ID($_DFF_PN0_), true, true, false, false, dont_use_cells);
-		find_cell(libparser.ast, ID($_DFF_PN1_), true, true, false, true, dont_use_cells);
-		find_cell(libparser.ast, ID($_DFF_PP0_), true, true, true, false, dont_use_cells);
-		find_cell(libparser.ast, ID($_DFF_PP1_), true, true, true, true, dont_use_cells);
-
-		find_cell_sr(libparser.ast, ID($_DFFSR_NNN_), false, false, false, dont_use_cells);
-		find_cell_sr(libparser.ast, ID($_DFFSR_NNP_), false, false, true, dont_use_cells);
-		find_cell_sr(libparser.ast, ID($_DFFSR_NPN_), false, true, false, dont_use_cells);
-		find_cell_sr(libparser.ast, ID($_DFFSR_NPP_), false, true, true, dont_use_cells);
-		find_cell_sr(libparser.ast, ID($_DFFSR_PNN_), true, false, false, dont_use_cells);
-		find_cell_sr(libparser.ast, ID($_DFFSR_PNP_), true, false, true, dont_use_cells);
-		find_cell_sr(libparser.ast, ID($_DFFSR_PPN_), true, true, false, dont_use_cells);
-		find_cell_sr(libparser.ast, ID($_DFFSR_PPP_), true, true, true, dont_use_cells);
+
+		find_cell(library.get(), ID($_DFF_N_), false, false, false, false, dont_use_cells);
+		find_cell(library.get(), ID($_DFF_P_), true, false, false, false, dont_use_cells);
+
+		find_cell(library.get(), ID($_DFF_NN0_), false, true, false, false, dont_use_cells);
+		find_cell(library.get(), ID($_DFF_NN1_), false, true, false, true, dont_use_cells);
+		find_cell(library.get(), ID($_DFF_NP0_), false, true, true, false, dont_use_cells);
+		find_cell(library.get(), ID($_DFF_NP1_), false, true, true, true, dont_use_cells);
+		find_cell(library.get(), ID($_DFF_PN0_), true, true, false, false, dont_use_cells);
+		find_cell(library.get(), ID($_DFF_PN1_), true, true, false, true, dont_use_cells);
+		find_cell(library.get(), ID($_DFF_PP0_), true, true, true, false, dont_use_cells);
+		find_cell(library.get(), ID($_DFF_PP1_), true, true, true, true, dont_use_cells);
+
+		find_cell_sr(library.get(), ID($_DFFSR_NNN_), false, false, false, dont_use_cells);
+		find_cell_sr(library.get(), ID($_DFFSR_NNP_), false, false, true, dont_use_cells);
+		find_cell_sr(library.get(), ID($_DFFSR_NPN_), false, true, false, dont_use_cells);
+		find_cell_sr(library.get(), ID($_DFFSR_NPP_), false, true, true, dont_use_cells);
+		find_cell_sr(library.get(), ID($_DFFSR_PNN_), true, false, false, dont_use_cells);
+		find_cell_sr(library.get(), ID($_DFFSR_PNP_), true, false, true, dont_use_cells);
+		find_cell_sr(library.get(), ID($_DFFSR_PPN_), true, true, false, dont_use_cells);
+		find_cell_sr(library.get(), ID($_DFFSR_PPP_), true, true, true, dont_use_cells);
 
 		log("  final dff cell mappings:\n");
 		logmap_all();
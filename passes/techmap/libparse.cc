@@ -26,12 +26,107 @@
 #include <iostream>
 #include <sstream>
 
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #ifndef FILTERLIB
 #include "kernel/log.h"
 #endif
+#if defined(YOSYS_ENABLE_ZLIB) && !defined(FILTERLIB)
+#include <zlib.h>
+#endif
 
 using namespace Yosys;
 
+LibertyInput::LibertyInput(std::istream &f)
+{
+	std::stringstream ss;
+	ss << f.rdbuf();
+	storage = ss.str();
+	begin = storage.data();
+	end = begin + storage.size();
+}
+
+LibertyInput::LibertyInput(const std::string &filename)
+{
+#ifndef _WIN32
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+		void *addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr != MAP_FAILED) {
+			madvise(addr, info.st_size, MADV_SEQUENTIAL);
+			mapping = addr;
+			mapping_size = info.st_size;
+			begin = static_cast<const char*>(addr);
+			end = begin + mapping_size;
+		}
+	}
+	close(fd);
+	if (mapping == nullptr)
+#endif
+	{
+		// Fall back to reading the file if it can't be mapped (e.g. it is empty, or it is a pipe).
+		std::ifstream f(filename.c_str(), std::ifstream::binary);
+		if (f.fail())
+			return;
+		std::stringstream ss;
+		ss << f.rdbuf();
+		storage = ss.str();
+		begin = storage.data();
+		end = begin + storage.size();
+	}
+
+#ifndef FILTERLIB
+	// Compressed files are decompressed into memory; the lexer can only work on the plain text.
+	if (end - begin >= 2 && (unsigned char)begin[0] == 0x1f && (unsigned char)begin[1] == 0x8b) {
+#ifdef YOSYS_ENABLE_ZLIB
+		log("Found gzip magic in file `%s', decompressing using zlib.\n", filename.c_str());
+		std::string text;
+		gzFile gzf = gzopen(filename.c_str(), "rb");
+		if (gzf == nullptr)
+			log_error("Can't decompress liberty file `%s'.\n", filename.c_str());
+		char buffer[8192];
+		int bytes_read;
+		while ((bytes_read = gzread(gzf, buffer, sizeof(buffer))) > 0)
+			text.append(buffer, bytes_read);
+		bool failed = bytes_read < 0;
+		gzclose(gzf);
+		if (failed)
+			log_error("Can't decompress liberty file `%s'.\n", filename.c_str());
+		release_mapping();
+		storage = std::move(text);
+		begin = storage.data();
+		end = begin + storage.size();
+#else
+		log_error("File `%s' is a gzip file, but Yosys is compiled without zlib.\n", filename.c_str());
+#endif
+	}
+#endif
+}
+
+void LibertyInput::release_mapping()
+{
+#ifndef _WIN32
+	if (mapping != nullptr)
+		munmap(mapping, mapping_size);
+#endif
+	mapping = nullptr;
+	mapping_size = 0;
+}
+
+LibertyInput::~LibertyInput()
+{
+	release_mapping();
+}
+
 LibertyAst::~LibertyAst()
 {
 	for (auto child : children)
@@ -80,121 +175,251 @@ void LibertyAst::dump(FILE *f, sieve &blacklist, sieve &whitelist, std::string i
 		fprintf(f, " ;\n");
 }
 
+void LibertyFilter::add(const std::string &path)
+{
+	paths.insert(path);
+	for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1))
+		prefixes.insert(path.substr(0, pos));
+}
+
+void LibertyFilter::add(const LibertyFilter &other)
+{
+	paths.insert(other.paths.begin(), other.paths.end());
+	prefixes.insert(other.prefixes.begin(), other.prefixes.end());
+}
+
+bool LibertyFilter::covers(const LibertyFilter &other) const
+{
+	for (auto &path : other.paths) {
+		if (paths.count(path) || paths.count(path + "/*"))
+			continue;
+		bool covered = false;
+		for (size_t pos = path.rfind('/'); pos != std::string::npos && !covered; pos = pos > 0 ? path.rfind('/', pos - 1) : std::string::npos)
+			covered = paths.count(path.substr(0, pos) + "/*") > 0;
+		if (!covered)
+			return false;
+	}
+	return true;
+}
+
+bool LibertyFilter::match(const std::string &path, bool &all) const
+{
+	all = paths.count(path + "/*") > 0;
+	return all || paths.count(path) > 0 || prefixes.count(path) > 0;
+}
+
 int LibertyParser::lexer(std::string &str)
+{
+	std::string_view token;
+	int tok = lexer(token);
+	if (tok == 'v' || tok == '+' || tok == '-')
+		str.assign(token.data(), token.size());
+	return tok;
+}
+
+static inline bool is_identifier_char(int c)
+{
+	return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_' || c == '-' || c == '+' || c == '.';
+}
+
+int LibertyParser::lexer(std::string_view &str)
 {
 	int c;
 
-	// eat whitespace
-	do {
-		c = f.get();
-	} while (c == ' ' || c == '\t' || c == '\r');
-
-	// search for identifiers, numbers, plus or minus.
-	if (('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_' || c == '-' || c == '+' || c == '.') {
-		str = static_cast<char>(c);
-		while (1) {
-			c = f.get();
-			if (('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_' || c == '-' || c == '+' || c == '.')
-				str += c;
-			else
-				break;
-		}
-		f.unget();
-		if (str == "+" || str == "-") {
-			/* Single operator is not an identifier */
-			// fprintf(stderr, "LEX: char >>%s<<\n", str.c_str());
-			return str[0];
+	while (1)
+	{
+		// eat whitespace
+		while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+			pos++;
+
+		if (pos == end)
+			return EOF;
+		c = static_cast<unsigned char>(*pos++);
+
+		// search for identifiers, numbers, plus or minus.
+		if (is_identifier_char(c)) {
+			const char *start = pos - 1;
+			while (pos < end && is_identifier_char(static_cast<unsigned char>(*pos)))
+				pos++;
+			str = std::string_view(start, pos - start);
+			if (str == "+" || str == "-") {
+				/* Single operator is not an identifier */
+				return str[0];
+			}
+			return 'v';
 		}
-		else {
-			// fprintf(stderr, "LEX: identifier >>%s<<\n", str.c_str());
+
+		// if it wasn't an identifer, number of array range,
+		// maybe it's a string?
+		if (c == '"') {
+			const char *start = pos;
+			while (pos < end && *pos != '"') {
+				if (*pos == '\n')
+					line++;
+				pos++;
+			}
+			str = std::string_view(start, pos - start);
+			if (pos < end)
+				pos++;
 			return 'v';
 		}
-	}
 
-	// if it wasn't an identifer, number of array range,
-	// maybe it's a string?
-	if (c == '"') {
-		str = "";
-		while (1) {
-			c = f.get();
-			if (c == '\n')
+		// if it wasn't a string, perhaps it's a comment or a forward slash?
+		if (c == '/') {
+			if (pos < end && *pos == '*') {         // start of '/*' block comment
+				pos++;
+				while (pos < end && !(*pos == '/' && pos[-1] == '*')) {
+					if (*pos == '\n')
+						line++;
+					pos++;
+				}
+				if (pos < end)
+					pos++;
+				continue;
+			} else if (pos < end && *pos == '/') {  // start of '//' line comment
+				while (pos < end && *pos != '\n')
+					pos++;
+				if (pos < end)
+					pos++;
 				line++;
-			if (c == '"')
-				break;
-			str += c;
+				continue;
+			}
+			return '/';             // a single '/' charater.
 		}
-		// fprintf(stderr, "LEX: string >>%s<<\n", str.c_str());
-		return 'v';
-	}
 
-	// if it wasn't a string, perhaps it's a comment or a forward slash?
-	if (c == '/') {
-		c = f.get();
-		if (c == '*') {         // start of '/*' block comment
-			int last_c = 0;
-			while (c > 0 && (last_c != '*' || c != '/')) {
-				last_c = c;
-				c = f.get();
-				if (c == '\n')
-					line++;
+		// check for a backslash
+		if (c == '\\') {
+			const char *next = pos;
+			if (next < end && *next == '\r')
+				next++;
+			if (next < end && *next == '\n') {
+				pos = next + 1;
+				line++;
+				continue;
 			}
-			return lexer(str);
-		} else if (c == '/') {  // start of '//' line comment
-			while (c > 0 && c != '\n')
-				c = f.get();
-			line++;
-			return lexer(str);
+			return '\\';
 		}
-		f.unget();
-		// fprintf(stderr, "LEX: char >>/<<\n");
-		return '/';             // a single '/' charater.
-	}
 
-	// check for a backslash
-	if (c == '\\') {
-		c = f.get();		
-		if (c == '\r')
-			c = f.get();
+		// check for a new line
 		if (c == '\n') {
 			line++;
-			return lexer(str);
+			return 'n';
 		}
-		f.unget();
-		return '\\';
-	}
 
-	// check for a new line
-	if (c == '\n') {
-		line++;
-		return 'n';
+		// anything else, such as ';' will get passed
+		// through as literal items.
+		return c;
 	}
+}
 
-	// anything else, such as ';' will get passed
-	// through as literal items.
-
-	// if (c >= 32 && c < 255)
-	// 	fprintf(stderr, "LEX: char >>%c<<\n", c);
-	// else
-	// 	fprintf(stderr, "LEX: char %d\n", c);
-	return c;
+void LibertyParser::skip()
+{
+	// This follows the lexer closely enough to find the end of the statement, but doesn't produce any tokens.
+	int depth = 0;
+	while (pos < end)
+	{
+		char c = *pos++;
+		switch (c)
+		{
+		case '"':
+			while (pos < end && *pos != '"') {
+				if (*pos == '\n')
+					line++;
+				pos++;
+			}
+			if (pos < end)
+				pos++;
+			break;
+		case '/':
+			if (pos < end && *pos == '*') {
+				pos++;
+				while (pos < end && !(*pos == '/' && pos[-1] == '*')) {
+					if (*pos == '\n')
+						line++;
+					pos++;
+				}
+				if (pos < end)
+					pos++;
+			} else if (pos < end && *pos == '/') {
+				// the lexer drops the newline that ends a line comment
+				while (pos < end && *pos != '\n')
+					pos++;
+				if (pos < end)
+					pos++;
+				line++;
+			}
+			break;
+		case '\\':
+			if (pos < end && *pos == '\r' && pos + 1 < end && pos[1] == '\n')
+				pos++;
+			if (pos < end && *pos == '\n') {
+				pos++;
+				line++;
+			}
+			break;
+		case '(':
+		case '{':
+			depth++;
+			break;
+		case ')':
+			depth--;
+			break;
+		case '}':
+			if (depth == 0) {
+				// end of the enclosing group; leave it to the caller
+				pos--;
+				return;
+			}
+			if (--depth == 0)
+				return;
+			break;
+		case '\n':
+			line++;
+			if (depth == 0)
+				return;
+			break;
+		case ';':
+			if (depth == 0)
+				return;
+			break;
+		}
+	}
 }
 
-LibertyAst *LibertyParser::parse()
+LibertyAst *LibertyParser::parse(const std::string &parent_path, bool parent_all)
 {
-	std::string str;
+	std::string_view str;
+	std::string path;
+	bool all = parent_all;
+	int tok;
 
-	int tok = lexer(str);
+	while (1)
+	{
+		tok = lexer(str);
 
-	// there are liberty files in the wild that
-	// have superfluous ';' at the end of
-	// a  { ... }. We simply ignore a ';' here.
-	// and get to the next statement.
+		// there are liberty files in the wild that
+		// have superfluous ';' at the end of
+		// a  { ... }. We simply ignore a ';' here.
+		// and get to the next statement.
 
-	while ((tok == 'n') || (tok == ';'))
-		tok = lexer(str);
+		while ((tok == 'n') || (tok == ';'))
+			tok = lexer(str);
 
-	if (tok == '}' || tok < 0)
-		return NULL;
+		if (tok == '}' || tok < 0)
+			return NULL;
+
+		// the top-level group is always kept
+		if (tok != 'v' || parent_all || parent_path.empty())
+			break;
+
+		path.assign(parent_path).append("/").append(str);
+		if (filter->match(path, all))
+			break;
+		skip();
+	}
+
+	if (!all && parent_path.empty() && tok == 'v')
+		filter->match(path.assign("/").append(str), all);
 
 	if (tok != 'v') {
 		std::string eReport;
@@ -258,7 +483,7 @@ LibertyAst *LibertyParser::parse()
 
 		if (tok == '(') {
 			while (1) {
-				std::string arg;
+				std::string_view arg;
 				tok = lexer(arg);
 				if (tok == ',')
 					continue;
@@ -270,7 +495,6 @@ LibertyAst *LibertyParser::parse()
 				if (tok == '[')
 				{
 					// parse vector range [A] or [A:B]
-					std::string arg;
 					tok = lexer(arg);
 					if (tok != 'v')
 					{
@@ -327,14 +551,14 @@ LibertyAst *LibertyParser::parse()
 						error();
 					}
 				}
-				ast->args.push_back(arg);
+				ast->args.emplace_back(arg);
 			}
 			continue;
 		}
 
 		if (tok == '{') {
 			while (1) {
-				LibertyAst *child = parse();
+				LibertyAst *child = parse(path, all);
 				if (child == NULL)
 					break;
 				ast->children.push_back(child);
@@ -363,6 +587,41 @@ void LibertyParser::error(const std::string &str)
 	log_error("%s", ss.str().c_str());
 }
 
+LibertyFilter &LibertyCache::registered_filter()
+{
+	static LibertyFilter filter;
+	return filter;
+}
+
+std::shared_ptr<const LibertyAst> LibertyCache::load(const std::string &filename, const LibertyFilter &needed)
+{
+	struct stat info;
+	if (stat(filename.c_str(), &info) != 0)
+		return nullptr;
+
+	if (!filter.covers(needed))
+		filter.add(needed);
+
+	auto it = entries.find(filename);
+	if (it != entries.end()) {
+		if (it->second.mtime == (long long)info.st_mtime && it->second.size == (long long)info.st_size &&
+				it->second.filter.covers(needed)) {
+			log("Reusing parsed liberty file `%s'.\n", filename.c_str());
+			return std::shared_ptr<const LibertyAst>(it->second.parser, it->second.parser->ast);
+		}
+		entries.erase(it);
+	}
+
+	LibertyInput input(filename);
+	if (!input.ok())
+		return nullptr;
+	auto parser = std::make_shared<const LibertyParser>(input, &filter);
+	if (parser->ast == nullptr)
+		log_error("Liberty file `%s' is empty.\n", filename.c_str());
+	entries[filename] = {(long long)info.st_mtime, (long long)info.st_size, filter, parser};
+	return std::shared_ptr<const LibertyAst>(parser, parser->ast);
+}
+
 #else
 
 void LibertyParser::error()
@@ -22,8 +22,11 @@
 
 #include <stdio.h>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
+#include <map>
+#include <memory>
 
 namespace Yosys
 {
@@ -39,29 +42,113 @@ namespace Yosys
 		void dump(FILE *f, sieve &blacklist, sieve &whitelist, std::string indent = "", std::string path = "", bool path_ok = false) const;
 	};
 
+	// The contents of a liberty file. Plain files are mapped into memory where possible, so that the lexer can
+	// return slices of the contents instead of copying them out character by character. Gzip-compressed files are
+	// decompressed into memory instead.
+	class LibertyInput
+	{
+	private:
+		std::string storage;
+		void *mapping = nullptr;
+		size_t mapping_size = 0;
+
+		void release_mapping();
+
+	public:
+		const char *begin = nullptr, *end = nullptr;
+
+		LibertyInput(std::istream &f);
+		LibertyInput(const std::string &filename);
+		~LibertyInput();
+
+		LibertyInput(const LibertyInput &) = delete;
+		LibertyInput &operator=(const LibertyInput &) = delete;
+
+		// False if the file could not be opened; errno holds the reason.
+		bool ok() const { return begin != nullptr; }
+	};
+
+	// Selects the parts of a liberty file that are parsed into a LibertyAst. Statements are named by their path of
+	// ids, e.g. "/library/cell/area", and a path ending in "/*" selects everything below a group. The groups leading
+	// to a selected statement are kept as well, but only with their selected children. Everything else is skipped
+	// by the lexer without being allocated, which matters for the timing tables that make up most of a library.
+	struct LibertyFilter
+	{
+		std::set<std::string> paths, prefixes;
+
+		LibertyFilter() {}
+		LibertyFilter(std::initializer_list<std::string> paths) { for (auto &path : paths) add(path); }
+
+		void add(const std::string &path);
+		void add(const LibertyFilter &other);
+
+		// True if every statement selected by `other` is also selected by this filter.
+		bool covers(const LibertyFilter &other) const;
+
+		// Returns whether the statement at `path` is kept, and sets `all` if everything below it is kept too.
+		bool match(const std::string &path, bool &all) const;
+	};
+
 	class LibertyParser
 	{
 	private:
-		std::istream &f;
+		const char *pos, *end;
 		int line;
+		const LibertyFilter *filter;
 
 		/* lexer return values:
 		   'v': identifier, string, array range [...] -> str holds the token string
 		   'n': newline
 		   anything else is a single character.
 		*/
+		int lexer(std::string_view &str);
 		int lexer(std::string &str);
-		
-		LibertyAst *parse();
+
+		// Skips the remainder of a statement that isn't selected by the filter.
+		void skip();
+
+		LibertyAst *parse(const std::string &parent_path, bool parent_all);
 		void error();
 		void error(const std::string &str);
 
 	public:
 		const LibertyAst *ast;
 
-		LibertyParser(std::istream &f) : f(f), line(1), ast(parse()) {}
+		LibertyParser(const LibertyInput &input, const LibertyFilter *filter = nullptr) :
+				pos(input.begin), end(input.end), line(1), filter(filter), ast(parse("", filter == nullptr || filter->paths.count("/*"))) {}
+		LibertyParser(std::istream &f, const LibertyFilter *filter = nullptr) : LibertyParser(LibertyInput(f), filter) {}
 		~LibertyParser() { if (ast) delete ast; }
 	};
+
+#ifndef FILTERLIB
+	// Parsed liberty files, shared between all commands that read them (e.g. `read_liberty`, `dfflibmap` and
+	// `stat -liberty`). An entry is reused as long as the size and modification time of the file are unchanged.
+	// The cache belongs to a design (see `RTLIL::Design::liberty_cache`) and is dropped together with it.
+	//
+	// Files are parsed with the union of the filters of all commands, so that each file is parsed only once.
+	// Commands register their filters with `register_filter()` when they are constructed; a filter that wasn't
+	// registered is added to the union the first time it is used, and causes the file to be parsed again.
+	struct LibertyCache
+	{
+		struct entry_t {
+			long long mtime, size;
+			LibertyFilter filter;
+			std::shared_ptr<const LibertyParser> parser;
+		};
+		std::map<std::string, entry_t> entries;
+		LibertyFilter filter;
+
+		LibertyCache() : filter(registered_filter()) {}
+
+		static LibertyFilter &registered_filter();
+		static void register_filter(const LibertyFilter &filter) { registered_filter().add(filter); }
+
+		// Returns the parsed contents of the file, or a null pointer if it can't be opened (errno holds the
+		// reason). Only the statements selected by `needed` are guaranteed to be present.
+		std::shared_ptr<const LibertyAst> load(const std::string &filename, const LibertyFilter &needed);
+		std::shared_ptr<const LibertyAst> load(const std::string &filename) { return load(filename, LibertyFilter{"/*"}); }
+	};
+#endif
 }
 
 #endif
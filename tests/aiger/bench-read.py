@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+
+# Measures the throughput of read_aiger on a large synthetic binary AIG.
+#
+# Usage: bench-read.py [yosys-binary [number-of-ands]]
+
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import time
+
+yosys = sys.argv[1] if len(sys.argv) > 1 else "../../yosys"
+num_ands = int(sys.argv[2]) if len(sys.argv) > 2 else 1000000
+num_inputs, num_latches, num_outputs = 64, 32, 64
+
+def encode(delta):
+    data = bytearray()
+    while delta >= 0x80:
+        data.append((delta & 0x7f) | 0x80)
+        delta >>= 7
+    data.append(delta)
+    return data
+
+def generate(path):
+    rng = random.Random(1)
+    first_and = num_inputs + num_latches + 1
+    max_var = first_and + num_ands - 1
+    ands = bytearray()
+    for index in range(num_ands):
+        lhs = 2 * (first_and + index)
+        # Each AND uses the previous one, so that all of them are reachable from the outputs, and otherwise has
+        # mostly local fan-in, like the output of a technology-independent optimizer.
+        window = min(lhs // 2 - 1, 1000)
+        rhs = sorted([lhs - 2 + rng.randint(0, 1), 2 * (lhs // 2 - rng.randint(1, window)) + rng.randint(0, 1)], reverse=True)
+        ands += encode(lhs - rhs[0]) + encode(rhs[0] - rhs[1])
+    with open(path, "wb") as f:
+        f.write(b"aig %d %d %d %d %d\n" % (max_var, num_inputs, num_latches, num_outputs, num_ands))
+        for index in range(num_latches):
+            f.write(b"%d\n" % (2 * (max_var - index) + (index & 1)))
+        for index in range(num_outputs):
+            f.write(b"%d\n" % (2 * (max_var - num_latches - index) + (index & 1)))
+        f.write(ands)
+        for index in range(num_inputs):
+            f.write(b"i%d in%d\n" % (index, index))
+        for index in range(num_outputs):
+            f.write(b"o%d out%d\n" % (index, index))
+        f.write(b"c\nsynthetic AIG for reader benchmarks\n")
+
+def run(script):
+    start = time.perf_counter()
+    log = subprocess.run([yosys, "-d", "-p", script], check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    return time.perf_counter() - start, log
+
+def pass_time(log, name):
+    # Parses the "Time spent" summary that yosys -d prints at exit.
+    for line in log.splitlines():
+        fields = line.split()
+        if len(fields) == 6 and fields[4] == "sec" and fields[5] == name:
+            return float(fields[3])
+    return 0.0
+
+with tempfile.TemporaryDirectory() as tmp:
+    path = os.path.join(tmp, "bench.aig")
+    generate(path)
+    print("Synthetic AIG: %d ANDs, %.1f MB" % (num_ands, os.path.getsize(path) / 1e6))
+
+    startup, _ = run("")
+    read, log = run("read_aiger -module_name bench %s" % path)
+    read -= startup
+    clean = pass_time(log, "clean")
+    print("read_aiger: %.3f s (%.0f kANDs/s), of which %.3f s in the final clean" % (read, num_ands / read / 1000, clean))
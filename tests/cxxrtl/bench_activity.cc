@@ -0,0 +1,51 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "cxxrtl-bench-activity.cc"
+#include "cxxrtl-bench-activity-reference.cc"
+
+template<class ModuleT>
+double simulate(ModuleT &top, size_t cycles, unsigned enable)
+{
+	top.p_en.set(enable);
+	auto start = std::chrono::steady_clock::now();
+	for (size_t cycle = 0; cycle < cycles; cycle++) {
+		top.p_clk.set(false);
+		top.step();
+		top.p_clk.set(true);
+		top.step();
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return cycles / elapsed.count();
+}
+
+// Measures simulation throughput of a design with clock gated module instances, with and without activity
+// tracking, for several amounts of enabled instances, and checks that the results are the same.
+int main(int argc, char **argv)
+{
+	size_t cycles = argc > 1 ? atoi(argv[1]) : 1000;
+
+	for (unsigned enable : {0xffu, 0x0fu, 0x01u, 0x00u}) {
+		cxxrtl_activity::p_bench__activity top;
+		double activity_speed = simulate(top, cycles, enable);
+		cxxrtl_reference::p_bench__activity reference_top;
+		double reference_speed = simulate(reference_top, cycles, enable);
+
+		if (top.p_digest.curr != reference_top.p_digest.curr) {
+			std::printf("Result with en=%02x differs from reference!\n", enable);
+			return 1;
+		}
+
+		cxxrtl::activity_items items;
+		top.activity_info(items);
+		cxxrtl::activity_stats total;
+		for (auto &item : items) {
+			total.evaluated += item.second.evaluated;
+			total.skipped += item.second.skipped;
+		}
+		std::printf("en=%02x: %.0f cycles/s (%.0f%% skipped), %.0f cycles/s without activity tracking\n",
+		            enable, activity_speed, total.skip_ratio() * 100, reference_speed);
+	}
+	return 0;
+}
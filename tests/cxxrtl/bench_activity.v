@@ -0,0 +1,33 @@
+// A design with several computationally heavy module instances behind clock gates, used for measuring
+// the throughput of `write_cxxrtl -activity` when most of the design is idle.
+module bench_activity_core #(
+    parameter SEED = 1
+) (
+    input              clk,
+    output reg [255:0] state = SEED,
+    output     [255:0] mixed
+);
+    assign mixed = (state * 256'hd1342543de82ef95) ^ (state >> 17) ^ (state << 31);
+    always @(posedge clk)
+        state <= mixed + {state[127:0], state[255:128]};
+endmodule
+
+module bench_activity (
+    input              clk,
+    input        [7:0] en,
+    output reg [255:0] digest
+);
+    wire [255:0] mixed [0:7];
+    genvar i;
+    generate
+        for (i = 0; i < 8; i = i + 1) begin : cores
+            bench_activity_core #(.SEED(i + 1)) core (
+                .clk   (clk & en[i]),
+                .mixed (mixed[i])
+            );
+        end
+    endgenerate
+    always @(posedge clk)
+        digest <= mixed[0] ^ mixed[1] ^ mixed[2] ^ mixed[3] ^
+                  mixed[4] ^ mixed[5] ^ mixed[6] ^ mixed[7];
+endmodule
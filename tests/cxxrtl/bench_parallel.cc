@@ -0,0 +1,38 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "cxxrtl-bench-parallel.cc"
+
+// Measures simulation throughput of a design with several independent module instances for each
+// amount of threads given on the command line, and checks that the result does not depend on it.
+int main(int argc, char **argv)
+{
+	size_t cycles = argc > 1 ? atoi(argv[1]) : 1000;
+
+	value<256> reference;
+	for (int arg = 2; arg < argc || arg == 2; arg++) {
+		size_t threads = arg < argc ? atoi(argv[arg]) : 1;
+		cxxrtl::default_worker_pool().resize(threads);
+
+		cxxrtl_design::p_bench__parallel top;
+		auto start = std::chrono::steady_clock::now();
+		for (size_t cycle = 0; cycle < cycles; cycle++) {
+			top.p_clk.set(false);
+			top.step();
+			top.p_clk.set(true);
+			top.step();
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if (arg == 2)
+			reference = top.p_digest.curr;
+		else if (top.p_digest.curr != reference) {
+			std::printf("Result with %zu threads differs from result with %s threads!\n", threads, argv[2]);
+			return 1;
+		}
+		std::printf("%zu threads: %.0f cycles/s\n", threads, cycles / elapsed.count());
+	}
+	return 0;
+}
@@ -0,0 +1,31 @@
+// A design with several independent, computationally heavy module instances, used for measuring
+// the throughput of `write_cxxrtl -parallel` against the amount of threads.
+module bench_parallel_core #(
+    parameter SEED = 1
+) (
+    input              clk,
+    output reg [255:0] state = SEED
+);
+    wire [255:0] mixed = (state * 256'hd1342543de82ef95) ^ (state >> 17) ^ (state << 31);
+    always @(posedge clk)
+        state <= mixed + {state[127:0], state[255:128]};
+endmodule
+
+module bench_parallel (
+    input              clk,
+    output reg [255:0] digest
+);
+    wire [255:0] states [0:7];
+    genvar i;
+    generate
+        for (i = 0; i < 8; i = i + 1) begin : cores
+            bench_parallel_core #(.SEED(i + 1)) core (
+                .clk   (clk),
+                .state (states[i])
+            );
+        end
+    endgenerate
+    always @(posedge clk)
+        digest <= states[0] ^ states[1] ^ states[2] ^ states[3] ^
+                  states[4] ^ states[5] ^ states[6] ^ states[7];
+endmodule
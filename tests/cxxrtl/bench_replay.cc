@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <cxxrtl/cxxrtl_replay.h>
+
+#include "cxxrtl-bench-trace.cc"
+
+// Records `cycles` cycles of the design, and returns the value of the digest at each sample.
+std::vector<uint64_t> record(const char *filename, size_t cycles, size_t checkpoint_interval)
+{
+	cxxrtl_design::p_bench__trace top;
+	cxxrtl::spool spool(filename);
+	cxxrtl::recorder recorder(spool);
+	recorder.set_checkpoint_interval(checkpoint_interval);
+	recorder.start(top);
+	recorder.record_complete();
+	std::vector<uint64_t> digests { top.p_digest.get<uint64_t>() };
+	for (size_t cycle = 0; cycle < cycles * 2; cycle++) {
+		recorder.advance_time(cxxrtl::time(0, 1000000));
+		top.p_clk.set(cycle % 2 == 1);
+		top.eval();
+		recorder.record_incremental(top);
+		digests.push_back(top.p_digest.get<uint64_t>());
+	}
+	return digests;
+}
+
+// Rewinds to random times in the recording, and checks that the design state is the same as it was while recording.
+double seek(const char *filename, const std::vector<uint64_t> &digests, size_t seeks)
+{
+	cxxrtl_design::p_bench__trace top;
+	cxxrtl::spool spool(filename);
+	cxxrtl::player player(spool);
+	player.start(top);
+
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<size_t> distribution(0, digests.size() - 1);
+	auto start = std::chrono::steady_clock::now();
+	for (size_t n = 0; n < seeks; n++) {
+		size_t sample = distribution(generator);
+		if (!player.rewind_to_or_before(cxxrtl::time(0, sample * 1000000), nullptr) ||
+				player.current_time() != cxxrtl::time(0, sample * 1000000) ||
+				top.p_digest.get<uint64_t>() != digests[sample]) {
+			std::printf("Wrong state after rewinding to sample %zu!\n", sample);
+			exit(1);
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return seeks / elapsed.count();
+}
+
+// Measures how fast the player rewinds to random points in a replay log recorded with and without periodic
+// checkpoints, and the size of the log in both cases.
+int main(int argc, char **argv)
+{
+	size_t cycles = argc > 1 ? atoi(argv[1]) : 1000;
+	size_t seeks = argc > 2 ? atoi(argv[2]) : 100;
+
+	for (size_t checkpoint_interval : {0, 1000}) {
+		std::string filename = "cxxrtl-bench-replay-" + std::to_string(checkpoint_interval) + ".spool";
+		std::vector<uint64_t> digests = record(filename.c_str(), cycles, checkpoint_interval);
+		double speed = seek(filename.c_str(), digests, seeks);
+
+		FILE *file = fopen(filename.c_str(), "rb");
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fclose(file);
+		if (checkpoint_interval == 0)
+			std::printf("without checkpoints: %.1f seeks/s, %ld bytes\n", speed, size);
+		else
+			std::printf("checkpoint every %zu samples: %.1f seeks/s, %ld bytes\n", checkpoint_interval, speed, size);
+	}
+	return 0;
+}
@@ -0,0 +1,112 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <cxxrtl/cxxrtl_vcd.h>
+#include <cxxrtl/cxxrtl_replay.h>
+
+#include "cxxrtl-bench-trace.cc"
+
+template<class SampleT>
+double simulate(cxxrtl_design::p_bench__trace &top, size_t cycles, const SampleT &sample)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (size_t cycle = 0; cycle < cycles; cycle++) {
+		top.p_clk.set(false);
+		sample(top, cycle * 2);
+		top.p_clk.set(true);
+		sample(top, cycle * 2 + 1);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return cycles / elapsed.count();
+}
+
+template<class WriterT>
+double simulate_vcd(size_t cycles, const char *filename)
+{
+	cxxrtl_design::p_bench__trace top;
+	cxxrtl::debug_items items;
+	top.debug_info(&items, /*scopes=*/nullptr, "");
+	std::ofstream file(filename);
+	double speed;
+	{
+		WriterT vcd(file);
+		vcd.timescale(1, "us");
+		vcd.add(items);
+		speed = simulate(top, cycles, [&](cxxrtl_design::p_bench__trace &top, uint64_t timestamp) {
+			top.step();
+			vcd.sample(timestamp);
+		});
+	}
+	return speed;
+}
+
+// The synchronous VCD writer accumulates the output in a string, which the testbench writes to a file.
+struct sync_vcd_writer : cxxrtl::vcd_writer {
+	std::ostream &output;
+
+	sync_vcd_writer(std::ostream &output) : output(output) {}
+	~sync_vcd_writer() { output << buffer; }
+
+	void sample(uint64_t timestamp) {
+		vcd_writer::sample(timestamp);
+		output << buffer;
+		buffer.clear();
+	}
+};
+
+double simulate_replay(size_t cycles, const char *filename, bool asynchronous)
+{
+	cxxrtl_design::p_bench__trace top;
+	cxxrtl::spool spool(filename);
+	cxxrtl::recorder recorder(spool, asynchronous);
+	recorder.start(top);
+	recorder.record_complete();
+	return simulate(top, cycles, [&](cxxrtl_design::p_bench__trace &top, uint64_t) {
+		top.eval();
+		recorder.record_incremental(top);
+		recorder.advance_time(cxxrtl::time(1, 0));
+	});
+}
+
+bool same_contents(const char *filename_a, const char *filename_b)
+{
+	std::ifstream file_a(filename_a, std::ios::binary), file_b(filename_b, std::ios::binary);
+	std::stringstream contents_a, contents_b;
+	contents_a << file_a.rdbuf();
+	contents_b << file_b.rdbuf();
+	return contents_a.str() == contents_b.str();
+}
+
+// Measures simulation throughput with the synchronous and asynchronous VCD and replay writers, and checks that
+// their outputs are the same.
+int main(int argc, char **argv)
+{
+	size_t cycles = argc > 1 ? atoi(argv[1]) : 1000;
+
+	cxxrtl_design::p_bench__trace top;
+	std::printf("no tracing: %.0f cycles/s\n", simulate(top, cycles, [](cxxrtl_design::p_bench__trace &top, uint64_t) {
+		top.step();
+	}));
+
+	std::printf("vcd_writer: %.0f cycles/s\n",
+	            simulate_vcd<sync_vcd_writer>(cycles, "cxxrtl-bench-trace-sync.vcd"));
+	std::printf("async_vcd_writer: %.0f cycles/s\n",
+	            simulate_vcd<cxxrtl::async_vcd_writer>(cycles, "cxxrtl-bench-trace-async.vcd"));
+	if (!same_contents("cxxrtl-bench-trace-sync.vcd", "cxxrtl-bench-trace-async.vcd")) {
+		std::printf("VCD files differ!\n");
+		return 1;
+	}
+
+	std::printf("recorder: %.0f cycles/s\n",
+	            simulate_replay(cycles, "cxxrtl-bench-trace-sync.spool", /*asynchronous=*/false));
+	std::printf("asynchronous recorder: %.0f cycles/s\n",
+	            simulate_replay(cycles, "cxxrtl-bench-trace-async.spool", /*asynchronous=*/true));
+	if (!same_contents("cxxrtl-bench-trace-sync.spool", "cxxrtl-bench-trace-async.spool")) {
+		std::printf("Replay logs differ!\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,17 @@
+// A design with many registers that change on every cycle, used for measuring the overhead of tracing
+// with the synchronous and asynchronous VCD and replay writers.
+module bench_trace (
+    input             clk,
+    output reg [63:0] digest = 0
+);
+    genvar i;
+    generate
+        for (i = 0; i < 64; i = i + 1) begin : lanes
+            reg [63:0] state = i + 1;
+            always @(posedge clk)
+                state <= {state[62:0], state[63] ^ state[62] ^ state[60] ^ state[59]};
+        end
+    endgenerate
+    always @(posedge clk)
+        digest <= digest + lanes[0].state;
+endmodule
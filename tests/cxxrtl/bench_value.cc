@@ -0,0 +1,82 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "cxxrtl/cxxrtl.h"
+
+// Micro-benchmarks for operations on wide values. Build this file twice, with and without `-DCXXRTL_NO_VECTORIZE`,
+// to compare the vectorized implementations with the scalar ones.
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t timestamp() { return __builtin_ia32_rdtsc(); }
+#define TIMESTAMP_UNIT "cycles"
+#else
+static inline uint64_t timestamp() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#define TIMESTAMP_UNIT "ns"
+#endif
+
+template<size_t Bits>
+cxxrtl::value<Bits> pattern(uint32_t seed)
+{
+	cxxrtl::value<Bits> result;
+	for (size_t n = 0; n < result.chunks; n++) {
+		seed = seed * 1664525u + 1013904223u;
+		result.data[n] = seed;
+	}
+	result.data[result.chunks - 1] &= result.msb_mask;
+	return result;
+}
+
+template<size_t Bits, class Operation>
+void measure(const char *name, size_t iterations, Operation op)
+{
+	cxxrtl::value<Bits> a = pattern<Bits>(1), b = pattern<Bits>(2);
+	uint64_t start = timestamp();
+	for (size_t n = 0; n < iterations; n++)
+		a = op(a, b);
+	uint64_t elapsed = timestamp() - start;
+	// Prevent the loop from being optimized out.
+	volatile cxxrtl::chunk_t sink = a.data[0];
+	(void)sink;
+	std::printf("%5zu-bit %-5s %8.1f " TIMESTAMP_UNIT "/op\n", Bits, name, (double)elapsed / iterations);
+}
+
+template<size_t Bits>
+void measure_all(size_t iterations)
+{
+	typedef cxxrtl::value<Bits> V;
+	measure<Bits>("and", iterations, [](const V &a, const V &b) { return a.bit_and(b).bit_xor(b); });
+	measure<Bits>("add", iterations, [](const V &a, const V &b) { return a.add(b); });
+	measure<Bits>("sub", iterations, [](const V &a, const V &b) { return a.sub(b); });
+	measure<Bits>("mul", iterations, [](const V &a, const V &b) { return a.template mul<Bits>(b); });
+	measure<Bits>("shl", iterations, [](const V &a, const V &b) {
+		return a.shl(cxxrtl::value<32>((cxxrtl::chunk_t)(b.data[0] % Bits))).bit_xor(b);
+	});
+	measure<Bits>("shr", iterations, [](const V &a, const V &b) {
+		return a.shr(cxxrtl::value<32>((cxxrtl::chunk_t)(b.data[0] % Bits))).bit_xor(b);
+	});
+	measure<Bits>("eq", iterations, [](const V &a, const V &b) {
+		return a == b ? a : a.bit_xor(b);
+	});
+	measure<Bits>("ult", iterations, [](const V &a, const V &b) {
+		return a.ucmp(b) ? a.bit_xor(b) : a.bit_and(b);
+	});
+}
+
+int main(int argc, char **argv)
+{
+	size_t iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+#if defined(CXXRTL_VECTOR_BYTES)
+	std::printf("vectorized (%d-byte vectors):\n", CXXRTL_VECTOR_BYTES);
+#else
+	std::printf("scalar:\n");
+#endif
+	measure_all<256>(iterations);
+	measure_all<512>(iterations);
+	measure_all<1024>(iterations);
+	return 0;
+}
@@ -11,7 +11,34 @@ run_subtest () {
 
 run_subtest value
 run_subtest value_fuzz
+run_subtest value_wide
+
+# Wide value operation benchmark, comparing vectorized and scalar implementations.
+${CC:-gcc} -std=c++11 -O2 -o cxxrtl-bench-value -I../../backends/cxxrtl/runtime bench_value.cc -lstdc++
+${CC:-gcc} -std=c++11 -O2 -DCXXRTL_NO_VECTORIZE -o cxxrtl-bench-value-scalar -I../../backends/cxxrtl/runtime bench_value.cc -lstdc++
+./cxxrtl-bench-value 10000
+./cxxrtl-bench-value-scalar 10000
 
 # Compile-only test.
 ../../yosys -p "read_verilog test_unconnected_output.v; proc; clean; write_cxxrtl cxxrtl-test-unconnected_output.cc"
 ${CC:-gcc} -std=c++11 -c -o cxxrtl-test-unconnected_output -I../../backends/cxxrtl/runtime cxxrtl-test-unconnected_output.cc
+
+# Parallel evaluation benchmark; also checks that the result doesn't depend on the amount of threads.
+../../yosys -p "read_verilog bench_parallel.v; write_cxxrtl -noflatten -parallel cxxrtl-bench-parallel.cc"
+${CC:-gcc} -std=c++11 -O2 -o cxxrtl-bench-parallel -I../../backends/cxxrtl/runtime -I. bench_parallel.cc -lstdc++ -lpthread
+./cxxrtl-bench-parallel 1000 1 2 4
+
+# Activity tracking benchmark; also checks that the result is the same as without activity tracking.
+../../yosys -p "read_verilog bench_activity.v; write_cxxrtl -noflatten -activity -namespace cxxrtl_activity cxxrtl-bench-activity.cc"
+../../yosys -p "read_verilog bench_activity.v; write_cxxrtl -noflatten -namespace cxxrtl_reference cxxrtl-bench-activity-reference.cc"
+${CC:-gcc} -std=c++11 -O2 -o cxxrtl-bench-activity -I../../backends/cxxrtl/runtime -I. bench_activity.cc -lstdc++
+./cxxrtl-bench-activity 1000
+
+# Tracing benchmark; also checks that the synchronous and asynchronous writers produce the same output.
+../../yosys -p "read_verilog bench_trace.v; write_cxxrtl cxxrtl-bench-trace.cc"
+${CC:-gcc} -std=c++11 -O2 -o cxxrtl-bench-trace -I../../backends/cxxrtl/runtime -I. bench_trace.cc -lstdc++ -lpthread
+./cxxrtl-bench-trace 10000
+
+# Replay log rewinding benchmark, with and without periodic checkpoints.
+${CC:-gcc} -std=c++11 -O2 -o cxxrtl-bench-replay -I../../backends/cxxrtl/runtime -I. bench_replay.cc -lstdc++ -lpthread
+./cxxrtl-bench-replay 10000 100
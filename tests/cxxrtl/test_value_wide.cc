@@ -0,0 +1,143 @@
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <random>
+#include <vector>
+
+#include "cxxrtl/cxxrtl.h"
+
+// Randomized tests for operations on values wide enough to use the vectorized implementations (if available),
+// checked against a straightforward bit-by-bit reference implementation.
+
+static std::mt19937 generator(1);
+
+// Chunks that are all zeroes or all ones are generated often, to exercise long carry and borrow chains.
+template<size_t Bits>
+cxxrtl::value<Bits> random_value()
+{
+	cxxrtl::value<Bits> result;
+	for (size_t n = 0; n < result.chunks; n++) {
+		switch (generator() % 4) {
+			case 0:  result.data[n] = 0; break;
+			case 1:  result.data[n] = ~cxxrtl::chunk_t(0); break;
+			default: result.data[n] = generator(); break;
+		}
+	}
+	result.data[result.chunks - 1] &= result.msb_mask;
+	return result;
+}
+
+template<size_t Bits>
+std::vector<bool> to_bits(const cxxrtl::value<Bits> &val)
+{
+	std::vector<bool> result(Bits);
+	for (size_t n = 0; n < Bits; n++)
+		result[n] = val.bit(n);
+	return result;
+}
+
+std::vector<bool> ref_add(const std::vector<bool> &a, const std::vector<bool> &b, bool invert, bool carry)
+{
+	std::vector<bool> result(a.size());
+	for (size_t n = 0; n < a.size(); n++) {
+		bool bn = b[n] ^ invert;
+		result[n] = a[n] ^ bn ^ carry;
+		carry = (a[n] && bn) || (a[n] && carry) || (bn && carry);
+	}
+	return result;
+}
+
+std::vector<bool> ref_mul(const std::vector<bool> &a, const std::vector<bool> &b)
+{
+	std::vector<bool> result(a.size());
+	for (size_t n = 0; n < a.size(); n++) {
+		if (!b[n])
+			continue;
+		std::vector<bool> shifted(a.size());
+		for (size_t m = n; m < a.size(); m++)
+			shifted[m] = a[m - n];
+		result = ref_add(result, shifted, false, false);
+	}
+	return result;
+}
+
+bool ref_ult(const std::vector<bool> &a, const std::vector<bool> &b)
+{
+	for (size_t n = a.size(); n > 0; n--)
+		if (a[n - 1] != b[n - 1])
+			return b[n - 1];
+	return false;
+}
+
+bool ref_slt(const std::vector<bool> &a, const std::vector<bool> &b)
+{
+	if (a.back() != b.back())
+		return a.back();
+	return ref_ult(a, b);
+}
+
+void check(bool condition, const char *operation, size_t bits)
+{
+	if (!condition) {
+		std::printf("Test failure: %s @ Bits = %zu\n", operation, bits);
+		std::terminate();
+	}
+}
+
+template<size_t Bits>
+void test_wide_operations()
+{
+	for (int iteration = 0; iteration < 1000; iteration++) {
+		cxxrtl::value<Bits> a = random_value<Bits>(), b = random_value<Bits>();
+		if (iteration % 8 == 0)
+			b = a;
+		std::vector<bool> ra = to_bits(a), rb = to_bits(b);
+
+		check(to_bits(a.add(b)) == ref_add(ra, rb, false, false), "add", Bits);
+		check(to_bits(a.sub(b)) == ref_add(ra, rb, true, true), "sub", Bits);
+		if (iteration % 10 == 0) // the reference implementation is slow
+			check(to_bits(a.template mul<Bits>(b)) == ref_mul(ra, rb), "mul", Bits);
+		check(a.ucmp(b) == ref_ult(ra, rb), "ucmp", Bits);
+		check(a.scmp(b) == ref_slt(ra, rb), "scmp", Bits);
+		check((a == b) == (ra == rb), "eq", Bits);
+		check(a.is_zero() == (ra == std::vector<bool>(Bits)), "is_zero", Bits);
+
+		std::vector<bool> rand_, ror, rxor;
+		for (size_t n = 0; n < Bits; n++) {
+			rand_.push_back(ra[n] && rb[n]);
+			ror.push_back(ra[n] || rb[n]);
+			rxor.push_back(ra[n] != rb[n]);
+		}
+		check(to_bits(a.bit_and(b)) == rand_, "bit_and", Bits);
+		check(to_bits(a.bit_or(b)) == ror, "bit_or", Bits);
+		check(to_bits(a.bit_xor(b)) == rxor, "bit_xor", Bits);
+
+		size_t amount = generator() % (Bits + 8);
+		cxxrtl::value<32> amount_val((cxxrtl::chunk_t)amount);
+		std::vector<bool> rshl(Bits), rshr(Bits), rsshr(Bits);
+		for (size_t n = 0; n < Bits; n++) {
+			rshl[n] = (n >= amount) ? ra[n - amount] : false;
+			rshr[n] = (n + amount < Bits) ? ra[n + amount] : false;
+			rsshr[n] = (n + amount < Bits) ? ra[n + amount] : ra[Bits - 1];
+		}
+		check(to_bits(a.shl(amount_val)) == rshl, "shl", Bits);
+		check(to_bits(a.shr(amount_val)) == rshr, "shr", Bits);
+		check(to_bits(a.sshr(amount_val)) == rsshr, "sshr", Bits);
+	}
+	std::printf("Test passed @ Bits = %zu.\n", Bits);
+}
+
+int main()
+{
+	std::printf("Randomized tests for wide values:\n");
+	test_wide_operations<256>();
+	test_wide_operations<300>();
+	test_wide_operations<512>();
+	test_wide_operations<1000>();
+	test_wide_operations<1024>();
+	test_wide_operations<1100>();
+	test_wide_operations<2048>();
+	test_wide_operations<2080>();
+}
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+
+# Measures the throughput of the liberty parser on a synthetic library, and checks that the library is parsed
+# only once when several commands read it.
+#
+# Usage: bench-parse.py [yosys-binary [number-of-cells]]
+
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+yosys = sys.argv[1] if len(sys.argv) > 1 else "../../yosys"
+num_cells = int(sys.argv[2]) if len(sys.argv) > 2 else 2000
+
+def table(name, rows, cols):
+    index_1 = ", ".join("%.4f" % (0.01 * (i + 1)) for i in range(rows))
+    index_2 = ", ".join("%.4f" % (0.002 * (j + 1)) for j in range(cols))
+    values = ", \\\n".join("\"" + ", ".join("%.5f" % (0.01 * (i + 1) + 0.3 * (j + 1)) for j in range(cols)) + "\"" for i in range(rows))
+    return ("        %s(delay_template_%dx%d) {\n"
+            "          index_1(\"%s\");\n"
+            "          index_2(\"%s\");\n"
+            "          values(%s);\n"
+            "        }\n") % (name, rows, cols, index_1, index_2, values)
+
+def timing(related_pin):
+    text = "      timing() {\n"
+    text += "        related_pin : \"%s\";\n" % related_pin
+    for name in ["cell_rise", "cell_fall", "rise_transition", "fall_transition"]:
+        text += table(name, 7, 7)
+    text += "      }\n"
+    return text
+
+def comb_cell(index):
+    text = "  cell(NAND2_X%d) {\n" % index
+    text += "    area : %.3f;\n" % (1.0 + index * 0.001)
+    for pin in ["A", "B"]:
+        text += "    pin(%s) {\n      direction : input;\n      capacitance : 0.0012;\n    }\n" % pin
+    text += "    pin(Y) {\n      direction : output;\n      function : \"(A * B)'\";\n"
+    text += timing("A") + timing("B")
+    text += "    }\n  }\n"
+    return text
+
+def seq_cell(index):
+    text = "  cell(DFF_X%d) {\n" % index
+    text += "    area : %.3f;\n" % (4.0 + index * 0.001)
+    text += "    ff(IQ, IQN) {\n      next_state : \"D\";\n      clocked_on : \"CK\";\n    }\n"
+    text += "    pin(CK) {\n      direction : input;\n      clock : true;\n    }\n"
+    text += "    pin(D) {\n      direction : input;\n    }\n"
+    text += "    pin(Q) {\n      direction : output;\n      function : \"IQ\";\n" + timing("CK") + "    }\n"
+    text += "  }\n"
+    return text
+
+def generate(path):
+    with open(path, "w") as f:
+        f.write("library(bench) {\n")
+        f.write("  /* synthetic library for parser benchmarks */\n")
+        f.write("  lu_table_template(delay_template_7x7) {\n")
+        f.write("    variable_1 : input_net_transition;\n    variable_2 : total_output_net_capacitance;\n  }\n")
+        for index in range(num_cells):
+            f.write(seq_cell(index) if index % 8 == 0 else comb_cell(index))
+        f.write("}\n")
+
+def run(script):
+    start = time.perf_counter()
+    log = subprocess.run([yosys, "-p", script], check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    return time.perf_counter() - start, log
+
+with tempfile.TemporaryDirectory() as tmp:
+    path = os.path.join(tmp, "bench.lib")
+    generate(path)
+    size = os.path.getsize(path) / 1e6
+    print("Synthetic library: %d cells, %.1f MB" % (num_cells, size))
+
+    startup, _ = run("")
+    parse, _ = run("read_liberty -lib %s" % path)
+    parse -= startup
+    print("read_liberty -lib: %.3f s (%.1f MB/s)" % (parse, size / parse))
+
+    flow, log = run("read_liberty -lib %s; dfflibmap -info -liberty %s; stat -liberty %s" % (path, path, path))
+    flow -= startup
+    reused = log.count("Reusing parsed liberty file")
+    print("read_liberty + dfflibmap + stat: %.3f s, library reused %d times" % (flow, reused))
+    if reused != 2:
+        sys.exit("Expected the library to be parsed only once.")
@@ -11,3 +11,6 @@ for x in *.lib; do
 	../../yosys-filterlib -verilogsim $x > $x.verilogsim
 	diff $x.filtered $x.filtered.ok && diff $x.verilogsim $x.verilogsim.ok
 done
+
+echo "Benchmarking liberty parser.."
+python3 bench-parse.py ../../yosys
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include "kernel/yosys.h"
+#include "kernel/qcsat.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// A module with y = a & b, and a QuickConeSat that has imported y.
+class KernelQcsatTest : public testing::Test {
+protected:
+	RTLIL::Design *design;
+	RTLIL::Module *module;
+	RTLIL::Wire *a, *b, *c, *y;
+	RTLIL::Cell *cell;
+
+	static void SetUpTestSuite()
+	{
+		yosys_setup();
+	}
+
+	void SetUp() override
+	{
+		design = new RTLIL::Design;
+		module = design->addModule(ID(top));
+		a = module->addWire(ID(a));
+		b = module->addWire(ID(b));
+		c = module->addWire(ID(c));
+		y = module->addWire(ID(y));
+		cell = module->addAndGate(ID(gate1), a, b, y);
+	}
+
+	void TearDown() override
+	{
+		delete design;
+	}
+
+	// Checks whether y can be 1 while a is 0.
+	bool y_without_a(QuickConeSat &qcsat)
+	{
+		int lit_y = qcsat.importSigBit(y);
+		int lit_a = qcsat.importSigBit(a);
+		qcsat.prepare();
+		return qcsat.solve(lit_y, qcsat.ez->NOT(lit_a));
+	}
+};
+
+TEST_F(KernelQcsatTest, reuseCells)
+{
+	ModWalker modwalker(design, module);
+	QuickConeSat qcsat(modwalker);
+	EXPECT_FALSE(y_without_a(qcsat));
+	EXPECT_FALSE(y_without_a(qcsat));
+	EXPECT_EQ(qcsat.stat_imported, 1);
+	EXPECT_EQ(qcsat.stat_reused, 1);
+}
+
+TEST_F(KernelQcsatTest, changedCell)
+{
+	ModWalker modwalker(design, module);
+	QuickConeSat qcsat(modwalker);
+	EXPECT_FALSE(y_without_a(qcsat));
+
+	// Now y = c & b, which the solver must not know as y = a & b.
+	cell->setPort(ID::A, c);
+	EXPECT_EQ(qcsat.stat_invalidated, 1);
+	EXPECT_TRUE(y_without_a(qcsat));
+
+	// The changed cell is imported again, with its new inputs.
+	int lit_y = qcsat.importSigBit(y);
+	int lit_c = qcsat.importSigBit(c);
+	qcsat.prepare();
+	EXPECT_FALSE(qcsat.solve(lit_y, qcsat.ez->NOT(lit_c)));
+}
+
+TEST_F(KernelQcsatTest, removedCell)
+{
+	ModWalker modwalker(design, module);
+	QuickConeSat qcsat(modwalker);
+	EXPECT_FALSE(y_without_a(qcsat));
+
+	module->remove(cell);
+	EXPECT_EQ(qcsat.stat_invalidated, 1);
+	EXPECT_TRUE(y_without_a(qcsat));
+}
+
+TEST_F(KernelQcsatTest, sharedEpoch)
+{
+	// Both cells are imported in one epoch. Dropping one of them must not
+	// drop the constraints of the other one for good.
+	RTLIL::Wire *z = module->addWire(ID(z));
+	module->addAndGate(ID(gate2), y, c, z);
+
+	ModWalker modwalker(design, module);
+	QuickConeSat qcsat(modwalker);
+	int lit_z = qcsat.importSigBit(z);
+	int lit_a = qcsat.importSigBit(a);
+	qcsat.prepare();
+	EXPECT_FALSE(qcsat.solve(lit_z, qcsat.ez->NOT(lit_a)));
+
+	cell->setPort(ID::B, c);
+	EXPECT_EQ(qcsat.stat_invalidated, 2);
+
+	// z = (a & c) & c still implies a once both cells are imported again.
+	lit_z = qcsat.importSigBit(z);
+	lit_a = qcsat.importSigBit(a);
+	qcsat.prepare();
+	EXPECT_FALSE(qcsat.solve(lit_z, qcsat.ez->NOT(lit_a)));
+}
+
+TEST_F(KernelQcsatTest, retiredBehindImported)
+{
+	// gate1 and an unrelated cell share the first epoch, gate2 is imported in
+	// the second one. Changing the unrelated cell drops gate1 as well, which
+	// must be imported again through gate2, which is still imported.
+	RTLIL::Wire *d = module->addWire(ID(d));
+	RTLIL::Wire *w = module->addWire(ID(w));
+	RTLIL::Wire *z = module->addWire(ID(z));
+	RTLIL::Cell *other = module->addAndGate(ID(gate_other), c, d, w);
+	module->addAndGate(ID(gate2), y, c, z);
+
+	ModWalker modwalker(design, module);
+	QuickConeSat qcsat(modwalker);
+	qcsat.epoch_size = 2;
+	qcsat.importSigBit(w);
+	EXPECT_FALSE(y_without_a(qcsat));
+
+	int lit_z = qcsat.importSigBit(z);
+	int lit_a = qcsat.importSigBit(a);
+	qcsat.prepare();
+	EXPECT_FALSE(qcsat.solve(lit_z, qcsat.ez->NOT(lit_a)));
+
+	other->setPort(ID::A, b);
+	EXPECT_EQ(qcsat.stat_invalidated, 2);
+
+	lit_z = qcsat.importSigBit(z);
+	lit_a = qcsat.importSigBit(a);
+	qcsat.prepare();
+	EXPECT_FALSE(qcsat.solve(lit_z, qcsat.ez->NOT(lit_a)));
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+
+# Measures the throughput and peak memory use of write_json and read_json on a large synthetic netlist.
+#
+# Usage: json_bench.py [yosys-binary [number-of-cells]]
+
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+yosys = sys.argv[1] if len(sys.argv) > 1 else "../../yosys"
+num_cells = int(sys.argv[2]) if len(sys.argv) > 2 else 200000
+
+def generate(path):
+    with open(path, "w") as f:
+        f.write("module \\bench\n")
+        f.write("  wire width 16 input 1 \\a\n")
+        f.write("  wire width 16 input 2 \\b\n")
+        f.write("  wire width 16 output 3 \\y\n")
+        for index in range(num_cells):
+            f.write("  wire width 16 $n%d\n" % index)
+        for index in range(num_cells):
+            a = "\\a" if index < 2 else "$n%d" % (index - 1)
+            b = "\\b" if index < 2 else "$n%d [15:8] $n%d [7:0]" % (index - 2, index - 2)
+            f.write("  attribute \\src \"bench.v:%d.5-%d.20\"\n" % (index + 1, index + 1))
+            f.write("  cell %s $c%d\n" % ("$add" if index % 2 else "$xor", index))
+            f.write("    parameter \\A_SIGNED 0\n    parameter \\B_SIGNED 0\n")
+            f.write("    parameter \\A_WIDTH 16\n    parameter \\B_WIDTH 16\n    parameter \\Y_WIDTH 16\n")
+            f.write("    connect \\A %s\n" % a)
+            f.write("    connect \\B { %s }\n" % b)
+            f.write("    connect \\Y $n%d\n" % index)
+            f.write("  end\n")
+        f.write("  connect \\y $n%d\n" % (num_cells - 1))
+        f.write("end\n")
+
+def run(script):
+    start = time.perf_counter()
+    proc = subprocess.Popen([yosys, "-q", "-p", script])
+    _, status, rusage = os.wait4(proc.pid, 0)
+    if status != 0:
+        sys.exit("yosys failed: %s" % script)
+    # ru_maxrss is in kilobytes on Linux
+    return time.perf_counter() - start, rusage.ru_maxrss / 1024
+
+with tempfile.TemporaryDirectory() as tmp:
+    rtlil, json = os.path.join(tmp, "bench.il"), os.path.join(tmp, "bench.json")
+    generate(rtlil)
+
+    startup, _ = run("")
+    load, load_rss = run("read_rtlil %s" % rtlil)
+    write, _ = run("read_rtlil %s; write_json %s" % (rtlil, json))
+    write -= load
+    size = os.path.getsize(json) / 1e6
+    print("Synthetic netlist: %d cells, JSON %.1f MB" % (num_cells, size))
+    print("write_json: %.3f s (%.1f MB/s)" % (write, size / write))
+
+    read, read_rss = run("read_json %s" % json)
+    read -= startup
+    print("read_json: %.3f s (%.1f MB/s), peak memory %.0f MB (%.0f MB for the same design from RTLIL)" %
+            (read, size / read, read_rss, load_rss))
+
+    run("read_json %s; write_json %s.2; design -reset; read_json %s.2; write_json %s.3" % (json, json, json, json))
+    with open(json + ".2") as a, open(json + ".3") as b:
+        if a.read() != b.read():
+            sys.exit("JSON round trip is not stable.")
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+
+# Compares the time it takes to load a large synthetic design from text and from binary RTLIL, and checks that
+# both load the same design.
+#
+# Usage: rtlil_binary_bench.py [yosys-binary [number-of-cells]]
+
+import filecmp
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+yosys = sys.argv[1] if len(sys.argv) > 1 else "../../yosys"
+num_cells = int(sys.argv[2]) if len(sys.argv) > 2 else 200000
+
+def generate(path):
+    with open(path, "w") as f:
+        f.write("module \\bench\n")
+        f.write("  wire width 16 input 1 \\a\n")
+        f.write("  wire width 16 input 2 \\b\n")
+        f.write("  wire width 16 output 3 \\y\n")
+        for index in range(num_cells):
+            f.write("  attribute \\src \"bench.v:%d.5-%d.20\"\n" % (index + 1, index + 1))
+            f.write("  wire width 16 $n%d\n" % index)
+        for index in range(num_cells):
+            a = "\\a" if index < 2 else "$n%d" % (index - 1)
+            b = "\\b" if index < 2 else "$n%d [15:8] $n%d [7:0]" % (index - 2, index - 2)
+            f.write("  attribute \\src \"bench.v:%d.5-%d.20\"\n" % (index + 1, index + 1))
+            f.write("  cell %s $c%d\n" % ("$add" if index % 2 else "$xor", index))
+            f.write("    parameter \\A_SIGNED 0\n    parameter \\B_SIGNED 0\n")
+            f.write("    parameter \\A_WIDTH 16\n    parameter \\B_WIDTH 16\n    parameter \\Y_WIDTH 16\n")
+            f.write("    connect \\A %s\n" % a)
+            f.write("    connect \\B { %s }\n" % b)
+            f.write("    connect \\Y $n%d\n" % index)
+            f.write("  end\n")
+        f.write("  connect \\y $n%d\n" % (num_cells - 1))
+        f.write("end\n")
+
+def run(script):
+    start = time.perf_counter()
+    subprocess.run([yosys, "-q", "-p", script], check=True)
+    return time.perf_counter() - start
+
+with tempfile.TemporaryDirectory() as tmp:
+    text, binary = os.path.join(tmp, "bench.il"), os.path.join(tmp, "bench.bin")
+    generate(text)
+    run("read_rtlil %s; write_rtlil -binary %s" % (text, binary))
+    print("Synthetic design: %d cells, text %.1f MB, binary %.1f MB" % (num_cells,
+            os.path.getsize(text) / 1e6, os.path.getsize(binary) / 1e6))
+
+    startup = run("")
+    read_text = run("read_rtlil %s" % text) - startup
+    read_binary = run("read_rtlil %s" % binary) - startup
+    print("read_rtlil text: %.3f s, binary: %.3f s (%.1fx)" % (read_text, read_binary, read_text / read_binary))
+
+    run("read_rtlil %s; write_rtlil %s.a" % (text, text))
+    run("read_rtlil %s; write_rtlil %s.b" % (binary, text))
+    if not filecmp.cmp(text + ".a", text + ".b", shallow=False):
+        sys.exit("Binary RTLIL did not load the same design as text RTLIL.")
@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+set -e
+
+rm -rf read_cache.tmp
+trap 'rm -rf read_cache.tmp' EXIT
+
+# The first run fills the cache, the second one reads the modules from it.
+../../yosys -q \
+    -p "logger -expect log \"Stored the result in cache entry\" 1" \
+    -p "read_verilog -cache read_cache.tmp read_cache.v" \
+    -p "logger -check-expected"
+
+../../yosys -q \
+    -p "logger -expect log \"Cache hit\" 1" \
+    -p "read_verilog -cache read_cache.tmp read_cache.v" \
+    -p "logger -check-expected" \
+    -p "select -assert-mod-count 2 =*" \
+    -p "hierarchy -check -top read_cache_b" \
+    -p "flatten" \
+    -p "select -assert-count 1 t:\$reduce_xor"
+
+# Blackboxes with parameters (read_verilog -lib) are cached with their AST, so that they can still be derived.
+../../yosys -q \
+    -p "logger -expect log \"Stored the result in cache entry\" 1" \
+    -p "read_verilog -lib -cache read_cache.tmp read_cache_lib.v" \
+    -p "logger -check-expected"
+
+../../yosys -q \
+    -p "logger -expect log \"Cache hit\" 1" \
+    -p "read_verilog -lib -cache read_cache.tmp read_cache_lib.v" \
+    -p "logger -check-expected" \
+    -p "read_verilog read_cache_lib_top.v" \
+    -p "hierarchy -check -top read_cache_lib_top" \
+    -p "select -assert-mod-count 1 =\$paramod*read_cache_lib*"
@@ -0,0 +1,7 @@
+module read_cache_a(input [3:0] a, output y);
+	assign y = ^a;
+endmodule
+
+module read_cache_b(input [3:0] a, output y);
+	read_cache_a a_inst(.a(a), .y(y));
+endmodule
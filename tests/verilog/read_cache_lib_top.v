@@ -0,0 +1,3 @@
+module read_cache_lib_top(input [7:0] a, output [7:0] y);
+	read_cache_lib #(.W(8)) lib_inst(.a(a), .y(y));
+endmodule
@@ -0,0 +1,13 @@
+(* keep *)
+module read_lazy_buf(input A, output Y);
+	assign Y = A;
+endmodule
+
+module read_lazy_inv(input A, output Y);
+	assign Y = ~A;
+endmodule
+
+`default_nettype none
+module read_lazy_and #(parameter W = 2) (input [W-1:0] A, output Y);
+	assign Y = &A;
+endmodule
@@ -0,0 +1,6 @@
+`define READ_PARALLEL_WIDTH 4
+
+module read_parallel_a(input [`READ_PARALLEL_WIDTH-1:0] a, output y);
+	assign y = ^a;
+	assign z = y;
+endmodule
@@ -0,0 +1,4 @@
+module read_parallel_b(input [`READ_PARALLEL_WIDTH-1:0] a, output y, output y2);
+	read_parallel_a a_inst(.a(a), .y(y));
+	read_parallel_d d_inst(.a(a[1:0]), .y(y2));
+endmodule
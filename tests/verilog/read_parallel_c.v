@@ -0,0 +1,7 @@
+module read_parallel_c #(parameter W = 1) (input [W-1:0] a, output y);
+	assign y = &a;
+endmodule
+
+module read_parallel_d(input [1:0] a, output y);
+	read_parallel_c #(.W(2)) c_inst(.a(a), .y(y));
+endmodule